@@ -0,0 +1,355 @@
+/**
+ * SPDX-FileComment: depdiscover Benchmark Suite
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file depdiscover_bench.cpp
+ * @brief Micro-benchmarks of the scan hot paths and an end-to-end scan of a
+ * synthetic project against a mock OSV server; results as JSON.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#include "mock_osv_server.hpp"
+#include "workload_generator.hpp"
+
+#include "scan_runner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+using namespace depdiscover;
+
+struct BenchOptions {
+  bench::WorkloadOptions workload;
+  int repetitions = 5;
+  int osv_delay_ms = 0;
+  fs::path workdir = fs::temp_directory_path() / "depdiscover_bench";
+  std::string out_path; ///< Empty: JSON to stdout.
+  bool keep = false;    ///< Keep the generated project.
+};
+
+struct BenchResult {
+  std::string name;
+  std::size_t items = 0; ///< Work items per repetition.
+  std::vector<double> ms; ///< Wall time per repetition.
+  std::size_t osv_requests = 0; ///< End-to-end scans only.
+
+  double median() const {
+    std::vector<double> v = ms;
+    std::sort(v.begin(), v.end());
+    return v.empty() ? 0.0 : v[v.size() / 2];
+  }
+  double min() const {
+    return ms.empty() ? 0.0 : *std::min_element(ms.begin(), ms.end());
+  }
+};
+
+/// Swallows the scan's progress output.
+struct NullBuffer : std::streambuf {
+  int overflow(int c) override { return c; }
+};
+
+std::size_t g_sink = 0; ///< Keeps results alive for the optimizer.
+
+double time_ms(const std::function<void()> &fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+BenchResult run(const std::string &name, std::size_t items, int reps,
+                const std::function<void()> &fn,
+                const std::function<void()> &setup = {}) {
+  BenchResult r{name, items, {}, 0};
+  for (int i = 0; i < reps; ++i) {
+    if (setup)
+      setup();
+    r.ms.push_back(time_ms(fn));
+  }
+  std::cerr << "  " << std::left << std::setw(28) << name << std::right
+            << std::fixed << std::setprecision(3) << std::setw(12)
+            << r.median() << " ms" << std::setw(12)
+            << (items ? r.median() * 1e6 / double(items) : 0.0) << " ns/item\n";
+  return r;
+}
+
+int parse_args(int argc, char *argv[], BenchOptions &o) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto number = [&](auto &target) {
+      if (i + 1 >= argc)
+        throw std::invalid_argument(arg + " requires a number");
+      target = static_cast<std::remove_reference_t<decltype(target)>>(
+          std::stoul(argv[++i]));
+    };
+    if (arg == "-h" || arg == "--help") {
+      std::cout
+          << "Usage: " << argv[0] << " [OPTIONS]\n\n"
+          << "  --tus <N>          Translation units (Default: 500)\n"
+          << "  --fanout <N>       #includes per file (Default: 12)\n"
+          << "  --deps <N>         Dependencies (Default: 40)\n"
+          << "  --headers <N>      Headers per dependency (Default: 30)\n"
+          << "  --elf <N>          ELF fixtures (Default: 8)\n"
+          << "  --seed <N>         Generator seed (Default: 42)\n"
+          << "  --reps <N>         Repetitions per benchmark (Default: 5)\n"
+          << "  --osv-delay <MS>   Mock OSV latency per request (Default: 0)\n"
+          << "  --workdir <DIR>    Where to generate the project\n"
+          << "  --keep             Keep the generated project\n"
+          << "  -o, --out <PATH>   Write the JSON results (Default: stdout)\n";
+      return 2;
+    } else if (arg == "--tus") {
+      number(o.workload.tus);
+    } else if (arg == "--fanout") {
+      number(o.workload.fanout);
+    } else if (arg == "--deps") {
+      number(o.workload.deps);
+    } else if (arg == "--headers") {
+      number(o.workload.headers_per_dep);
+    } else if (arg == "--elf") {
+      number(o.workload.elf_files);
+    } else if (arg == "--seed") {
+      number(o.workload.seed);
+    } else if (arg == "--reps") {
+      number(o.repetitions);
+    } else if (arg == "--osv-delay") {
+      number(o.osv_delay_ms);
+    } else if (arg == "--workdir" && i + 1 < argc) {
+      o.workdir = argv[++i];
+    } else if (arg == "--keep") {
+      o.keep = true;
+    } else if ((arg == "-o" || arg == "--out") && i + 1 < argc) {
+      o.out_path = argv[++i];
+    } else {
+      std::cerr << "Error: Unknown or incomplete option: " << arg << "\n";
+      return 1;
+    }
+  }
+  o.repetitions = std::max(o.repetitions, 1);
+  return 0;
+}
+
+void write_results(std::ostream &out, const BenchOptions &o,
+                   const bench::Workload &w,
+                   const std::vector<BenchResult> &results) {
+  JsonWriter json(out, 2);
+  json.begin_object();
+  json.key("tool").value("depdiscover_bench");
+  json.key("version").value(std::string(rz::config::VERSION));
+  json.key("date").value(get_current_date());
+  json.key("platform").value(get_platform_name());
+  json.key("workload").begin_object();
+  json.key("tus").value(std::int64_t(o.workload.tus));
+  json.key("fanout").value(std::int64_t(o.workload.fanout));
+  json.key("deps").value(std::int64_t(o.workload.deps));
+  json.key("headers_per_dep").value(std::int64_t(o.workload.headers_per_dep));
+  json.key("elf_files").value(std::int64_t(o.workload.elf_files));
+  json.key("seed").value(std::int64_t(o.workload.seed));
+  json.key("headers").value(std::int64_t(w.headers.size()));
+  json.key("osv_delay_ms").value(o.osv_delay_ms);
+  json.end_object();
+  json.key("repetitions").value(o.repetitions);
+  json.key("results").begin_array();
+  for (const auto &r : results) {
+    json.begin_object();
+    json.key("name").value(r.name);
+    json.key("items").value(std::int64_t(r.items));
+    json.key("median_ms").value(r.median());
+    json.key("min_ms").value(r.min());
+    json.key("ns_per_item")
+        .value(r.items ? r.median() * 1e6 / double(r.items) : 0.0);
+    json.key("runs_ms").begin_array();
+    for (double ms : r.ms)
+      json.value(ms);
+    json.end_array();
+    if (r.osv_requests)
+      json.key("osv_requests").value(std::int64_t(r.osv_requests));
+    json.end_object();
+  }
+  json.end_array();
+  json.end_object();
+  out << "\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  BenchOptions o;
+  try {
+    if (int rc = parse_args(argc, argv, o))
+      return rc == 2 ? 0 : rc;
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return 1;
+  }
+
+  std::cerr << "[Info] Generating workload in " << o.workdir << " ("
+            << o.workload.tus << " TUs, " << o.workload.deps << " deps, fan-out "
+            << o.workload.fanout << ")...\n";
+  const bench::Workload w = bench::generate_workload(o.workdir, o.workload);
+  const int reps = o.repetitions;
+  std::vector<BenchResult> results;
+
+  // --- Micro-benchmarks ---
+  std::cerr << "[Info] Micro-benchmarks (median of " << reps << "):\n";
+
+  results.push_back(run("scan_includes", w.sources.size(), reps, [&] {
+    for (const auto &src : w.sources)
+      g_sink += scan_includes(src).size();
+  }));
+
+  results.push_back(run("extract_include_paths", w.commands.size(), reps, [&] {
+    for (const auto &cmd : w.commands)
+      g_sink += extract_include_paths(cmd).size();
+  }));
+
+  // (include paths, header name) pairs as the scan sees them
+  std::vector<std::pair<std::size_t, std::string>> lookups;
+  for (std::size_t t = 0; t < w.sources.size() && lookups.size() < 2000; ++t)
+    for (const auto &inc : scan_includes(w.sources[t]))
+      lookups.emplace_back(t, inc);
+  std::vector<std::vector<std::string>> tu_paths;
+  for (const auto &cmd : w.commands)
+    tu_paths.push_back(extract_include_paths(cmd));
+
+  // Uncached lookups probe the file system; keep the sample small
+  const std::size_t direct = std::min<std::size_t>(lookups.size(), 200);
+  results.push_back(run("resolve_header", direct, reps, [&] {
+    for (std::size_t i = 0; i < direct; ++i)
+      g_sink += resolve_header(lookups[i].second, tu_paths[lookups[i].first],
+                               w.root.string())
+                    .size();
+  }));
+
+  auto &header_cache = HeaderResolveCache::instance();
+  results.push_back(run("resolve_header_cached", lookups.size(), reps, [&] {
+    for (const auto &[t, name] : lookups) {
+      auto list = header_cache.intern(tu_paths[t], w.root.string());
+      g_sink += header_cache.resolve(list, name).size();
+    }
+  }));
+
+  {
+    std::vector<std::string_view> headers(w.headers.begin(), w.headers.end());
+    std::sort(headers.begin(), headers.end());
+    std::set<std::string> libs;
+    std::unique_ptr<DependencyMapper> mapper;
+    results.push_back(run(
+        "fuzzy_match_header", w.dep_names.size(), reps,
+        [&] {
+          for (const auto &name : w.dep_names)
+            g_sink += mapper->claim_headers_fuzzy(name).size();
+        },
+        // Claims are destructive: every repetition gets a fresh mapper
+        [&] { mapper = std::make_unique<DependencyMapper>(headers, libs); }));
+  }
+
+  results.push_back(run("guess_license_from_content", w.license_files.size(),
+                        reps, [&] {
+                          for (const auto &path : w.license_files)
+                            g_sink += guess_license_from_content(path).size();
+                        }));
+
+  {
+    const std::vector<std::string> severities = {
+        "CVSS:3.1/AV:N/AC:L/PR:N/UI:N/S:U/C:H/I:H/A:H",
+        "CVSS:3.1/AV:L/AC:H/PR:L/UI:R/S:C/C:L/I:N/A:N",
+        "CVSS:3.0/AV:A/AC:L/PR:H/UI:N/S:U/C:H/I:L/A:N",
+        "AV:N/AC:M/Au:N/C:P/I:P/A:P",
+        "7.5",
+        "UNKNOWN"};
+    const std::size_t rounds = 10000;
+    results.push_back(
+        run("extract_cvss_score", rounds * severities.size(), reps, [&] {
+          double total = 0;
+          for (std::size_t i = 0; i < rounds; ++i)
+            for (const auto &s : severities)
+              total += extract_cvss_score(s);
+          g_sink += static_cast<std::size_t>(total);
+        }));
+  }
+
+  // --- End-to-end scan against the mock OSV server ---
+  bench::MockOsvServer osv(o.osv_delay_ms);
+  if (!osv.start()) {
+    std::cerr << "Error: Could not start the mock OSV server\n";
+    return 1;
+  }
+  ::setenv("DEPDISCOVER_OSV_URL", osv.url().c_str(), 1);
+  std::cerr << "[Info] End-to-end scan (mock OSV at " << osv.url() << "):\n";
+
+  ScanOptions scan;
+  scan.cc_path = w.compile_commands.string();
+  scan.vcpkg_path = w.vcpkg.string();
+  scan.conan_path = w.conan.string();
+  scan.libs_txt_path = (w.root / "libs.txt").string();         // absent
+  scan.cmake_lists_path = (w.root / "CMakeLists.txt").string(); // absent
+  scan.binary_paths = {w.bin_dir.string()};
+  scan.transitive_includes = true;
+  scan.project_name = "depdiscover-bench";
+  fs::path out_dir = w.root / "out";
+  fs::create_directories(out_dir);
+  scan.output_path = (out_dir / "report.json").string();
+  scan.html_path = (out_dir / "report.html").string();
+  scan.markdown_path = (out_dir / "report.md").string();
+  scan.cyclonedx_path = (out_dir / "cyclonedx.json").string();
+
+  NullBuffer null_buffer;
+  int scan_status = 0;
+  ScanContext ctx(0);
+  auto scan_once = [&] {
+    auto *old = std::cerr.rdbuf(&null_buffer);
+    scan_status |= run_scan(scan, ctx);
+    std::cerr.rdbuf(old);
+  };
+
+  // The first scan fills the process-wide caches; later ones are warm
+  std::size_t before = osv.requests();
+  results.push_back(run("scan.cold", w.sources.size(), 1, scan_once));
+  results.back().osv_requests = osv.requests() - before;
+  before = osv.requests();
+  results.push_back(run("scan.warm", w.sources.size(), reps, scan_once));
+  results.back().osv_requests = (osv.requests() - before) / std::size_t(reps);
+  osv.stop();
+  if (scan_status != 0)
+    std::cerr << "[Warning] The end-to-end scan reported errors\n";
+
+  // --- Results ---
+  if (o.out_path.empty()) {
+    write_results(std::cout, o, w, results);
+  } else {
+    std::ofstream out(o.out_path);
+    write_results(out, o, w, results);
+    if (!out) {
+      std::cerr << "Error: Could not write " << o.out_path << "\n";
+      return 1;
+    }
+    std::cerr << "[Success] Results written to: " << o.out_path << "\n";
+  }
+
+  if (!o.keep) {
+    std::error_code ec;
+    fs::remove_all(w.root, ec);
+  }
+  return g_sink == 0 ? 1 : scan_status;
+}
@@ -0,0 +1,145 @@
+/**
+ * SPDX-FileComment: Include Lexer Micro-Benchmark
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file include_lexer_bench.cpp
+ * @brief Compares the hand-written include/flag lexer with the former
+ * std::regex implementation.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#include "include_lexer.hpp"
+#include "include_scanner.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// --- Former regex implementations (reference) ---
+
+std::vector<std::string> regex_scan_includes(const std::string &buffer) {
+  std::vector<std::string> out;
+  static const std::regex re(R"(\s*#\s*include\s*[<"]([^>"]+)[>"])");
+  std::istringstream in(buffer);
+  std::string line;
+  while (std::getline(in, line)) {
+    std::smatch m;
+    if (std::regex_search(line, m, re))
+      out.push_back(m[1].str());
+  }
+  return out;
+}
+
+std::vector<std::string> regex_extract(const std::string &cmd,
+                                       const char *pattern) {
+  std::vector<std::string> out;
+  std::regex re(pattern);
+  std::smatch m;
+  auto begin = cmd.cbegin();
+  while (std::regex_search(begin, cmd.cend(), m, re)) {
+    out.push_back(m[1]);
+    begin = m.suffix().first;
+  }
+  return out;
+}
+
+// --- Synthetic inputs ---
+
+std::string make_source(int lines) {
+  std::string s = "// Copyright header\n#pragma once\n";
+  for (int i = 0; i < lines; ++i) {
+    if (i % 20 == 0)
+      s += "#include <lib" + std::to_string(i % 7) + "/header" +
+           std::to_string(i) + ".h>\n";
+    else if (i % 20 == 10)
+      s += "#include \"local" + std::to_string(i) + ".hpp\"\n";
+    else
+      s += "  int value" + std::to_string(i) + " = compute(" +
+           std::to_string(i) + ", \"text\"); // trailing comment\n";
+  }
+  return s;
+}
+
+std::string make_command(int n) {
+  std::string s = "/usr/bin/c++ -DNDEBUG -O2 -std=c++23";
+  for (int i = 0; i < n; ++i) {
+    s += " -I/opt/project/module" + std::to_string(i) + "/include";
+    s += " -isystem /opt/deps/dep" + std::to_string(i) + "/include";
+    s += " -Wall -Wextra";
+  }
+  s += " -lssl -lcrypto -lz -o obj/main.o -c src/main.cpp";
+  return s;
+}
+
+template <class F> double time_ms(int iterations, F &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+    fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void report(const char *name, double regex_ms, double lexer_ms) {
+  std::cout << std::left << std::setw(22) << name << std::right << std::fixed
+            << std::setprecision(2) << std::setw(12) << regex_ms << " ms"
+            << std::setw(12) << lexer_ms << " ms" << std::setw(10)
+            << (lexer_ms > 0 ? regex_ms / lexer_ms : 0.0) << "x\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+  if (iterations <= 0)
+    iterations = 200;
+
+  const std::string source = make_source(2000);
+  const std::string command = make_command(40);
+
+  // Sanity check: both implementations agree on comment-free inputs
+  if (regex_scan_includes(source) !=
+          depdiscover::lex_include_directives(source) ||
+      regex_extract(command, "-l\\s*([^\\s]+)") !=
+          depdiscover::extract_libraries(command)) {
+    std::cerr << "[Error] Lexer and regex results differ\n";
+    return 1;
+  }
+
+  std::size_t sink = 0;
+  std::cout << std::left << std::setw(22) << "benchmark" << std::right
+            << std::setw(15) << "regex" << std::setw(15) << "lexer"
+            << std::setw(11) << "speedup" << "\n";
+
+  double r = time_ms(iterations,
+                     [&] { sink += regex_scan_includes(source).size(); });
+  double l = time_ms(iterations, [&] {
+    sink += depdiscover::lex_include_directives(source).size();
+  });
+  report("scan_includes", r, l);
+
+  r = time_ms(iterations * 10, [&] {
+    sink += regex_extract(command, "-I\\s*([^\\s]+)").size();
+    sink += regex_extract(command, "-l\\s*([^\\s]+)").size();
+  });
+  l = time_ms(iterations * 10, [&] {
+    sink += depdiscover::extract_include_paths(command).size();
+    sink += depdiscover::extract_libraries(command).size();
+  });
+  report("extract_flags", r, l);
+
+  return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,247 @@
+/**
+ * SPDX-FileComment: Mock OSV Server
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file mock_osv_server.hpp
+ * @brief Minimal loopback OSV API for offline end-to-end benchmarks.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+// POSIX
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace depdiscover::bench {
+
+/**
+ * @brief HTTP/1.1 server on 127.0.0.1 answering `/v1/querybatch` and
+ * `/v1/vulns/{id}` like OSV.
+ *
+ * Every fourth package (by name hash) has one vulnerability with a CVSS
+ * v3.1 vector, so the scan exercises the batch query, the detail fetches
+ * and the score extraction. An optional delay per request simulates
+ * network latency. Connections are kept alive; one thread per connection.
+ */
+class MockOsvServer {
+public:
+  explicit MockOsvServer(int delay_ms = 0) : delay_ms_(delay_ms) {}
+  MockOsvServer(const MockOsvServer &) = delete;
+  MockOsvServer &operator=(const MockOsvServer &) = delete;
+  ~MockOsvServer() { stop(); }
+
+  /**
+   * @brief Binds an ephemeral loopback port and starts accepting.
+   *
+   * @return true On success.
+   */
+  bool start() {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0)
+      return false;
+    int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) !=
+            0 ||
+        ::listen(listen_fd_, 64) != 0 ||
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &len) !=
+            0) {
+      ::close(listen_fd_);
+      listen_fd_ = -1;
+      return false;
+    }
+    port_ = ntohs(addr.sin_port);
+    acceptor_ = std::thread([this] { accept_loop(); });
+    return true;
+  }
+
+  /**
+   * @brief Closes all connections and joins the threads.
+   */
+  void stop() {
+    if (listen_fd_ < 0)
+      return;
+    stopping_ = true;
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    if (acceptor_.joinable())
+      acceptor_.join();
+    std::vector<std::thread> workers;
+    {
+      std::lock_guard lock(mutex_);
+      for (int fd : client_fds_)
+        ::shutdown(fd, SHUT_RDWR);
+      workers.swap(workers_);
+    }
+    for (auto &t : workers)
+      t.join();
+  }
+
+  /**
+   * @brief Base URL for `DEPDISCOVER_OSV_URL`.
+   */
+  std::string url() const {
+    return "http://127.0.0.1:" + std::to_string(port_) + "/v1";
+  }
+
+  /**
+   * @brief Number of HTTP requests answered so far.
+   */
+  std::size_t requests() const { return requests_.load(); }
+
+  /**
+   * @brief True if the package has a (synthetic) vulnerability.
+   */
+  static bool vulnerable(const std::string &name) {
+    std::uint32_t h = 2166136261u; // FNV-1a: same answer on every platform
+    for (unsigned char c : name)
+      h = (h ^ c) * 16777619u;
+    return h % 4 == 0;
+  }
+
+private:
+  void accept_loop() {
+    while (!stopping_) {
+      int fd = ::accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        if (stopping_)
+          return;
+        continue;
+      }
+      std::lock_guard lock(mutex_);
+      client_fds_.push_back(fd);
+      workers_.emplace_back([this, fd] { serve(fd); });
+    }
+  }
+
+  void serve(int fd) {
+    std::string buf;
+    char chunk[16384];
+    while (!stopping_) {
+      std::size_t header_end;
+      while ((header_end = buf.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0)
+          return close_client(fd);
+        buf.append(chunk, std::size_t(n));
+      }
+      std::string head = buf.substr(0, header_end);
+      std::size_t content_length = 0;
+      for (const char *name : {"Content-Length:", "content-length:"}) {
+        auto pos = head.find(name);
+        if (pos != std::string::npos)
+          content_length = std::stoul(head.substr(pos + std::strlen(name)));
+      }
+      while (buf.size() < header_end + 4 + content_length) {
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0)
+          return close_client(fd);
+        buf.append(chunk, std::size_t(n));
+      }
+      std::string body = buf.substr(header_end + 4, content_length);
+      buf.erase(0, header_end + 4 + content_length);
+
+      std::string method = head.substr(0, head.find(' '));
+      std::size_t path_start = method.size() + 1;
+      std::string path =
+          head.substr(path_start, head.find(' ', path_start) - path_start);
+
+      if (delay_ms_ > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms_));
+      std::string reply = respond(method, path, body);
+      std::string out = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                        "Content-Length: " +
+                        std::to_string(reply.size()) + "\r\n\r\n" + reply;
+      requests_++;
+      for (std::size_t sent = 0; sent < out.size();) {
+        ssize_t n = ::send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+          return close_client(fd);
+        sent += std::size_t(n);
+      }
+    }
+    close_client(fd);
+  }
+
+  void close_client(int fd) {
+    std::lock_guard lock(mutex_);
+    std::erase(client_fds_, fd);
+    ::close(fd);
+  }
+
+  std::string respond(const std::string &method, const std::string &path,
+                      const std::string &body) const {
+    using nlohmann::json;
+    if (method == "POST" && path.ends_with("/querybatch")) {
+      json results = json::array();
+      auto doc = json::parse(body, nullptr, false);
+      if (!doc.is_discarded() && doc.contains("queries"))
+        for (const auto &q : doc["queries"]) {
+          std::string name = q["package"].value("name", "");
+          json result = json::object();
+          if (vulnerable(name)) {
+            json vuln;
+            vuln["id"] = "BENCH-" + name + "-1";
+            vuln["modified"] = "2026-10-14T00:00:00Z";
+            result["vulns"] = json::array({vuln});
+          }
+          results.push_back(result);
+        }
+      return json{{"results", results}}.dump();
+    }
+    auto slash = path.rfind('/');
+    if (method == "GET" && path.find("/vulns/") != std::string::npos) {
+      std::string id = path.substr(slash + 1);
+      json severity, range, affected, vuln;
+      severity["type"] = "CVSS_V3";
+      severity["score"] = "CVSS:3.1/AV:N/AC:L/PR:N/UI:N/S:U/C:H/I:H/A:N";
+      range["type"] = "ECOSYSTEM";
+      range["events"] = json::parse(R"([{"introduced":"0"},{"fixed":"99.0"}])");
+      affected["ranges"] = json::array({range});
+      vuln["id"] = id;
+      vuln["summary"] = "Synthetic vulnerability for benchmarking";
+      vuln["severity"] = json::array({severity});
+      vuln["affected"] = json::array({affected});
+      return vuln.dump();
+    }
+    return json::object().dump();
+  }
+
+  int delay_ms_;
+  int listen_fd_ = -1;
+  std::uint16_t port_ = 0;
+  std::atomic<bool> stopping_{false};
+  std::atomic<std::size_t> requests_{0};
+  std::thread acceptor_;
+  std::mutex mutex_;
+  std::vector<int> client_fds_;
+  std::vector<std::thread> workers_;
+};
+
+} // namespace depdiscover::bench
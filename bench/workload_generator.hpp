@@ -0,0 +1,322 @@
+/**
+ * SPDX-FileComment: Synthetic Workload Generator
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file workload_generator.hpp
+ * @brief Creates reproducible synthetic projects for the benchmarks.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "json_writer.hpp"
+
+namespace depdiscover::bench {
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Size of a synthetic project.
+ */
+struct WorkloadOptions {
+  std::size_t tus = 500;            ///< Translation units in compile_commands.json.
+  std::size_t fanout = 12;          ///< #includes per TU and per header.
+  std::size_t deps = 40;            ///< Dependencies (vcpkg + conan).
+  std::size_t headers_per_dep = 30; ///< Headers per dependency.
+  std::size_t elf_files = 8;        ///< ELF fixtures in bin/.
+  std::uint32_t seed = 42;          ///< Same seed, same files.
+};
+
+/**
+ * @brief Paths of a generated project.
+ */
+struct Workload {
+  fs::path root;
+  fs::path compile_commands; ///< compile_commands.json
+  fs::path vcpkg;            ///< vcpkg.json (first half of the deps)
+  fs::path conan;            ///< conanfile.txt (second half)
+  fs::path bin_dir;          ///< ELF fixtures
+  std::vector<std::string> dep_names;
+  std::vector<std::string> sources;     ///< Absolute TU paths.
+  std::vector<std::string> headers;     ///< Absolute header paths.
+  std::vector<std::string> license_files;
+  std::vector<std::string> commands;    ///< One compiler command per TU.
+  std::vector<std::string> elf_files;
+};
+
+namespace workload_detail {
+
+/// License texts cycled over the dependencies (abridged, but classifiable).
+inline const char *const LICENSE_TEXTS[] = {
+    "MIT License\n\nCopyright (c) 2026 Bench Authors\n\n"
+    "Permission is hereby granted, free of charge, to any person obtaining a "
+    "copy\nof this software and associated documentation files (the "
+    "\"Software\"), to deal\nin the Software without restriction, including "
+    "without limitation the rights\nto use, copy, modify, merge, publish, "
+    "distribute, sublicense, and/or sell\ncopies of the Software.\n",
+    "                                 Apache License\n"
+    "                           Version 2.0, January 2004\n"
+    "                        http://www.apache.org/licenses/\n\n"
+    "   TERMS AND CONDITIONS FOR USE, REPRODUCTION, AND DISTRIBUTION\n\n"
+    "   1. Definitions.\n\n      \"License\" shall mean the terms and "
+    "conditions for use, reproduction,\n      and distribution as defined by "
+    "Sections 1 through 9 of this document.\n",
+    "Copyright (c) 2026, Bench Authors\nAll rights reserved.\n\n"
+    "Redistribution and use in source and binary forms, with or without\n"
+    "modification, are permitted provided that the following conditions are "
+    "met:\n\n3. Neither the name of the copyright holder nor the names of its\n"
+    "   contributors may be used to endorse or promote products derived from\n"
+    "   this software without specific prior written permission.\n",
+    "Boost Software License - Version 1.0 - August 17th, 2003\n\n"
+    "Permission is hereby granted, free of charge, to any person or "
+    "organization\nobtaining a copy of the software and accompanying "
+    "documentation covered by\nthis license (the \"Software\") to use, "
+    "reproduce, display, distribute,\nexecute, and transmit the Software.\n",
+    "/* SPDX-License-Identifier: Zlib */\n\nThis software is provided "
+    "'as-is', without any express or implied\nwarranty. Altered source "
+    "versions must be plainly marked as such, and must\nnot be "
+    "misrepresented as being the original software.\n",
+};
+
+inline void write_file(const fs::path &path, const std::string &content) {
+  fs::create_directories(path.parent_path());
+  std::ofstream out(path, std::ios::binary);
+  out << content;
+}
+
+inline std::string dep_name(std::size_t d) {
+  std::string n = std::to_string(d);
+  return "pkg" + std::string(n.size() < 3 ? 3 - n.size() : 0, '0') + n;
+}
+
+inline std::string header_name(std::size_t d, std::size_t h) {
+  return dep_name(d) + "/module" + std::to_string(h) + ".hpp";
+}
+
+/// Filler code between the directives (realistic file sizes for the lexer).
+inline void append_body(std::string &s, std::size_t lines, std::size_t salt) {
+  for (std::size_t i = 0; i < lines; ++i)
+    s += "inline int value_" + std::to_string(salt) + "_" + std::to_string(i) +
+         "(int x) { return x * " + std::to_string(i + 1) +
+         "; } // \"quoted\" text\n";
+}
+
+template <class T> void put(std::string &buf, std::size_t off, T value) {
+  std::memcpy(buf.data() + off, &value, sizeof(T));
+}
+
+/**
+ * @brief Builds a minimal little-endian ELF64 shared object that only
+ * carries a dynamic section (DT_NEEDED, DT_SONAME, DT_RUNPATH).
+ */
+inline std::string make_elf(const std::string &soname,
+                            const std::vector<std::string> &needed) {
+  constexpr std::uint64_t BASE = 0x400000;
+  constexpr std::size_t EHDR = 64, PHDR = 56, PHNUM = 2;
+
+  std::string strtab(1, '\0');
+  auto add_str = [&](const std::string &s) {
+    std::uint64_t off = strtab.size();
+    strtab += s;
+    strtab += '\0';
+    return off;
+  };
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> dyn;
+  for (const auto &n : needed)
+    dyn.emplace_back(1 /* DT_NEEDED */, add_str(n));
+  dyn.emplace_back(14 /* DT_SONAME */, add_str(soname));
+  dyn.emplace_back(29 /* DT_RUNPATH */, add_str("$ORIGIN/../lib"));
+
+  const std::size_t dyn_off = EHDR + PHNUM * PHDR;
+  const std::size_t dyn_size = (dyn.size() + 3) * 16; // + STRTAB, STRSZ, NULL
+  const std::size_t str_off = dyn_off + dyn_size;
+  dyn.emplace_back(5 /* DT_STRTAB */, BASE + str_off);
+  dyn.emplace_back(10 /* DT_STRSZ */, strtab.size());
+  dyn.emplace_back(0 /* DT_NULL */, 0);
+
+  std::string buf(str_off + strtab.size(), '\0');
+  const unsigned char ident[] = {0x7f, 'E', 'L', 'F', 2, 1, 1};
+  std::memcpy(buf.data(), ident, sizeof(ident));
+  put<std::uint16_t>(buf, 16, 3);  // ET_DYN
+  put<std::uint16_t>(buf, 18, 62); // EM_X86_64
+  put<std::uint32_t>(buf, 20, 1);
+  put<std::uint64_t>(buf, 32, EHDR);
+  put<std::uint16_t>(buf, 52, EHDR);
+  put<std::uint16_t>(buf, 54, PHDR);
+  put<std::uint16_t>(buf, 56, PHNUM);
+
+  // PT_LOAD over the whole file, PT_DYNAMIC over the dynamic section
+  std::size_t p = EHDR;
+  put<std::uint32_t>(buf, p, 1);
+  put<std::uint64_t>(buf, p + 16, BASE);
+  put<std::uint64_t>(buf, p + 32, buf.size());
+  put<std::uint64_t>(buf, p + 40, buf.size());
+  p += PHDR;
+  put<std::uint32_t>(buf, p, 2);
+  put<std::uint64_t>(buf, p + 8, dyn_off);
+  put<std::uint64_t>(buf, p + 16, BASE + dyn_off);
+  put<std::uint64_t>(buf, p + 32, dyn_size);
+  put<std::uint64_t>(buf, p + 40, dyn_size);
+
+  for (std::size_t i = 0; i < dyn.size(); ++i) {
+    put<std::uint64_t>(buf, dyn_off + i * 16, dyn[i].first);
+    put<std::uint64_t>(buf, dyn_off + i * 16 + 8, dyn[i].second);
+  }
+  std::memcpy(buf.data() + str_off, strtab.data(), strtab.size());
+  return buf;
+}
+
+} // namespace workload_detail
+
+/**
+ * @brief Writes a synthetic project below `root` (replacing its contents).
+ *
+ * The project has one header tree with a LICENSE file per dependency
+ * (headers include `fanout` headers of the same dependency and sometimes
+ * of the next one), `tus` sources with `fanout` includes each, a
+ * compile_commands.json with one `-I` per dependency, vcpkg/conan
+ * manifests and ELF fixtures whose DT_NEEDED entries name the dependency
+ * libraries. All choices come from a fixed-seed generator.
+ *
+ * @param root The target directory.
+ * @param opt The workload size.
+ * @return Workload The generated paths.
+ */
+inline Workload generate_workload(const fs::path &root,
+                                  const WorkloadOptions &opt) {
+  using namespace workload_detail;
+  std::error_code ec;
+  fs::remove_all(root, ec);
+  fs::create_directories(root);
+
+  Workload w;
+  w.root = fs::absolute(root).lexically_normal();
+  std::mt19937 rng(opt.seed); // fully specified sequence, unlike distributions
+  auto pick = [&](std::size_t n) { return n ? std::size_t(rng() % n) : 0; };
+  const std::size_t deps = std::max<std::size_t>(opt.deps, 1);
+  const std::size_t hpd = std::max<std::size_t>(opt.headers_per_dep, 1);
+
+  // --- Header trees with licenses ---
+  for (std::size_t d = 0; d < deps; ++d) {
+    w.dep_names.push_back(dep_name(d));
+    fs::path dep_root = w.root / "third_party" / dep_name(d);
+    fs::path license = dep_root / "LICENSE";
+    write_file(license, LICENSE_TEXTS[d % std::size(LICENSE_TEXTS)]);
+    w.license_files.push_back(license.string());
+
+    for (std::size_t h = 0; h < hpd; ++h) {
+      std::string s = "#pragma once\n";
+      for (std::size_t f = 0; f < opt.fanout; ++f) {
+        // Mostly deeper headers of the same dependency (a DAG), sometimes
+        // the next dependency
+        std::size_t target_dep = pick(8) == 0 ? (d + 1) % deps : d;
+        std::size_t target = target_dep == d
+                                 ? (h + 1 < hpd ? h + 1 + pick(hpd - h - 1) : h)
+                                 : pick(hpd);
+        if (target_dep == d && target == h)
+          continue;
+        s += "#include <" + header_name(target_dep, target) + ">\n";
+      }
+      s += "#include <vector>\n";
+      append_body(s, 20, d * hpd + h);
+      fs::path path = dep_root / "include" / header_name(d, h);
+      write_file(path, s);
+      w.headers.push_back(path.string());
+    }
+  }
+
+  // --- Sources and compile_commands.json ---
+  std::string include_flags;
+  for (std::size_t d = 0; d < deps; ++d)
+    include_flags += " -I" + (w.root / "third_party" / dep_name(d) /
+                              "include").string();
+  w.compile_commands = w.root / "compile_commands.json";
+  {
+    std::ofstream out(w.compile_commands);
+    JsonWriter json(out, 2);
+    json.begin_array();
+    for (std::size_t t = 0; t < opt.tus; ++t) {
+      std::string s = "#include <cstdio>\n#include \"local.hpp\"\n";
+      for (std::size_t f = 0; f < opt.fanout; ++f)
+        s += "#include <" + header_name(pick(deps), pick(hpd)) + ">\n";
+      append_body(s, 60, t);
+      fs::path src = w.root / "src" / ("module" + std::to_string(t % 16)) /
+                     ("unit" + std::to_string(t) + ".cpp");
+      write_file(src, s);
+      if (t < 16)
+        write_file(src.parent_path() / "local.hpp", "#pragma once\n");
+      w.sources.push_back(src.string());
+
+      std::string obj = "obj/unit" + std::to_string(t) + ".o";
+      std::string cmd = "/usr/bin/c++ -DNDEBUG -O2 -std=c++23" + include_flags +
+                        " -I" + src.parent_path().string() +
+                        " -isystem /usr/include -Wall -Wextra -o " + obj +
+                        " -c " + src.string();
+      w.commands.push_back(cmd);
+      json.begin_object()
+          .key("directory").value(w.root.string())
+          .key("command").value(cmd)
+          .key("file").value(src.string())
+          .key("output").value(obj)
+          .end_object();
+    }
+    json.end_array();
+    out << "\n";
+  }
+
+  // --- Manifests ---
+  w.vcpkg = w.root / "vcpkg.json";
+  w.conan = w.root / "conanfile.txt";
+  {
+    std::ofstream out(w.vcpkg);
+    JsonWriter json(out, 2);
+    json.begin_object().key("name").value("bench-project");
+    json.key("dependencies").begin_array();
+    for (std::size_t d = 0; d < deps / 2; ++d)
+      json.begin_object()
+          .key("name").value(dep_name(d))
+          .key("version>=").value("1." + std::to_string(d) + ".0")
+          .end_object();
+    json.end_array().end_object();
+    out << "\n";
+  }
+  {
+    std::string s = "[requires]\n";
+    for (std::size_t d = deps / 2; d < deps; ++d)
+      s += dep_name(d) + "/2." + std::to_string(d) + ".1\n";
+    s += "\n[generators]\nCMakeDeps\nCMakeToolchain\n";
+    write_file(w.conan, s);
+  }
+
+  // --- ELF fixtures ---
+  w.bin_dir = w.root / "bin";
+  fs::create_directories(w.bin_dir);
+  for (std::size_t e = 0; e < opt.elf_files; ++e) {
+    std::vector<std::string> needed = {"libc.so.6", "libstdc++.so.6"};
+    for (std::size_t n = 0; n < 4; ++n)
+      needed.push_back("lib" + dep_name(pick(deps)) + ".so.1");
+    fs::path path = w.bin_dir / ("app" + std::to_string(e));
+    write_file(path, make_elf("app" + std::to_string(e), needed));
+    w.elf_files.push_back(path.string());
+  }
+  return w;
+}
+
+} // namespace depdiscover::bench
@@ -0,0 +1,427 @@
+/**
+ * SPDX-FileComment: Multi-Project Batch Scans
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file batch_runner.hpp
+ * @brief Scans a list of projects in one process and writes a fleet summary.
+ * @version 1.0.2
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "json_writer.hpp"
+#include "report_model.hpp"
+#include "scan_runner.hpp"
+
+namespace depdiscover {
+
+/**
+ * @brief One entry of a `--batch` project list.
+ */
+struct BatchProject {
+  std::string name;              ///< Project name of the reports.
+  fs::path root;                 ///< Working directory of the scan.
+  std::vector<std::string> args; ///< Scan options of this project.
+};
+
+/**
+ * @brief Outcome of one project of a batch.
+ */
+struct BatchProjectResult {
+  std::string name;
+  fs::path root;
+  std::string report; ///< JSON report path (relative to `root`).
+  int exit_code = 1;
+  std::vector<Dependency> deps; ///< Name, version and CVEs only (see
+                                ///< keep_summary_fields()).
+};
+
+namespace batch_detail {
+
+/// Project list members naming a path, with the option they stand for.
+inline constexpr std::pair<const char *, const char *> PATH_MEMBERS[] = {
+    {"compile_commands", "--compile-commands"},
+    {"libs", "--libs"},
+    {"vcpkg", "--vcpkg"},
+    {"conan", "--conan"},
+    {"cmake", "--cmake"},
+    {"output", "--output"},
+    {"html", "--html"},
+    {"markdown", "--markdown"},
+    {"cyclonedx", "--cyclonedx"},
+    {"suppressions", "--suppressions"},
+    {"state_file", "--state-file"},
+    {"save", "--save"},
+};
+
+/**
+ * @brief Builds a project from a list entry.
+ *
+ * @param entry A root path or an object with `root` and optional members.
+ * @param base Directory that relative roots are resolved against.
+ * @return BatchProject The project.
+ * @throws nlohmann::json::exception If the entry is malformed.
+ */
+inline BatchProject parse_project(const nlohmann::json &entry,
+                                  const fs::path &base) {
+  BatchProject p;
+  const nlohmann::json root =
+      entry.is_string() ? entry : entry.at("root");
+  p.root = (base / root.get<std::string>()).lexically_normal();
+  if (p.root.has_filename())
+    p.name = p.root.filename().string();
+  else
+    p.name = p.root.parent_path().filename().string();
+  if (!entry.is_object())
+    return p;
+
+  p.name = entry.value("name", p.name);
+  for (const auto &[member, flag] : PATH_MEMBERS)
+    if (entry.contains(member)) {
+      p.args.push_back(flag);
+      p.args.push_back(entry.at(member).get<std::string>());
+    }
+  if (entry.contains("binaries")) {
+    const auto &binaries = entry.at("binaries");
+    for (const auto &b : binaries.is_array() ? binaries
+                                             : nlohmann::json::array({binaries})) {
+      p.args.push_back("--binary");
+      p.args.push_back(b.get<std::string>());
+    }
+  }
+  if (entry.contains("args")) {
+    auto extra = entry.at("args").get<std::vector<std::string>>();
+    p.args.insert(p.args.end(), extra.begin(), extra.end());
+  }
+  return p;
+}
+
+/**
+ * @brief Aggregate of one (package, version) over the fleet.
+ */
+struct FleetPackage {
+  std::set<std::size_t> projects;       ///< Indices of the results.
+  std::set<std::string> vulnerabilities; ///< Active in some project.
+  double max_score = 0.0;
+};
+
+/**
+ * @brief Drops everything the fleet summary does not read.
+ *
+ * The header and library lists dominate the size of a result and would
+ * otherwise be held for every project until the batch ends.
+ */
+inline void keep_summary_fields(std::vector<Dependency> &deps) {
+  for (auto &dep : deps) {
+    std::vector<std::string>().swap(dep.headers);
+    std::vector<std::string>().swap(dep.libraries);
+    std::vector<std::string>().swap(dep.licenses);
+    std::string().swap(dep.type);
+    std::string().swap(dep.source);
+  }
+  deps.shrink_to_fit();
+}
+
+} // namespace batch_detail
+
+/**
+ * @brief Loads a `--batch` project list.
+ *
+ * The list is a JSON array, or an object with a `projects` array. Each
+ * entry is a project root, or an object with a `root`, an optional `name`
+ * (default: the root's directory name), the path members of
+ * batch_detail::PATH_MEMBERS, `binaries` (a path or a list) and `args`
+ * (further command-line options). Relative roots are resolved against the
+ * directory of the list; all other paths against the project root.
+ *
+ * @param path The list file.
+ * @param projects Receives the projects.
+ * @param error Receives a description on failure.
+ * @return true On success.
+ */
+inline bool load_batch_projects(const std::string &path,
+                                std::vector<BatchProject> &projects,
+                                std::string &error) {
+  std::ifstream f(path);
+  if (!f) {
+    error = "cannot read file";
+    return false;
+  }
+  nlohmann::json doc = nlohmann::json::parse(f, nullptr, false);
+  if (doc.is_object() && doc.contains("projects"))
+    doc = doc["projects"];
+  if (doc.is_discarded() || !doc.is_array()) {
+    error = "expected an array of projects";
+    return false;
+  }
+
+  const fs::path base = fs::absolute(path).parent_path();
+  projects.clear();
+  try {
+    for (const auto &entry : doc)
+      projects.push_back(batch_detail::parse_project(entry, base));
+  } catch (const std::exception &e) {
+    error = "project " + std::to_string(projects.size() + 1) + ": " + e.what();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Writes the fleet summary of a batch as JSON.
+ *
+ * Lists every project with its outcome, every unique (package, version)
+ * with the projects using it, and the totals. Vulnerabilities count once
+ * per ID; findings once per project, dependency and ID.
+ *
+ * @param out The stream to write to.
+ * @param results The project outcomes.
+ */
+inline void write_fleet_summary(std::ostream &out,
+                                const std::vector<BatchProjectResult> &results) {
+  struct ProjectTotals {
+    int active = 0;
+    int suppressed = 0;
+    double max_score = 0.0;
+  };
+  std::vector<ProjectTotals> totals(results.size());
+  std::map<std::pair<std::string, std::string>, batch_detail::FleetPackage>
+      packages;
+  std::map<std::string, SeverityLevel> vulnerabilities;
+  std::size_t failed = 0;
+  std::size_t vulnerable_packages = 0;
+  int findings = 0;
+
+  for (std::size_t r = 0; r < results.size(); ++r) {
+    if (results[r].exit_code != 0)
+      ++failed;
+    for (const auto &dep : results[r].deps) {
+      auto &pkg = packages[{dep.name, dep.version}];
+      pkg.projects.insert(r);
+      for (const auto &cve : dep.cves) {
+        if (is_cve_marker(cve.id))
+          continue;
+        if (cve.suppressed) {
+          totals[r].suppressed++;
+          continue;
+        }
+        totals[r].active++;
+        totals[r].max_score = std::max(totals[r].max_score, cve.score);
+        pkg.max_score = std::max(pkg.max_score, cve.score);
+        pkg.vulnerabilities.insert(cve.id);
+        vulnerabilities.try_emplace(cve.id,
+                                    severity_level(cve.score, cve.severity));
+      }
+    }
+    findings += totals[r].active;
+  }
+  SeverityHistogram severities;
+  for (const auto &[id, level] : vulnerabilities)
+    severities.active[static_cast<std::size_t>(level)]++;
+
+  JsonWriter w(out, 2);
+  w.begin_object().key("header").begin_object()
+      .key("platform").value(get_platform_name())
+      .key("scan_date").value(get_current_date())
+      .key("schema_version").value(SCHEMA_VERSION)
+      .key("tool").begin_object()
+      .key("name").value(rz::config::PROJECT_NAME)
+      .key("version").value(rz::config::VERSION)
+      .end_object()
+      .end_object();
+
+  w.key("packages").begin_array();
+  for (const auto &[key, pkg] : packages) {
+    if (!pkg.vulnerabilities.empty())
+      ++vulnerable_packages;
+    w.begin_object()
+        .key("max_score").value(pkg.max_score)
+        .key("name").value(key.first)
+        .key("projects").begin_array();
+    for (auto r : pkg.projects)
+      w.value(results[r].name);
+    w.end_array()
+        .key("version").value(key.second)
+        .key("vulnerabilities").string_array(pkg.vulnerabilities)
+        .end_object();
+  }
+  w.end_array();
+
+  w.key("projects").begin_array();
+  for (std::size_t r = 0; r < results.size(); ++r) {
+    const auto &res = results[r];
+    w.begin_object()
+        .key("dependencies").value(static_cast<std::int64_t>(res.deps.size()))
+        .key("exit_code").value(res.exit_code)
+        .key("findings").value(totals[r].active)
+        .key("max_score").value(totals[r].max_score)
+        .key("name").value(res.name)
+        .key("report").value(res.report)
+        .key("root").value(res.root.string())
+        .key("suppressed").value(totals[r].suppressed)
+        .end_object();
+  }
+  w.end_array();
+
+  w.key("summary").begin_object()
+      .key("failed_projects").value(static_cast<std::int64_t>(failed))
+      .key("findings").value(findings)
+      .key("packages").value(static_cast<std::int64_t>(packages.size()))
+      .key("projects").value(static_cast<std::int64_t>(results.size()))
+      .key("severities").begin_object();
+  for (std::size_t l = 0; l < severities.active.size(); ++l)
+    w.key(SEVERITY_LEVEL_NAMES[l]).value(severities.active[l]);
+  w.end_object()
+      .key("vulnerabilities")
+      .value(static_cast<std::int64_t>(vulnerabilities.size()))
+      .key("vulnerable_packages")
+      .value(static_cast<std::int64_t>(vulnerable_packages))
+      .end_object()
+      .end_object();
+  out << "\n";
+}
+
+/**
+ * @brief Scans every project of a `--batch` list with one scan context.
+ *
+ * The projects run one after another on the context's pool, so the header,
+ * include graph, pkg-config, ELF and license caches stay warm across them
+ * (begin_scan() revalidates them per project). OSV results are shared
+ * through the CVE cache of the context, in memory unless a cache directory
+ * is given: each (package, version) of the fleet is queried once.
+ *
+ * The options of the command line apply to every project; its `-o` names
+ * the fleet summary, and report paths default per project root. Pool,
+ * network and profiling options apply to the whole batch.
+ *
+ * @param opt The command-line options (with `batch_path`).
+ * @param ctx The scan context shared by the projects.
+ * @return int 0 if every project passed, 1 otherwise.
+ */
+inline int run_batch(const ScanOptions &opt, ScanContext &ctx) {
+  std::vector<BatchProject> projects;
+  std::string error;
+  if (!load_batch_projects(opt.batch_path, projects, error)) {
+    std::cerr << "Error: Could not load " << opt.batch_path << ": " << error
+              << "\n";
+    return 1;
+  }
+  std::cerr << "[Info] Loaded " << projects.size()
+            << " projects from: " << opt.batch_path << "\n";
+
+  // Options shared by all projects; paths given here stay valid after the
+  // directory changes
+  ScanOptions base = opt;
+  base.batch_path.clear();
+  base.output_path.clear();
+  base.profile = false;
+  base.profile_trace.clear();
+  base.share_cve_results = true;
+  if (!base.cve_cache_dir.empty())
+    base.cve_cache_dir = fs::absolute(base.cve_cache_dir).string();
+  if (!base.suppressions_path.empty())
+    base.suppressions_path = fs::absolute(base.suppressions_path).string();
+  const std::string summary_path =
+      opt.output_path.empty()
+          ? default_report_path("_depdiscover_fleet.json")
+          : opt.output_path;
+  const fs::path summary_abs = fs::absolute(summary_path);
+
+  return run_profiled(opt, [&] {
+    std::vector<BatchProjectResult> results;
+    results.reserve(projects.size());
+    for (std::size_t i = 0; i < projects.size(); ++i) {
+      const auto &p = projects[i];
+      std::cerr << "\n[Batch] Project " << i + 1 << "/" << projects.size()
+                << ": " << p.name << " (" << p.root.string() << ")\n";
+
+      BatchProjectResult &res = results.emplace_back();
+      res.name = p.name;
+      res.root = p.root;
+
+      ScanOptions o = base;
+      o.project_name = p.name;
+      if (parse_scan_args(p.args, o) != 0)
+        continue; // parse_scan_args() reported the error
+      if (o.show_help || o.only_version || o.only_check ||
+          !o.serve_socket.empty() || !o.connect_socket.empty() ||
+          !o.batch_path.empty() || !o.load_path.empty() ||
+          !o.diff_old.empty()) {
+        std::cerr << "Error: option not supported in batch projects.\n";
+        continue;
+      }
+      std::error_code ec;
+      if (!fs::is_directory(p.root, ec)) {
+        std::cerr << "Error: project root not found: " << p.root.string()
+                  << "\n";
+        continue;
+      }
+      res.report = o.output_path.empty()
+                       ? default_report_path("_depdiscover.json")
+                       : o.output_path;
+
+      fs::path previous = fs::current_path();
+      fs::current_path(p.root); // projects are scanned one at a time
+      try {
+        res.exit_code = scan_project(o, ctx, nullptr, &res.deps);
+        batch_detail::keep_summary_fields(res.deps);
+      } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        res.exit_code = 1;
+      }
+      fs::current_path(previous);
+      ctx.end_scan();
+    }
+
+    std::cerr << "\n";
+    if (summary_abs.has_parent_path()) {
+      std::error_code ec;
+      fs::create_directories(summary_abs.parent_path(), ec);
+    }
+    std::ofstream out(summary_abs);
+    if (!out) {
+      std::cerr << "Error: Could not write output file: " << summary_path
+                << "\n";
+      return 1;
+    }
+    write_fleet_summary(out, results);
+    out.close();
+    if (!out) {
+      std::cerr << "Error: Could not write output file: " << summary_path
+                << "\n";
+      return 1;
+    }
+
+    std::size_t failed = std::count_if(
+        results.begin(), results.end(),
+        [](const BatchProjectResult &r) { return r.exit_code != 0; });
+    std::cerr << "[Batch] " << results.size() << " projects scanned, "
+              << failed << " failed.\n";
+    std::cerr << "[Success] Fleet summary written to: " << summary_path
+              << "\n";
+    return failed == 0 ? 0 : 1;
+  });
+}
+
+} // namespace depdiscover
@@ -0,0 +1,455 @@
+/**
+ * SPDX-FileComment: Binary SBOM Format
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file binary_sbom.hpp
+ * @brief Compact, memory-mappable serialization of a scan result.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "file_reader.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace depdiscover {
+
+namespace fs = std::filesystem;
+
+/*
+ * Layout (all integers little-endian, no padding):
+ *
+ *   magic        8 bytes  "DDSBOM\0\0"
+ *   version      u32      BINARY_SBOM_VERSION
+ *   strings      u32      number of distinct strings
+ *   deps         u32      number of dependencies
+ *   cves         u32      number of CVE records
+ *   lists        u32      number of string-list entries
+ *   blob_size    u32      size of the string blob
+ *   header       9 x u32  string ids of the ReportHeader fields
+ *   string index strings x (u32 offset, u32 length) into the blob
+ *   dep records  deps x 12 u32: name, version, type, source, then
+ *                (first, count) for headers, libraries, licenses (in the
+ *                list section) and cves (in the CVE section)
+ *   cve records  cves x (id, summary, severity, fixed_version,
+ *                suppression_reason, flags: u32; score: IEEE-754 u64)
+ *   lists        lists x (dir, leaf: u32 string ids); list items are split
+ *                at the last '/' so that directories are stored once, `dir`
+ *                is NO_STRING for items without '/'
+ *   blob         string bytes (each distinct string once)
+ *
+ * Everything is validated once on open; afterwards all accessors are plain
+ * offset lookups that return views into the mapping.
+ */
+
+inline constexpr std::uint32_t BINARY_SBOM_VERSION = 1;
+
+namespace sbom_detail {
+
+inline constexpr char MAGIC[8] = {'D', 'D', 'S', 'B', 'O', 'M', '\0', '\0'};
+inline constexpr std::size_t PREAMBLE = 8 + 6 * 4;
+inline constexpr std::size_t HEADER_FIELDS = 9;
+inline constexpr std::size_t DEP_WORDS = 12;
+inline constexpr std::size_t CVE_SIZE = 6 * 4 + 8;
+inline constexpr std::uint32_t FLAG_SUPPRESSED = 1;
+inline constexpr std::uint32_t NO_STRING = 0xffffffffu;
+
+inline std::uint32_t load_u32(const char *p) {
+  const auto *b = reinterpret_cast<const unsigned char *>(p);
+  return std::uint32_t(b[0]) | (std::uint32_t(b[1]) << 8) |
+         (std::uint32_t(b[2]) << 16) | (std::uint32_t(b[3]) << 24);
+}
+
+inline std::uint64_t load_u64(const char *p) {
+  return std::uint64_t(load_u32(p)) | (std::uint64_t(load_u32(p + 4)) << 32);
+}
+
+inline void put_u32(std::string &out, std::uint32_t v) {
+  char b[4] = {char(v & 0xff), char((v >> 8) & 0xff), char((v >> 16) & 0xff),
+               char((v >> 24) & 0xff)};
+  out.append(b, 4);
+}
+
+inline void put_u64(std::string &out, std::uint64_t v) {
+  put_u32(out, std::uint32_t(v & 0xffffffffu));
+  put_u32(out, std::uint32_t(v >> 32));
+}
+
+/**
+ * @brief Interns strings into the blob while writing.
+ */
+class StringTable {
+public:
+  std::uint32_t add(std::string_view s) {
+    auto it = ids_.find(s);
+    if (it != ids_.end())
+      return it->second;
+    if (blob_.size() + s.size() > std::numeric_limits<std::uint32_t>::max())
+      throw std::runtime_error("binary SBOM string blob exceeds 4 GiB");
+    auto id = static_cast<std::uint32_t>(index_.size() / 8);
+    put_u32(index_, static_cast<std::uint32_t>(blob_.size()));
+    put_u32(index_, static_cast<std::uint32_t>(s.size()));
+    blob_.append(s);
+    ids_.emplace(s, id); // views into the caller's strings, alive until done
+    return id;
+  }
+  std::uint32_t count() const {
+    return static_cast<std::uint32_t>(index_.size() / 8);
+  }
+  const std::string &index() const { return index_; }
+  const std::string &blob() const { return blob_; }
+
+private:
+  std::unordered_map<std::string_view, std::uint32_t> ids_;
+  std::string index_;
+  std::string blob_;
+};
+
+} // namespace sbom_detail
+
+/**
+ * @brief Writes a scan result in the binary SBOM format.
+ *
+ * @param out The output stream (opened in binary mode).
+ * @param header The report header.
+ * @param deps The dependencies.
+ */
+inline void write_binary_sbom(std::ostream &out, const ReportHeader &header,
+                              const std::vector<Dependency> &deps) {
+  using namespace sbom_detail;
+  StringTable strings;
+  std::string head, dep_records, cve_records, lists;
+  std::uint32_t cve_count = 0, list_count = 0;
+
+  for (const std::string *f :
+       {&header.schema_version, &header.scan_date, &header.tool_name,
+        &header.tool_version, &header.tool_description, &header.tool_homepage,
+        &header.tool_author, &header.project_name, &header.workspace_root})
+    put_u32(head, strings.add(*f));
+
+  auto put_list = [&](const std::vector<std::string> &items) {
+    put_u32(dep_records, list_count);
+    put_u32(dep_records, static_cast<std::uint32_t>(items.size()));
+    for (const auto &s : items) {
+      std::string_view item = s;
+      std::size_t slash = item.rfind('/');
+      if (slash == std::string_view::npos) {
+        put_u32(lists, NO_STRING);
+        put_u32(lists, strings.add(item));
+      } else {
+        put_u32(lists, strings.add(item.substr(0, slash)));
+        put_u32(lists, strings.add(item.substr(slash + 1)));
+      }
+    }
+    list_count += static_cast<std::uint32_t>(items.size());
+  };
+
+  for (const auto &d : deps) {
+    put_u32(dep_records, strings.add(d.name));
+    put_u32(dep_records, strings.add(d.version));
+    put_u32(dep_records, strings.add(d.type));
+    put_u32(dep_records, strings.add(d.source));
+    put_list(d.headers);
+    put_list(d.libraries);
+    put_list(d.licenses);
+    put_u32(dep_records, cve_count);
+    put_u32(dep_records, static_cast<std::uint32_t>(d.cves.size()));
+    for (const auto &c : d.cves) {
+      put_u32(cve_records, strings.add(c.id));
+      put_u32(cve_records, strings.add(c.summary));
+      put_u32(cve_records, strings.add(c.severity));
+      put_u32(cve_records, strings.add(c.fixed_version));
+      put_u32(cve_records, strings.add(c.suppression_reason));
+      put_u32(cve_records, c.suppressed ? FLAG_SUPPRESSED : 0);
+      std::uint64_t bits;
+      std::memcpy(&bits, &c.score, sizeof(bits));
+      put_u64(cve_records, bits);
+    }
+    cve_count += static_cast<std::uint32_t>(d.cves.size());
+  }
+
+  std::string preamble(MAGIC, sizeof(MAGIC));
+  put_u32(preamble, BINARY_SBOM_VERSION);
+  put_u32(preamble, strings.count());
+  put_u32(preamble, static_cast<std::uint32_t>(deps.size()));
+  put_u32(preamble, cve_count);
+  put_u32(preamble, list_count);
+  put_u32(preamble, static_cast<std::uint32_t>(strings.blob().size()));
+
+  const std::string *sections[] = {&preamble,    &head,        &strings.index(),
+                                   &dep_records, &cve_records, &lists,
+                                   &strings.blob()};
+  for (const std::string *section : sections)
+    out.write(section->data(), static_cast<std::streamsize>(section->size()));
+}
+
+/**
+ * @brief Read-only view of a binary SBOM file.
+ *
+ * The file is memory-mapped; string accessors return views into the
+ * mapping and stay valid for the lifetime of the object.
+ */
+class BinarySbom {
+public:
+  /**
+   * @brief One list item (header, library or license), split at the last '/'.
+   */
+  struct ItemView {
+    std::string_view dir; ///< Part before the last '/' (if `has_dir`).
+    std::string_view leaf;
+    bool has_dir = false;
+
+    std::string str() const {
+      if (!has_dir)
+        return std::string(leaf);
+      std::string out;
+      out.reserve(dir.size() + 1 + leaf.size());
+      out.append(dir).append(1, '/').append(leaf);
+      return out;
+    }
+  };
+
+  /**
+   * @brief One CVE record.
+   */
+  struct CveView {
+    std::string_view id;
+    std::string_view summary;
+    std::string_view severity;
+    std::string_view fixed_version;
+    std::string_view suppression_reason;
+    double score = 0.0;
+    bool suppressed = false;
+  };
+
+  /**
+   * @brief Opens and validates a file.
+   *
+   * @param path The file.
+   * @param error Receives a description if the file is rejected.
+   * @return true If the file is a valid binary SBOM.
+   */
+  bool open(const fs::path &path, std::string *error = nullptr) {
+    using namespace sbom_detail;
+    ok_ = false;
+    auto fail = [&](const char *why) {
+      if (error)
+        *error = why;
+      return false;
+    };
+    if (!file_.open(path))
+      return fail("cannot read file");
+    data_ = file_.view();
+    if (data_.size() < PREAMBLE ||
+        std::memcmp(data_.data(), MAGIC, sizeof(MAGIC)) != 0)
+      return fail("not a binary SBOM");
+    if (load_u32(data_.data() + 8) != BINARY_SBOM_VERSION)
+      return fail("unsupported binary SBOM version");
+
+    strings_ = load_u32(data_.data() + 12);
+    deps_ = load_u32(data_.data() + 16);
+    cves_ = load_u32(data_.data() + 20);
+    lists_ = load_u32(data_.data() + 24);
+    const std::uint64_t blob_size = load_u32(data_.data() + 28);
+
+    // Section offsets in 64 bit, so hostile counts cannot wrap around
+    std::uint64_t pos = PREAMBLE;
+    head_ = pos;
+    pos += HEADER_FIELDS * 4;
+    index_ = pos;
+    pos += std::uint64_t(strings_) * 8;
+    dep_ = pos;
+    pos += std::uint64_t(deps_) * DEP_WORDS * 4;
+    cve_ = pos;
+    pos += std::uint64_t(cves_) * CVE_SIZE;
+    list_ = pos;
+    pos += std::uint64_t(lists_) * 8;
+    blob_ = pos;
+    if (pos + blob_size != data_.size())
+      return fail("truncated or oversized file");
+
+    for (std::uint32_t s = 0; s < strings_; ++s) {
+      std::uint64_t off = word(index_ + s * 8ull);
+      std::uint64_t len = word(index_ + s * 8ull + 4);
+      if (off + len > blob_size)
+        return fail("string outside of the blob");
+    }
+    for (std::size_t f = 0; f < HEADER_FIELDS; ++f)
+      if (word(head_ + f * 4) >= strings_)
+        return fail("invalid string id");
+    for (std::uint32_t d = 0; d < deps_; ++d) {
+      for (std::size_t f = 0; f < 4; ++f)
+        if (dep_word(d, f) >= strings_)
+          return fail("invalid string id");
+      for (std::size_t f = 4; f < 10; f += 2)
+        if (std::uint64_t(dep_word(d, f)) + dep_word(d, f + 1) > lists_)
+          return fail("invalid list range");
+      if (std::uint64_t(dep_word(d, 10)) + dep_word(d, 11) > cves_)
+        return fail("invalid CVE range");
+    }
+    for (std::uint32_t c = 0; c < cves_; ++c)
+      for (std::size_t f = 0; f < 5; ++f)
+        if (word(cve_ + c * CVE_SIZE + f * 4) >= strings_)
+          return fail("invalid string id");
+    for (std::uint32_t l = 0; l < lists_; ++l) {
+      std::uint32_t dir = word(list_ + l * 8ull);
+      if ((dir != NO_STRING && dir >= strings_) ||
+          word(list_ + l * 8ull + 4) >= strings_)
+        return fail("invalid string id");
+    }
+
+    ok_ = true;
+    return true;
+  }
+
+  bool is_open() const { return ok_; }
+
+  /// Number of dependencies.
+  std::size_t size() const { return deps_; }
+
+  std::string_view name(std::size_t dep) const { return str(dep_word(dep, 0)); }
+  std::string_view version(std::size_t dep) const {
+    return str(dep_word(dep, 1));
+  }
+  std::string_view type(std::size_t dep) const { return str(dep_word(dep, 2)); }
+  std::string_view source(std::size_t dep) const {
+    return str(dep_word(dep, 3));
+  }
+
+  std::size_t header_count(std::size_t dep) const { return dep_word(dep, 5); }
+  ItemView header(std::size_t dep, std::size_t k) const {
+    return list_item(dep_word(dep, 4) + k);
+  }
+  std::size_t library_count(std::size_t dep) const { return dep_word(dep, 7); }
+  ItemView library(std::size_t dep, std::size_t k) const {
+    return list_item(dep_word(dep, 6) + k);
+  }
+  std::size_t license_count(std::size_t dep) const { return dep_word(dep, 9); }
+  ItemView license(std::size_t dep, std::size_t k) const {
+    return list_item(dep_word(dep, 8) + k);
+  }
+
+  std::size_t cve_count(std::size_t dep) const { return dep_word(dep, 11); }
+  CveView cve(std::size_t dep, std::size_t k) const {
+    using namespace sbom_detail;
+    std::uint64_t at = cve_ + (std::uint64_t(dep_word(dep, 10)) + k) * CVE_SIZE;
+    CveView v;
+    v.id = str(word(at));
+    v.summary = str(word(at + 4));
+    v.severity = str(word(at + 8));
+    v.fixed_version = str(word(at + 12));
+    v.suppression_reason = str(word(at + 16));
+    v.suppressed = (word(at + 20) & FLAG_SUPPRESSED) != 0;
+    std::uint64_t bits = load_u64(data_.data() + at + 24);
+    std::memcpy(&v.score, &bits, sizeof(bits));
+    return v;
+  }
+
+  /**
+   * @brief Materializes the report header.
+   */
+  ReportHeader report_header() const {
+    ReportHeader h;
+    std::string *fields[] = {&h.schema_version, &h.scan_date,
+                             &h.tool_name,      &h.tool_version,
+                             &h.tool_description, &h.tool_homepage,
+                             &h.tool_author,    &h.project_name,
+                             &h.workspace_root};
+    for (std::size_t f = 0; f < sbom_detail::HEADER_FIELDS; ++f)
+      *fields[f] = str(word(head_ + f * 4));
+    return h;
+  }
+
+  /**
+   * @brief Materializes one dependency.
+   *
+   * @param dep The dependency index.
+   * @param with_paths False skips the header and library lists.
+   */
+  Dependency dependency(std::size_t dep, bool with_paths = true) const {
+    Dependency d;
+    d.name = name(dep);
+    d.version = version(dep);
+    d.type = type(dep);
+    d.source = source(dep);
+    for (std::size_t k = 0; with_paths && k < header_count(dep); ++k)
+      d.headers.push_back(header(dep, k).str());
+    for (std::size_t k = 0; with_paths && k < library_count(dep); ++k)
+      d.libraries.push_back(library(dep, k).str());
+    for (std::size_t k = 0; k < license_count(dep); ++k)
+      d.licenses.push_back(license(dep, k).str());
+    for (std::size_t k = 0; k < cve_count(dep); ++k) {
+      CveView v = cve(dep, k);
+      CVE c;
+      c.id = v.id;
+      c.summary = v.summary;
+      c.severity = v.severity;
+      c.score = v.score;
+      c.fixed_version = v.fixed_version;
+      c.suppressed = v.suppressed;
+      c.suppression_reason = v.suppression_reason;
+      d.cves.push_back(std::move(c));
+    }
+    return d;
+  }
+
+  /**
+   * @brief Materializes all dependencies (in the stored order).
+   *
+   * @param with_paths False skips the header and library lists.
+   */
+  std::vector<Dependency> dependencies(bool with_paths = true) const {
+    std::vector<Dependency> out;
+    out.reserve(deps_);
+    for (std::size_t d = 0; d < deps_; ++d)
+      out.push_back(dependency(d, with_paths));
+    return out;
+  }
+
+private:
+  std::uint32_t word(std::uint64_t at) const {
+    return sbom_detail::load_u32(data_.data() + at);
+  }
+  std::uint32_t dep_word(std::size_t dep, std::size_t field) const {
+    return word(dep_ + (std::uint64_t(dep) * sbom_detail::DEP_WORDS + field) * 4);
+  }
+  std::string_view str(std::uint32_t id) const {
+    std::uint64_t at = index_ + std::uint64_t(id) * 8;
+    return data_.substr(blob_ + word(at), word(at + 4));
+  }
+  ItemView list_item(std::uint64_t pos) const {
+    ItemView v;
+    std::uint32_t dir = word(list_ + pos * 8);
+    v.has_dir = dir != sbom_detail::NO_STRING;
+    if (v.has_dir)
+      v.dir = str(dir);
+    v.leaf = str(word(list_ + pos * 8 + 4));
+    return v;
+  }
+
+  MappedFile file_;
+  std::string_view data_;
+  bool ok_ = false;
+  std::uint32_t strings_ = 0, deps_ = 0, cves_ = 0, lists_ = 0;
+  std::uint64_t head_ = 0, index_ = 0, dep_ = 0, cve_ = 0, list_ = 0,
+                blob_ = 0;
+};
+
+} // namespace depdiscover
@@ -7,8 +7,8 @@
  *
  * @file check_gh-update.hpp
  * @brief GitHub release checker utility with semantic versioning support.
- * @version 1.0.0
- * @date 2026-02-22
+ * @version 1.1.0
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -22,7 +22,7 @@
 #include <regex>
 #include <stdexcept>
 #include <future>
-#include <curl/curl.h>
+#include "http_client.hpp"
 #include <nlohmann/json.hpp>
 
 /**
@@ -68,45 +68,18 @@ struct SemVer {
 };
 
 /**
- * @brief CURL write callback for HTTP response buffering.
- *
- * @param contents Pointer to received data.
- * @param size Size of each element.
- * @param nmemb Number of elements.
- * @param userp User pointer (std::string* to accumulate data).
- * @return Total bytes written.
- */
-static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
-    size_t total = size * nmemb;
-    static_cast<std::string*>(userp)->append((char*)contents, total);
-    return total;
-}
-
-/**
- * @brief Performs an HTTP GET request using libcurl.
+ * @brief Performs an HTTP GET request via the shared depdiscover HTTP client.
  *
  * @param url The URL to request.
  * @return Response body as std::string.
  * @throws std::runtime_error on network error.
  */
 inline std::string http_get(std::string_view url) {
-    CURL* curl = curl_easy_init();
-    if (!curl) throw std::runtime_error("curl init failed");
-
-    std::string buffer;
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.data());
-    curl_easy_setopt(curl, CURLOPT_USERAGENT, "C++23-gh-update-checker");
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
-
-    CURLcode res = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-
-    if (res != CURLE_OK)
+    auto resp = depdiscover::HttpClient::instance().get(std::string(url));
+    if (!resp.completed())
         throw std::runtime_error("HTTP request failed");
 
-    return buffer;
+    return resp.body;
 }
 
 /**
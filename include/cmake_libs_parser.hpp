@@ -7,8 +7,8 @@
  *
  * @file cmake_libs_parser.hpp
  * @brief Parses CMake libs.txt and fetches metadata from build directories.
- * @version 1.0.0
- * @date 2026-02-18
+ * @version 1.2.0
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -16,56 +16,28 @@
  * @license MIT License
  */
 #pragma once
+#include "file_reader.hpp"
 #include "types.hpp"
+#include "version_sniffer.hpp"
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <map>
-#include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace depdiscover {
 
 namespace fs = std::filesystem;
 
-/**
- * @brief Reads a version string from a header file using a regex pattern.
- *
- * @param path The path to the header file.
- * @param regex_pattern The regex pattern to extract version information.
- * @return std::string The extracted version string, or empty if not found.
- */
-inline std::string read_header_version(const fs::path &path,
-                                       const std::string &regex_pattern) {
-  std::ifstream f(path);
-  if (!f)
-    return "";
-
-  std::string content((std::istreambuf_iterator<char>(f)),
-                      std::istreambuf_iterator<char>());
-  std::regex re(regex_pattern);
-  std::smatch m;
-
-  if (std::regex_search(content, m, re)) {
-    // Case 1: Major.Minor.Patch (3 groups)
-    if (m.size() >= 4) {
-      return m[1].str() + "." + m[2].str() + "." + m[3].str();
-    }
-    // Case 2: Single integer (e.g., FMT_VERSION 100100)
-    if (m.size() == 2) {
-      return m[1].str(); // Return raw, caller handles formatting
-    }
-  }
-  return "";
-}
-
 /**
  * @brief Fetches metadata (version, license) for a CMake target from build
  * directories.
  *
- * Searches in `_deps` (FetchContent) and `vcpkg_installed` directories.
+ * Searches in `_deps` (FetchContent, see version_sniffer.hpp) and
+ * `vcpkg_installed` directories.
  *
  * @param target_name The name of the CMake target.
  * @param build_dir The CMake build directory.
@@ -85,47 +57,15 @@ fetch_cmake_metadata(const std::string &target_name,
   }
   std::transform(clean.begin(), clean.end(), clean.begin(), ::tolower);
 
-  // Locations where CMake stores dependencies
-  std::vector<fs::path> search_dirs = {
-      build_dir / "_deps",
-      build_dir / "vcpkg_installed" / "x64-linux" / "share" // Vcpkg Linux Standard
-  };
-
-  // 1. Check FetchContent (_deps)
+  // 1. Check FetchContent (_deps/<name>-src)
+  std::error_code ec;
   fs::path deps_dir = build_dir / "_deps";
-  if (fs::exists(deps_dir)) {
-    // nlohmann_json special case
-    if (clean.find("nlohmann") != std::string::npos ||
-        clean.find("json") != std::string::npos) {
-      // _deps/json-src/include/nlohmann/json.hpp
-      fs::path header =
-          deps_dir / "json-src" / "include" / "nlohmann" / "json.hpp";
-      if (fs::exists(header)) {
-        std::string v = read_header_version(
-            header,
-            R"(#define\s+NLOHMANN_JSON_VERSION_MAJOR\s+(\d+).*?#define\s+NLOHMANN_JSON_VERSION_MINOR\s+(\d+).*?#define\s+NLOHMANN_JSON_VERSION_PATCH\s+(\d+))");
-        if (!v.empty())
-          return {v, "MIT"};
-      }
-    }
-    // fmt special case
-    if (clean == "fmt") {
-      // _deps/fmt-src/include/fmt/core.h
-      fs::path header = deps_dir / "fmt-src" / "include" / "fmt" / "core.h";
-      if (fs::exists(header)) {
-        std::string v_raw =
-            read_header_version(header, R"(#define\s+FMT_VERSION\s+(\d+))");
-        if (!v_raw.empty()) {
-          try {
-            int v_int = std::stoi(v_raw);
-            std::string v_fmt = std::to_string(v_int / 10000) + "." +
-                                std::to_string((v_int % 10000) / 100) + "." +
-                                std::to_string(v_int % 100);
-            return {v_fmt, "MIT"};
-          } catch (...) {
-          }
-        }
-      }
+  if (fs::is_directory(deps_dir, ec)) {
+    fs::path src = find_fetchcontent_source(deps_dir, target_name);
+    if (!src.empty()) {
+      auto [version, license] = sniff_source_tree_version(src, target_name);
+      if (!version.empty())
+        return {version, license.empty() ? "unknown" : license};
     }
   }
 
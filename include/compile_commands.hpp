@@ -7,8 +7,8 @@
  *
  * @file compile_commands.hpp
  * @brief Parses compile_commands.json files to extract build information.
- * @version 1.0.0
- * @date 2026-02-18
+ * @version 1.1.0
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -16,13 +16,24 @@
  * @license MIT License
  */
 #pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "profiler.hpp"
+
 namespace depdiscover {
 
 /**
@@ -32,61 +43,294 @@ struct CompileCommand {
   std::string file;      ///< The source file being compiled.
   std::string command;   ///< The full compilation command.
   std::string directory; ///< The working directory for the compilation.
+  /// The `arguments` form as literal tokens (`command` is empty then).
+  std::vector<std::string> arguments;
+};
+
+namespace compile_commands_detail {
+
+/**
+ * @brief SAX handler turning the top-level array into CompileCommand
+ * entries, one at a time.
+ *
+ * Only the `file`, `directory`, `command` and `arguments` members are kept;
+ * everything else is skipped without building a DOM.
+ */
+template <class Fn> class EntryHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+  explicit EntryHandler(Fn &fn) : fn_(fn) {}
+
+  bool null() override { return scalar(); }
+  bool boolean(bool) override { return scalar(); }
+  bool number_integer(number_integer_t) override { return scalar(); }
+  bool number_unsigned(number_unsigned_t) override { return scalar(); }
+  bool number_float(number_float_t, const string_t &) override {
+    return scalar();
+  }
+  bool binary(binary_t &) override { return scalar(); }
+
+  bool string(string_t &val) override {
+    if (depth_ == 0)
+      return not_an_array();
+    if (depth_ == 2) {
+      switch (member_) {
+      case Member::File:
+        entry_.file = std::move(val);
+        has_file_ = true;
+        break;
+      case Member::Directory:
+        entry_.directory = std::move(val);
+        break;
+      case Member::Command:
+        entry_.command = std::move(val);
+        has_command_ = true;
+        break;
+      default:
+        break;
+      }
+    } else if (depth_ == 3 && in_arguments_) {
+      entry_.arguments.push_back(std::move(val));
+    }
+    return true;
+  }
+
+  bool start_object(std::size_t) override {
+    if (depth_ == 0)
+      return not_an_array();
+    if (++depth_ == 2) {
+      entry_ = CompileCommand{};
+      has_file_ = has_command_ = has_arguments_ = false;
+    }
+    return true;
+  }
+
+  bool key(string_t &val) override {
+    if (depth_ != 2)
+      return true;
+    if (val == "file")
+      member_ = Member::File;
+    else if (val == "directory")
+      member_ = Member::Directory;
+    else if (val == "command")
+      member_ = Member::Command;
+    else if (val == "arguments") {
+      member_ = Member::Arguments;
+      has_arguments_ = true;
+    } else
+      member_ = Member::Other;
+    return true;
+  }
+
+  bool end_object() override {
+    if (depth_-- != 2)
+      return true;
+    // Entries need a file and a command; `command` wins over `arguments`
+    if (!has_file_ || (!has_command_ && !has_arguments_))
+      return true;
+    if (has_command_)
+      entry_.arguments.clear();
+    ++count_;
+    return fn_(std::move(entry_));
+  }
+
+  bool start_array(std::size_t) override {
+    if (++depth_ == 3 && member_ == Member::Arguments)
+      in_arguments_ = true;
+    return true;
+  }
+
+  bool end_array() override {
+    if (depth_-- == 3)
+      in_arguments_ = false;
+    return true;
+  }
+
+  bool parse_error(std::size_t, const std::string &,
+                   const nlohmann::detail::exception &ex) override {
+    error_ = std::string("JSON parse error: ") + ex.what();
+    return false;
+  }
+
+  /// Error message if parsing stopped on an error (empty otherwise).
+  const std::string &error() const { return error_; }
+  /// Number of entries handed to the callback.
+  std::size_t count() const { return count_; }
+
+private:
+  enum class Member { Other, File, Directory, Command, Arguments };
+
+  bool scalar() { return depth_ == 0 ? not_an_array() : true; }
+  bool not_an_array() {
+    error_ = "compile_commands.json: expected top-level array";
+    return false;
+  }
+
+  Fn &fn_;
+  int depth_ = 0;
+  Member member_ = Member::Other;
+  bool in_arguments_ = false;
+  bool has_file_ = false;
+  bool has_command_ = false;
+  bool has_arguments_ = false;
+  CompileCommand entry_;
+  std::string error_;
+  std::size_t count_ = 0;
+};
+
+} // namespace compile_commands_detail
+
+/**
+ * @brief Streams the entries of a compile_commands.json document.
+ *
+ * The document is parsed with nlohmann's SAX interface, so memory does not
+ * grow with the file size: each entry is handed to `fn` as soon as its
+ * object is complete.
+ *
+ * @param in The document.
+ * @param fn Callable `bool(CompileCommand &&)`; returning false stops.
+ * @return std::size_t Number of entries handed to `fn`.
+ * @throws std::runtime_error If the document is not a JSON array.
+ */
+template <class Fn>
+std::size_t for_each_compile_command(std::istream &in, Fn &&fn) {
+  compile_commands_detail::EntryHandler<std::remove_reference_t<Fn>> handler(fn);
+  nlohmann::json::sax_parse(in, &handler);
+  if (!handler.error().empty())
+    throw std::runtime_error(handler.error());
+  return handler.count();
+}
+
+/**
+ * @brief Bounded queue of compile commands filled by a parser thread.
+ *
+ * The parser stops when `capacity` entries are waiting, so a scan holds at
+ * most `capacity` entries plus the batch in work, whatever the size of the
+ * database.
+ */
+class CompileCommandStream {
+public:
+  /**
+   * @brief Opens the file and starts parsing.
+   *
+   * @param path The path to the compile_commands.json file.
+   * @param capacity Maximum number of queued entries.
+   * @throws std::runtime_error If the file cannot be opened.
+   */
+  CompileCommandStream(const std::string &path, std::size_t capacity)
+      : in_(path, std::ios::binary), capacity_(capacity == 0 ? 1 : capacity) {
+    if (!in_)
+      throw std::runtime_error("compile_commands.json not found at: " + path);
+    parser_ = std::thread([this] { parse(); });
+  }
+
+  ~CompileCommandStream() {
+    {
+      std::lock_guard lock(mutex_);
+      cancelled_ = true;
+    }
+    not_full_.notify_all();
+    parser_.join();
+  }
+
+  CompileCommandStream(const CompileCommandStream &) = delete;
+  CompileCommandStream &operator=(const CompileCommandStream &) = delete;
+
+  /**
+   * @brief Takes up to `max` entries, waiting until that many are queued
+   * (or the parser is done).
+   *
+   * @param out Receives the entries (cleared first).
+   * @param max Maximum batch size.
+   * @return true If entries were returned; false at the end.
+   * @throws std::runtime_error If the document is malformed.
+   */
+  bool next_batch(std::vector<CompileCommand> &out, std::size_t max) {
+    out.clear();
+    std::unique_lock lock(mutex_);
+    not_empty_.wait(lock, [&] {
+      return queue_.size() >= std::min(max, capacity_) || done_;
+    });
+    while (!queue_.empty() && out.size() < max) {
+      out.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    lock.unlock();
+    not_full_.notify_one();
+    if (out.empty() && error_)
+      std::rethrow_exception(error_);
+    return !out.empty();
+  }
+
+  /**
+   * @brief Number of entries parsed so far (all of them after the end).
+   */
+  std::size_t count() const {
+    std::lock_guard lock(mutex_);
+    return count_;
+  }
+
+private:
+  void parse() {
+    ProfileScope stage("compile_commands", ProfileKind::Stage);
+    try {
+      for_each_compile_command(in_, [this](CompileCommand &&entry) {
+        std::unique_lock lock(mutex_);
+        not_full_.wait(lock,
+                       [&] { return queue_.size() < capacity_ || cancelled_; });
+        if (cancelled_)
+          return false;
+        queue_.push_back(std::move(entry));
+        ++count_;
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+      });
+    } catch (...) {
+      std::lock_guard lock(mutex_);
+      error_ = std::current_exception();
+    }
+    {
+      std::lock_guard lock(mutex_);
+      done_ = true;
+      stage.items(count_);
+    }
+    not_empty_.notify_all();
+  }
+
+  std::ifstream in_;
+  const std::size_t capacity_;
+  std::thread parser_;
+  mutable std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<CompileCommand> queue_;
+  std::size_t count_ = 0;
+  bool done_ = false;
+  bool cancelled_ = false;
+  std::exception_ptr error_;
 };
 
 /**
  * @brief Loads and parses a compile_commands.json file.
  *
+ * Collects all entries; scans stream them through CompileCommandStream
+ * instead.
+ *
  * @param path The path to the compile_commands.json file.
  * @return std::vector<CompileCommand> A list of compile commands.
  * @throws std::runtime_error If the file cannot be opened or parsed.
  */
 inline std::vector<CompileCommand>
 load_compile_commands(const std::string &path) {
-  std::ifstream f(path);
+  std::ifstream f(path, std::ios::binary);
   if (!f)
     throw std::runtime_error("compile_commands.json not found at: " + path);
 
-  nlohmann::json doc;
-  try {
-    f >> doc;
-  } catch (const nlohmann::json::parse_error &e) {
-    throw std::runtime_error(std::string("JSON parse error: ") + e.what());
-  }
-
-  if (!doc.is_array())
-    throw std::runtime_error("compile_commands.json: expected top-level array");
-
   std::vector<CompileCommand> out;
-  out.reserve(doc.size());
-
-  for (const auto &entry : doc) {
-    std::string file;
-    std::string command;
-    std::string directory;
-
-    if (entry.contains("file"))
-      file = entry["file"].get<std::string>();
-    else
-      continue;
-
-    if (entry.contains("directory"))
-      directory = entry["directory"].get<std::string>();
-
-    if (entry.contains("command")) {
-      command = entry["command"].get<std::string>();
-    } else if (entry.contains("arguments")) {
-      const auto &args = entry["arguments"];
-      if (args.is_array()) {
-        for (const auto &arg : args)
-          command += arg.get<std::string>() + " ";
-      }
-    } else {
-      continue;
-    }
-
-    out.push_back({file, command, directory});
-  }
+  for_each_compile_command(f, [&](CompileCommand &&entry) {
+    out.push_back(std::move(entry));
+    return true;
+  });
 
   std::cerr << "[Info] Loaded " << out.size() << " compile commands.\n";
   return out;
@@ -0,0 +1,396 @@
+/**
+ * SPDX-FileComment: Persistent CVE Response Cache
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file cve_cache.hpp
+ * @brief Append-only on-disk cache for OSV results with TTL and offline mode.
+ * @version 1.4.1
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "cve_resolver.hpp"
+#include "profiler.hpp"
+#include "scan_log.hpp"
+#include "types.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace depdiscover {
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+/**
+ * @brief Returns the default cache directory (~/.cache/depdiscover).
+ *
+ * Honours `XDG_CACHE_HOME`; falls back to `.depdiscover-cache` in the
+ * current directory if no home directory is known.
+ *
+ * @return fs::path The cache directory.
+ */
+inline fs::path default_cve_cache_dir() {
+  if (const char *xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+    return fs::path(xdg) / "depdiscover";
+  if (const char *home = std::getenv("HOME"); home && *home)
+    return fs::path(home) / ".cache" / "depdiscover";
+  return fs::path(".depdiscover-cache");
+}
+
+namespace cve_cache_detail {
+
+/**
+ * @brief Exclusive `flock()` on a lock file, released on destruction.
+ */
+class FileLock {
+public:
+  explicit FileLock(const fs::path &path) {
+#if defined(__unix__) || defined(__APPLE__)
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ >= 0)
+      ::flock(fd_, LOCK_EX);
+#else
+    (void)path;
+#endif
+  }
+
+  FileLock(const FileLock &) = delete;
+  FileLock &operator=(const FileLock &) = delete;
+
+  ~FileLock() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (fd_ >= 0) {
+      ::flock(fd_, LOCK_UN);
+      ::close(fd_);
+    }
+#endif
+  }
+
+  /// True if the lock is held.
+  bool locked() const { return fd_ >= 0; }
+
+private:
+  int fd_ = -1;
+};
+
+} // namespace cve_cache_detail
+
+/**
+ * @brief Persistent cache of parsed OSV results keyed by
+ * (ecosystem, package, version).
+ *
+ * The cache is a JSON Lines file (`cve-cache.jsonl`) that is only ever
+ * appended to; the last line of a key wins. Appends and compactions hold
+ * an `flock()` on `cve-cache.lock`, so parallel CI jobs on the same runner
+ * can share one cache directory: appenders open the cache file only under
+ * the lock and never write to a file a compaction has replaced. The file
+ * is compacted once superseded lines dominate it.
+ *
+ * Without a directory the cache only lives in memory; `--batch` uses that
+ * to share OSV results between the projects of one run.
+ */
+class CveCache {
+public:
+  /**
+   * @brief Opens (and loads) the cache in the given directory.
+   *
+   * @param dir The cache directory (created if missing; empty: in memory).
+   * @param ttl Time-to-live of an entry.
+   */
+  CveCache(const fs::path &dir, std::chrono::seconds ttl)
+      : file_(dir.empty() ? fs::path() : dir / "cve-cache.jsonl"),
+        lock_file_(dir.empty() ? fs::path() : dir / "cve-cache.lock"),
+        ttl_(ttl) {
+    if (file_.empty())
+      return;
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    load();
+  }
+
+  /**
+   * @brief Builds the cache key of a query.
+   *
+   * @param ecosystem The OSV ecosystem.
+   * @param name The dependency name (mapped via osv_package_name).
+   * @param version The cleaned version.
+   * @return std::string The key.
+   */
+  static std::string make_key(const std::string &ecosystem,
+                              const std::string &name,
+                              const std::string &version) {
+    return ecosystem + '\t' + osv_package_name(name) + '\t' + version;
+  }
+
+  /**
+   * @brief Looks up a cached result.
+   *
+   * @param key The cache key (see make_key()).
+   * @param allow_stale Also return entries older than the TTL.
+   * @return std::optional<std::vector<CVE>> The cached CVEs, if present.
+   */
+  std::optional<std::vector<CVE>> lookup(const std::string &key,
+                                         bool allow_stale = false) {
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() ||
+        (!allow_stale && now_seconds() - it->second.timestamp > ttl_.count())) {
+      misses_++;
+      return std::nullopt;
+    }
+    hits_++;
+    return it->second.cves;
+  }
+
+  /**
+   * @brief Stores results and appends them to the cache file.
+   *
+   * @param items Pairs of (key, CVE list). Only definitive results should be
+   * stored (no CHECK-ERROR / NOT-CHECKED).
+   */
+  void store(const std::vector<std::pair<std::string, std::vector<CVE>>> &items) {
+    if (items.empty())
+      return;
+
+    std::lock_guard lock(mutex_);
+    const std::int64_t ts = now_seconds();
+    std::string lines;
+    for (const auto &[key, cves] : items) {
+      json line;
+      line["k"] = key;
+      line["t"] = ts;
+      line["cves"] = cves;
+      lines += line.dump() + "\n";
+      entries_[key] = {ts, cves};
+      line_count_++;
+    }
+    if (file_.empty())
+      return;
+    append(lines);
+
+    if (line_count_ > 1000 && line_count_ > 2 * entries_.size())
+      compact();
+  }
+
+  std::size_t hits() const { return hits_; }     ///< Number of cache hits.
+  std::size_t misses() const { return misses_; } ///< Number of cache misses.
+
+private:
+  struct Entry {
+    std::int64_t timestamp = 0;
+    std::vector<CVE> cves;
+  };
+
+  static std::int64_t now_seconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+  }
+
+  /**
+   * @brief Reads all lines; later lines override earlier ones.
+   */
+  void load() {
+    std::ifstream f(file_);
+    if (!f)
+      return;
+    std::string line;
+    while (std::getline(f, line)) {
+      if (line.empty())
+        continue;
+      try {
+        auto j = json::parse(line);
+        auto cves = j.at("cves").get<std::vector<CVE>>();
+        // Scores are derived data: entries written by older versions
+        // carry estimated vector scores
+        for (auto &cve : cves)
+          cve.score = extract_cvss_score(cve.severity);
+        entries_[j.at("k").get<std::string>()] = {
+            j.at("t").get<std::int64_t>(), std::move(cves)};
+        line_count_++;
+      } catch (const std::exception &) {
+        // Ignore torn or corrupt lines (e.g., from a killed job)
+      }
+    }
+  }
+
+  /**
+   * @brief Appends pre-serialized lines atomically to the cache file.
+   */
+  void append(const std::string &lines) {
+    cve_cache_detail::FileLock lock(lock_file_);
+#if defined(__unix__) || defined(__APPLE__)
+    // Opened under the lock: a compaction may have replaced the file
+    int fd = ::open(file_.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) {
+      scan_log() << "[Warning] Could not write CVE cache: " << file_ << "\n";
+      return;
+    }
+    const char *data = lines.data();
+    std::size_t left = lines.size();
+    while (left > 0) {
+      ssize_t n = ::write(fd, data, left);
+      if (n <= 0)
+        break;
+      data += n;
+      left -= static_cast<std::size_t>(n);
+    }
+    ::close(fd);
+#else
+    std::ofstream out(file_, std::ios::app | std::ios::binary);
+    if (!out) {
+      scan_log() << "[Warning] Could not write CVE cache: " << file_ << "\n";
+      return;
+    }
+    out << lines;
+#endif
+  }
+
+  /**
+   * @brief Rewrites the cache file with one line per live key.
+   */
+  void compact() {
+    // Hold the lock while merging and renaming, so appends of other jobs
+    // land either in the merged lines or in the new file
+    cve_cache_detail::FileLock lock(lock_file_);
+#if defined(__unix__) || defined(__APPLE__)
+    if (!lock.locked())
+      return;
+    line_count_ = 0;
+    load();
+#endif
+    fs::path tmp = file_;
+    tmp += ".tmp";
+    {
+      std::ofstream out(tmp, std::ios::trunc | std::ios::binary);
+      if (!out)
+        return;
+      for (const auto &[key, entry] : entries_) {
+        json line;
+        line["k"] = key;
+        line["t"] = entry.timestamp;
+        line["cves"] = entry.cves;
+        out << line.dump() << "\n";
+      }
+    }
+    std::error_code ec;
+    fs::rename(tmp, file_, ec);
+    if (!ec)
+      line_count_ = entries_.size();
+  }
+
+  fs::path file_;
+  fs::path lock_file_;
+  std::chrono::seconds ttl_;
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::size_t line_count_ = 0;
+  std::size_t hits_ = 0;
+  std::size_t misses_ = 0;
+};
+
+/**
+ * @brief Checks whether a CVE result list is definitive (cacheable).
+ *
+ * @param cves The CVE list returned by the resolver.
+ * @return true If it contains no CHECK-ERROR / NOT-CHECKED marker.
+ */
+inline bool is_cacheable_result(const std::vector<CVE> &cves) {
+  for (const auto &c : cves)
+    if (c.id == "CHECK-ERROR" || c.id == "NOT-CHECKED")
+      return false;
+  return !cves.empty();
+}
+
+/**
+ * @brief Resolves CVEs using the cache first and OSV for the misses.
+ *
+ * @param queries The (name, version) tuples to check.
+ * @param ecosystem The OSV ecosystem.
+ * @param cache The cache (nullptr disables caching).
+ * @param offline If true, never query OSV; misses become NOT-CHECKED.
+ * @return std::vector<std::vector<CVE>> One result list per query.
+ */
+inline std::vector<std::vector<CVE>>
+query_cves_cached(const std::vector<CveQuery> &queries,
+                  const std::string &ecosystem, CveCache *cache,
+                  bool offline) {
+  if (!cache && !offline)
+    return query_cves_batch(queries, ecosystem);
+
+  std::vector<std::vector<CVE>> results(queries.size());
+  std::vector<CveQuery> misses;
+  std::vector<std::size_t> miss_index;
+
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    const auto &q = queries[i];
+    if (q.name.empty() || q.version.empty() || q.version == "unknown" ||
+        q.version == "latest") {
+      results[i].push_back(make_not_checked_cve());
+      continue;
+    }
+    if (cache) {
+      auto key = CveCache::make_key(ecosystem, q.name, q.version);
+      if (auto hit = cache->lookup(key, offline)) {
+        Profiler::instance().count("cve_cache.hits");
+        results[i] = std::move(*hit);
+        continue;
+      }
+      Profiler::instance().count("cve_cache.misses");
+    }
+    if (offline) {
+      results[i].push_back({"NOT-CHECKED",
+                            "Offline mode: no cached OSV result available",
+                            "UNKNOWN", 0.0, "", false, ""});
+      continue;
+    }
+    misses.push_back(q);
+    miss_index.push_back(i);
+  }
+
+  if (cache)
+    scan_log() << "   [CVE Cache] " << cache->hits() << " hits, "
+              << misses.size() << " to query\n";
+
+  if (misses.empty())
+    return results;
+
+  auto fetched = query_cves_batch(misses, ecosystem);
+  std::vector<std::pair<std::string, std::vector<CVE>>> to_store;
+  for (std::size_t m = 0; m < misses.size(); ++m) {
+    if (cache && is_cacheable_result(fetched[m]))
+      to_store.emplace_back(
+          CveCache::make_key(ecosystem, misses[m].name, misses[m].version),
+          fetched[m]);
+    results[miss_index[m]] = std::move(fetched[m]);
+  }
+  if (cache)
+    cache->store(to_store);
+
+  return results;
+}
+
+} // namespace depdiscover
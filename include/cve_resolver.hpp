@@ -7,8 +7,8 @@
  *
  * @file cve_resolver.hpp
  * @brief Queries OSV.dev for CVEs associated with packages.
- * @version 1.3.1
- * @date 2026-02-18
+ * @version 1.6.1
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -16,18 +16,23 @@
  * @license MIT License
  */
 #pragma once
+#include "http_client.hpp"
+#include "scan_log.hpp"
 #include "types.hpp"
 #include <array>
 #include <chrono>
+#include <cstdint>
 #include <cstdio>
-#include <curl/curl.h>
+#include <cstdlib>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <string>
@@ -38,16 +43,6 @@ namespace depdiscover {
 using json = nlohmann::json;
 namespace fs = std::filesystem;
 
-/**
- * @brief CURL write callback for HTTP response buffering.
- */
-static size_t curl_write_callback(void *contents, size_t size, size_t nmemb,
-                                  void *userp) {
-  size_t total = size * nmemb;
-  static_cast<std::string *>(userp)->append((char *)contents, total);
-  return total;
-}
-
 /**
  * @brief Returns the current date as a string in YYYY-MM-DD format.
  *
@@ -62,7 +57,21 @@ inline std::string get_current_date() {
 }
 
 /**
- * @brief Performs a secure curl POST request using libcurl.
+ * @brief Converts a shared-client response into the legacy string result.
+ *
+ * @param resp The HTTP response.
+ * @return std::string The response body, or empty on transport failure.
+ */
+inline std::string response_body_or_empty(const HttpResponse &resp) {
+  if (!resp.completed()) {
+    scan_log() << "[Error] HTTP request failed: " << resp.error << "\n";
+    return "";
+  }
+  return resp.body;
+}
+
+/**
+ * @brief Performs a secure POST request via the shared HTTP client.
  *
  * @param url The target URL.
  * @param json_payload The JSON payload to send.
@@ -70,35 +79,151 @@ inline std::string get_current_date() {
  */
 inline std::string perform_curl_post(const std::string &url,
                                      const std::string &json_payload) {
-  CURL *curl = curl_easy_init();
-  if (!curl) {
-    std::cerr << "[Error] curl_easy_init failed.\n";
-    return "";
+  return response_body_or_empty(
+      HttpClient::instance().post_json(url, json_payload));
+}
+
+/**
+ * @brief Performs a GET request via the shared HTTP client.
+ *
+ * @param url The target URL.
+ * @return std::string The response from the server (empty on failure).
+ */
+inline std::string perform_curl_get(const std::string &url) {
+  return response_body_or_empty(HttpClient::instance().get(url));
+}
+
+/**
+ * @brief Returns the OSV API base URL.
+ *
+ * Can be overridden via the `DEPDISCOVER_OSV_URL` environment variable
+ * (e.g., for a self-hosted OSV mirror).
+ *
+ * @return std::string The base URL without trailing slash.
+ */
+inline std::string osv_api_base() {
+  const char *env = std::getenv("DEPDISCOVER_OSV_URL");
+  std::string base = (env && *env) ? env : "https://api.osv.dev/v1";
+  while (!base.empty() && base.back() == '/')
+    base.pop_back();
+  return base;
+}
+
+/**
+ * @brief Maps a dependency name to the package name used by OSV.
+ *
+ * @param name The dependency name.
+ * @return std::string The OSV package name.
+ */
+inline std::string osv_package_name(const std::string &name) {
+  return (name == "libcurl") ? "curl" : name;
+}
+
+/**
+ * @brief Creates the "NOT-CHECKED" sentinel result.
+ */
+inline CVE make_not_checked_cve() {
+  return {"NOT-CHECKED", "Version unknown or latest, cannot query OSV",
+          "UNKNOWN", 0.0, "", false, ""};
+}
+
+/**
+ * @brief Creates a "CHECK-ERROR" sentinel result.
+ *
+ * @param summary The error description.
+ */
+inline CVE make_check_error_cve(const std::string &summary) {
+  return {"CHECK-ERROR", summary, "UNKNOWN", 0.0, "", false, ""};
+}
+
+/**
+ * @brief Creates the "SAFE" sentinel result.
+ *
+ * @param ecosystem The OSV ecosystem that was checked.
+ */
+inline CVE make_safe_cve(const std::string &ecosystem) {
+  CVE safe_entry;
+  safe_entry.id = "SAFE";
+  safe_entry.severity = "NONE";
+  safe_entry.fixed_version = "";
+  safe_entry.summary = "No vulnerabilities found in ecosystem '" + ecosystem +
+                       "'. Checked on " + get_current_date();
+  safe_entry.suppressed = false;
+  safe_entry.suppression_reason = "";
+  return safe_entry;
+}
+
+/**
+ * @brief Converts a single OSV vulnerability object into a CVE.
+ *
+ * @param item A full OSV vulnerability record (as returned by /v1/query or
+ * /v1/vulns/{id}).
+ * @return CVE The extracted vulnerability.
+ */
+inline CVE parse_osv_vuln(const json &item) {
+  CVE cve;
+
+  // ID extraction (Try to get real CVE from aliases if it's a DEBIAN internal ID)
+  std::string id = item.value("id", "UNKNOWN");
+  if (id.starts_with("DEBIAN-CVE") && item.contains("aliases") &&
+      item["aliases"].is_array() && !item["aliases"].empty()) {
+    id = item["aliases"][0].get<std::string>();
   }
+  cve.id = id;
 
-  std::string response;
-  struct curl_slist *headers = nullptr;
-  headers = curl_slist_append(headers, "Content-Type: application/json");
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_payload.c_str());
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, curl_write_callback);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-  curl_easy_setopt(curl, CURLOPT_USERAGENT, "depdiscover/1.3.0");
-  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-
-  CURLcode res = curl_easy_perform(curl);
-  if (res != CURLE_OK) {
-    std::cerr << "[Error] curl_easy_perform failed: " << curl_easy_strerror(res)
-              << "\n";
-    response = "";
+  // Summary extraction (fallback to 'details' as Debian often lacks 'summary')
+  cve.summary = item.value("summary", "");
+  if (cve.summary.empty() && item.contains("details")) {
+    std::string details = item.value("details", "");
+    // Truncate long details for overview
+    if (details.length() > 150)
+      details = details.substr(0, 147) + "...";
+
+    // Remove newlines for cleaner JSON
+    std::replace(details.begin(), details.end(), '\n', ' ');
+    cve.summary = details;
   }
+  if (cve.summary.empty())
+    cve.summary = "No summary available";
 
-  curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
+  // Severity (Debian often lacks severity, use fallback). A v3 vector is
+  // preferred, as the score most advisories are published with.
+  if (item.contains("severity") && item["severity"].is_array() &&
+      !item["severity"].empty()) {
+    const json *chosen = &item["severity"][0];
+    for (const auto &entry : item["severity"])
+      if (entry.is_object() && entry.value("type", "") == "CVSS_V3") {
+        chosen = &entry;
+        break;
+      }
+    cve.severity = chosen->value("score", "UNKNOWN");
+    cve.score = extract_cvss_score(cve.severity);
+  } else {
+    cve.severity = "UNKNOWN";
+    cve.score = 0.0;
+  }
 
-  return response;
+  // Fixed Version
+  if (item.contains("affected") && item["affected"].is_array()) {
+    for (const auto &affected : item["affected"]) {
+      if (affected.contains("ranges")) {
+        for (const auto &range : affected["ranges"]) {
+          if (range.contains("events")) {
+            for (const auto &event : range["events"]) {
+              if (event.contains("fixed")) {
+                cve.fixed_version = event["fixed"];
+                break;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  cve.suppressed = false;
+  cve.suppression_reason = "";
+  return cve;
 }
 
 /**
@@ -116,30 +241,26 @@ inline std::vector<CVE> query_cves(const std::string &name,
 
   if (name.empty() || version.empty() || version == "unknown" ||
       version == "latest") {
-    results.push_back({"NOT-CHECKED",
-                       "Version unknown or latest, cannot query OSV", "UNKNOWN",
-                       0.0, "", false, ""});
+    results.push_back(make_not_checked_cve());
     return results;
   }
 
-  std::string actual_name = (name == "libcurl") ? "curl" : name;
+  std::string actual_name = osv_package_name(name);
 
   json query;
   query["package"] = {{"name", actual_name}, {"ecosystem", ecosystem}};
   query["version"] = version;
 
-  std::cerr << "   [CVE Check] " << actual_name << " @ " << version << " ("
+  scan_log() << "   [CVE Check] " << actual_name << " @ " << version << " ("
             << ecosystem << ") ... ";
 
   std::string json_str = query.dump();
-  std::string response =
-      perform_curl_post("https://api.osv.dev/v1/query", json_str);
+  std::string response = perform_curl_post(osv_api_base() + "/query", json_str);
 
   if (response.empty()) {
-    std::cerr << "Failed (Network Error)\n";
+    scan_log() << "Failed (Network Error)\n";
     results.push_back(
-        {"CHECK-ERROR", "Network request failed or no output from curl",
-         "UNKNOWN", 0.0, "", false, ""});
+        make_check_error_cve("Network request failed or no output from curl"));
     return results;
   }
 
@@ -148,94 +269,229 @@ inline std::vector<CVE> query_cves(const std::string &name,
 
     if (doc.contains("message") && doc.contains("code")) {
       std::string error_msg = doc["message"].get<std::string>();
-      std::cerr << "API Error (" << error_msg << ")\n";
-      results.push_back({"CHECK-ERROR", "OSV API Error: " + error_msg,
-                         "UNKNOWN", 0.0, "", false,
-                         ""});
+      scan_log() << "API Error (" << error_msg << ")\n";
+      results.push_back(make_check_error_cve("OSV API Error: " + error_msg));
       return results;
     }
 
     if (doc.contains("vulns") && doc["vulns"].is_array()) {
-      std::cerr << "FOUND " << doc["vulns"].size() << " Vulns!\n";
+      scan_log() << "FOUND " << doc["vulns"].size() << " Vulns!\n";
 
       for (const auto &item : doc["vulns"]) {
-        CVE cve;
+        results.push_back(parse_osv_vuln(item));
+      }
+    } else {
+      scan_log() << "OK (Safe)\n";
+      results.push_back(make_safe_cve(ecosystem));
+    }
+  } catch (const std::exception &e) {
+    scan_log() << "JSON Error: " << e.what() << "\n";
+    results.push_back(
+        make_check_error_cve(std::string("JSON parse error: ") + e.what()));
+  }
 
-        // ID extraction (Try to get real CVE from aliases if it's a DEBIAN internal ID)
-        std::string id = item.value("id", "UNKNOWN");
-        if (id.starts_with("DEBIAN-CVE") && item.contains("aliases") &&
-            item["aliases"].is_array() && !item["aliases"].empty()) {
-          id = item["aliases"][0].get<std::string>();
-        }
-        cve.id = id;
-
-        // Summary extraction (fallback to 'details' as Debian often lacks 'summary')
-        cve.summary = item.value("summary", "");
-        if (cve.summary.empty() && item.contains("details")) {
-          std::string details = item.value("details", "");
-          // Truncate long details for overview
-          if (details.length() > 150)
-            details = details.substr(0, 147) + "...";
-
-          // Remove newlines for cleaner JSON
-          std::replace(details.begin(), details.end(), '\n', ' ');
-          cve.summary = details;
+  return results;
+}
+
+/**
+ * @brief A single (package, version) lookup for the batched CVE resolver.
+ */
+struct CveQuery {
+  std::string name;    ///< Dependency name (mapped via osv_package_name).
+  std::string version; ///< Cleaned version string (without leading 'v').
+};
+
+/**
+ * @brief Maximum number of queries per OSV /v1/querybatch request.
+ */
+constexpr std::size_t OSV_BATCH_LIMIT = 1000;
+
+/**
+ * @brief Queries OSV.dev for many packages at once.
+ *
+ * Sends the queries in chunks to `/v1/querybatch` (which only returns
+ * vulnerability IDs) and then fetches the full record of every unique ID
+ * once via `/v1/vulns/{id}`. All requests run concurrently on the shared
+ * HttpClient. Results are identical to calling query_cves()
+ * for every entry, including the SAFE/NOT-CHECKED/CHECK-ERROR sentinels.
+ * Packages with paginated batch results fall back to query_cves().
+ *
+ * @param queries The (name, version) tuples to check.
+ * @param ecosystem The OSV ecosystem (default: "Debian").
+ * @return std::vector<std::vector<CVE>> One result list per query, same order.
+ */
+inline std::vector<std::vector<CVE>>
+query_cves_batch(const std::vector<CveQuery> &queries,
+                 const std::string &ecosystem = "Debian") {
+  std::vector<std::vector<CVE>> results(queries.size());
+
+  // 1. Deduplicate checkable (package, version) tuples
+  std::vector<std::pair<std::string, std::string>> unique;
+  std::map<std::pair<std::string, std::string>, std::size_t> unique_index;
+  std::vector<std::size_t> query_slot(queries.size(), SIZE_MAX);
+
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    const auto &q = queries[i];
+    if (q.name.empty() || q.version.empty() || q.version == "unknown" ||
+        q.version == "latest") {
+      results[i].push_back(make_not_checked_cve());
+      continue;
+    }
+    std::pair<std::string, std::string> key{osv_package_name(q.name),
+                                            q.version};
+    auto [it, inserted] = unique_index.try_emplace(key, unique.size());
+    if (inserted)
+      unique.push_back(key);
+    query_slot[i] = it->second;
+  }
+
+  if (unique.empty())
+    return results;
+
+  scan_log() << "   [CVE Check] Batch query for " << unique.size()
+            << " packages (" << ecosystem << ") ...\n";
+
+  // 2. Send batches, collect vulnerability IDs per unique tuple
+  std::vector<std::vector<CVE>> unique_results(unique.size());
+  std::vector<std::vector<std::string>> vuln_ids(unique.size());
+  std::vector<bool> resolved(unique.size(), false);
+
+  std::vector<HttpRequest> batch_requests;
+  for (std::size_t begin = 0; begin < unique.size();
+       begin += OSV_BATCH_LIMIT) {
+    std::size_t end = std::min(unique.size(), begin + OSV_BATCH_LIMIT);
+
+    json batch;
+    batch["queries"] = json::array();
+    for (std::size_t u = begin; u < end; ++u) {
+      json query;
+      query["package"] = {{"name", unique[u].first}, {"ecosystem", ecosystem}};
+      query["version"] = unique[u].second;
+      batch["queries"].push_back(query);
+    }
+    batch_requests.push_back({osv_api_base() + "/querybatch", batch.dump(),
+                              true, "application/json", 0});
+  }
+  auto batch_responses = HttpClient::instance().perform(batch_requests);
+
+  for (std::size_t chunk = 0; chunk < batch_responses.size(); ++chunk) {
+    std::size_t begin = chunk * OSV_BATCH_LIMIT;
+    std::size_t end = std::min(unique.size(), begin + OSV_BATCH_LIMIT);
+    std::string response = response_body_or_empty(batch_responses[chunk]);
+
+    auto fail_chunk = [&](const CVE &error) {
+      for (std::size_t u = begin; u < end; ++u) {
+        unique_results[u] = {error};
+        resolved[u] = true;
+      }
+    };
+
+    if (response.empty()) {
+      scan_log() << "   [CVE Check] Batch failed (Network Error)\n";
+      fail_chunk(
+          make_check_error_cve("Network request failed or no output from curl"));
+      continue;
+    }
+
+    try {
+      auto doc = json::parse(response);
+
+      if (doc.contains("message") && doc.contains("code")) {
+        std::string error_msg = doc["message"].get<std::string>();
+        scan_log() << "   [CVE Check] Batch API Error (" << error_msg << ")\n";
+        fail_chunk(make_check_error_cve("OSV API Error: " + error_msg));
+        continue;
+      }
+
+      const auto &batch_results = doc.at("results");
+      for (std::size_t u = begin; u < end; ++u) {
+        const auto &res = batch_results.at(u - begin);
+        if (res.contains("next_page_token")) {
+          // Too many vulns for one page -> let the single query handle it
+          continue;
         }
-        if (cve.summary.empty())
-          cve.summary = "No summary available";
-
-        // Severity (Debian often lacks severity, use fallback)
-        if (item.contains("severity") && item["severity"].is_array() &&
-            !item["severity"].empty()) {
-          cve.severity = item["severity"][0].value("score", "UNKNOWN");
-          cve.score = extract_cvss_score(cve.severity);
-        } else {
-          cve.severity = "UNKNOWN";
-          cve.score = 0.0;
+        if (res.contains("vulns") && res["vulns"].is_array()) {
+          for (const auto &v : res["vulns"])
+            vuln_ids[u].push_back(v.value("id", ""));
         }
+        resolved[u] = true;
+      }
+    } catch (const std::exception &e) {
+      scan_log() << "   [CVE Check] Batch JSON Error: " << e.what() << "\n";
+      fail_chunk(
+          make_check_error_cve(std::string("JSON parse error: ") + e.what()));
+    }
+  }
 
-        // Fixed Version
-        if (item.contains("affected") && item["affected"].is_array()) {
-          for (const auto &affected : item["affected"]) {
-            if (affected.contains("ranges")) {
-              for (const auto &range : affected["ranges"]) {
-                if (range.contains("events")) {
-                  for (const auto &event : range["events"]) {
-                    if (event.contains("fixed")) {
-                      cve.fixed_version = event["fixed"];
-                      break;
-                    }
-                  }
-                }
-              }
-            }
-          }
-        }
+  // 3. Fetch full details once per unique vulnerability ID
+  std::map<std::string, std::optional<CVE>> details;
+  for (std::size_t u = 0; u < unique.size(); ++u)
+    if (unique_results[u].empty())
+      for (const auto &id : vuln_ids[u])
+        details.try_emplace(id);
 
-        cve.suppressed = false;
-        cve.suppression_reason = "";
+  std::vector<HttpRequest> detail_requests;
+  std::vector<std::optional<CVE> *> detail_slots;
+  for (auto &[id, cve] : details) {
+    if (id.empty())
+      continue;
+    detail_requests.push_back(
+        {osv_api_base() + "/vulns/" + id, "", false, "", 0});
+    detail_slots.push_back(&cve);
+  }
 
-        results.push_back(cve);
-      }
-    } else {
-      std::cerr << "OK (Safe)\n";
-      CVE safe_entry;
-      safe_entry.id = "SAFE";
-      safe_entry.severity = "NONE";
-      safe_entry.fixed_version = "";
-      safe_entry.summary = "No vulnerabilities found in ecosystem '" +
-                           ecosystem + "'. Checked on " + get_current_date();
-      safe_entry.suppressed = false;
-      safe_entry.suppression_reason = "";
-      results.push_back(safe_entry);
+  auto detail_responses = HttpClient::instance().perform(detail_requests);
+  for (std::size_t d = 0; d < detail_responses.size(); ++d) {
+    const auto &resp = detail_responses[d];
+    if (!resp.completed() || resp.body.empty())
+      continue;
+    try {
+      auto doc = json::parse(resp.body);
+      if (!(doc.contains("message") && doc.contains("code")))
+        *detail_slots[d] = parse_osv_vuln(doc);
+    } catch (const std::exception &) {
     }
-  } catch (const std::exception &e) {
-    std::cerr << "JSON Error: " << e.what() << "\n";
-    results.push_back({"CHECK-ERROR",
-                       std::string("JSON parse error: ") + e.what(), "UNKNOWN",
-                       0.0, "", false, ""});
   }
 
+  // 4. Assemble per-package results (same output as query_cves)
+  for (std::size_t u = 0; u < unique.size(); ++u) {
+    if (!unique_results[u].empty())
+      continue; // batch-level error already recorded
+
+    const auto &[name, version] = unique[u];
+    if (!resolved[u]) {
+      unique_results[u] = query_cves(name, version, ecosystem);
+      continue;
+    }
+
+    scan_log() << "   [CVE Check] " << name << " @ " << version << " ("
+              << ecosystem << ") ... ";
+
+    if (vuln_ids[u].empty()) {
+      scan_log() << "OK (Safe)\n";
+      unique_results[u].push_back(make_safe_cve(ecosystem));
+      continue;
+    }
+
+    bool complete = std::all_of(
+        vuln_ids[u].begin(), vuln_ids[u].end(),
+        [&](const std::string &id) { return details[id].has_value(); });
+    if (!complete) {
+      scan_log() << "Failed (Network Error)\n";
+      unique_results[u].push_back(make_check_error_cve(
+          "Network request failed or no output from curl"));
+      continue;
+    }
+
+    scan_log() << "FOUND " << vuln_ids[u].size() << " Vulns!\n";
+    for (const auto &id : vuln_ids[u])
+      unique_results[u].push_back(*details[id]);
+  }
+
+  for (std::size_t i = 0; i < queries.size(); ++i)
+    if (query_slot[i] != SIZE_MAX)
+      results[i] = unique_results[query_slot[i]];
+
   return results;
 }
 
@@ -0,0 +1,640 @@
+/**
+ * SPDX-FileComment: CVSS Vector Scoring
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file cvss.hpp
+ * @brief Base scores of CVSS v2, v3.x and v4.0 vectors without exceptions.
+ * @version 1.2.1
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "scan_log.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+
+namespace depdiscover {
+
+namespace cvss_detail {
+
+/// Weight of one value of a base metric.
+struct MetricWeight {
+  std::string_view metric;
+  char value;
+  double weight;
+};
+
+/// CVSS v3.x base metric weights (v3.1 specification, section 7.4).
+inline constexpr MetricWeight V3_WEIGHTS[] = {
+    {"AV", 'N', 0.85}, {"AV", 'A', 0.62}, {"AV", 'L', 0.55}, {"AV", 'P', 0.2},
+    {"AC", 'L', 0.77}, {"AC", 'H', 0.44},
+    {"PR", 'N', 0.85}, {"PR", 'L', 0.62}, {"PR", 'H', 0.27},
+    {"UI", 'N', 0.85}, {"UI", 'R', 0.62},
+    {"C", 'H', 0.56},  {"C", 'L', 0.22},  {"C", 'N', 0.0},
+    {"I", 'H', 0.56},  {"I", 'L', 0.22},  {"I", 'N', 0.0},
+    {"A", 'H', 0.56},  {"A", 'L', 0.22},  {"A", 'N', 0.0},
+};
+
+/// Privileges Required if the scope changes (S:C).
+inline constexpr MetricWeight V3_PR_SCOPE_CHANGED[] = {
+    {"PR", 'N', 0.85}, {"PR", 'L', 0.68}, {"PR", 'H', 0.5}};
+
+/// CVSS v2 base metric weights (v2 specification, section 3.2.1).
+inline constexpr MetricWeight V2_WEIGHTS[] = {
+    {"AV", 'L', 0.395}, {"AV", 'A', 0.646}, {"AV", 'N', 1.0},
+    {"AC", 'H', 0.35},  {"AC", 'M', 0.61},  {"AC", 'L', 0.71},
+    {"Au", 'M', 0.45},  {"Au", 'S', 0.56},  {"Au", 'N', 0.704},
+    {"C", 'N', 0.0},    {"C", 'P', 0.275},  {"C", 'C', 0.660},
+    {"I", 'N', 0.0},    {"I", 'P', 0.275},  {"I", 'C', 0.660},
+    {"A", 'N', 0.0},    {"A", 'P', 0.275},  {"A", 'C', 0.660},
+};
+
+inline constexpr std::array<std::string_view, 8> V3_METRICS = {
+    "AV", "AC", "PR", "UI", "S", "C", "I", "A"};
+inline constexpr std::array<std::string_view, 6> V2_METRICS = {
+    "AV", "AC", "Au", "C", "I", "A"};
+/// v4.0: the 11 base metrics, threat, requirements and modified metrics.
+inline constexpr std::array<std::string_view, 26> V4_METRICS = {
+    "AV",  "AC",  "AT",  "PR",  "UI",  "VC",  "VI",  "VA",  "SC",
+    "SI",  "SA",  "E",   "CR",  "IR",  "AR",  "MAV", "MAC", "MAT",
+    "MPR", "MUI", "MVC", "MVI", "MVA", "MSC", "MSI", "MSA"};
+inline constexpr std::size_t V4_BASE_METRICS = 11;
+
+/**
+ * @brief Returns the weight of a metric value (negative if unknown).
+ */
+constexpr double weight(std::span<const MetricWeight> table,
+                        std::string_view metric, char value) {
+  for (const auto &w : table)
+    if (w.metric == metric && w.value == value)
+      return w.weight;
+  return -1.0;
+}
+
+/**
+ * @brief Reads the single-letter values of the given metrics from
+ * `K:V/K:V/...`.
+ *
+ * Other metrics (temporal, environmental, supplemental) and empty parts
+ * (e.g., from a trailing `/`) are skipped. Absent optional metrics are 0.
+ *
+ * @param required The first `required` names must be present.
+ * @return true If every required metric is present and none twice.
+ */
+template <std::size_t N>
+bool read_base_metrics(std::string_view body,
+                       const std::array<std::string_view, N> &names,
+                       std::array<char, N> &values, std::size_t required = N) {
+  values.fill(0);
+  while (!body.empty()) {
+    std::size_t slash = body.find('/');
+    std::string_view part = body.substr(0, slash);
+    body = slash == std::string_view::npos ? std::string_view()
+                                           : body.substr(slash + 1);
+    if (part.empty())
+      continue;
+    std::size_t colon = part.find(':');
+    if (colon == std::string_view::npos)
+      return false;
+    std::string_view key = part.substr(0, colon);
+    std::string_view value = part.substr(colon + 1);
+    for (std::size_t i = 0; i < N; ++i)
+      if (names[i] == key) {
+        if (values[i] != 0 || value.size() != 1)
+          return false;
+        values[i] = value[0];
+      }
+  }
+  return std::find(values.begin(), values.begin() + required, 0) ==
+         values.begin() + required;
+}
+
+/// Roundup as defined by CVSS v3.1 (Appendix A, robust to float error).
+inline double roundup_v31(double x) {
+  long long i = std::llround(x * 100000.0);
+  if (i % 10000 == 0)
+    return static_cast<double>(i) / 100000.0;
+  return (std::floor(static_cast<double>(i) / 10000.0) + 1.0) / 10.0;
+}
+
+/// Roundup as defined by CVSS v3.0.
+inline double roundup_v30(double x) { return std::ceil(x * 10.0) / 10.0; }
+
+/**
+ * @brief Base score of the metrics of a v3.x vector (without prefix).
+ */
+inline std::optional<double> v3_base_score(std::string_view body, bool v31) {
+  std::array<char, V3_METRICS.size()> v{};
+  if (!read_base_metrics(body, V3_METRICS, v) || (v[4] != 'U' && v[4] != 'C'))
+    return std::nullopt;
+  const bool changed = v[4] == 'C';
+
+  std::array<double, V3_METRICS.size()> w{};
+  for (std::size_t i = 0; i < w.size(); ++i) {
+    if (i == 4)
+      continue;
+    w[i] = weight(i == 2 && changed ? std::span<const MetricWeight>(V3_PR_SCOPE_CHANGED)
+                                    : std::span<const MetricWeight>(V3_WEIGHTS),
+                  V3_METRICS[i], v[i]);
+    if (w[i] < 0.0)
+      return std::nullopt;
+  }
+
+  const double iss = 1.0 - (1.0 - w[5]) * (1.0 - w[6]) * (1.0 - w[7]);
+  const double impact = changed ? 7.52 * (iss - 0.029) -
+                                      3.25 * std::pow(iss - 0.02, 15)
+                                : 6.42 * iss;
+  const double exploitability = 8.22 * w[0] * w[1] * w[2] * w[3];
+  if (impact <= 0.0)
+    return 0.0;
+  const double raw = changed ? 1.08 * (impact + exploitability)
+                             : impact + exploitability;
+  return v31 ? roundup_v31(std::min(raw, 10.0))
+             : roundup_v30(std::min(raw, 10.0));
+}
+
+/**
+ * @brief Base score of the metrics of a v2 vector (without prefix).
+ */
+inline std::optional<double> v2_base_score(std::string_view body) {
+  std::array<char, V2_METRICS.size()> v{};
+  if (!read_base_metrics(body, V2_METRICS, v))
+    return std::nullopt;
+  std::array<double, V2_METRICS.size()> w{};
+  for (std::size_t i = 0; i < w.size(); ++i)
+    if ((w[i] = weight(V2_WEIGHTS, V2_METRICS[i], v[i])) < 0.0)
+      return std::nullopt;
+
+  const double impact =
+      10.41 * (1.0 - (1.0 - w[3]) * (1.0 - w[4]) * (1.0 - w[5]));
+  if (impact == 0.0)
+    return 0.0;
+  const double exploitability = 20.0 * w[0] * w[1] * w[2];
+  const double raw = (0.6 * impact + 0.4 * exploitability - 1.5) * 1.176;
+  return std::round(raw * 10.0) / 10.0;
+}
+
+/**
+ * @brief MacroVector scores of CVSS v4.0 (specification, section 8.2).
+ *
+ * The key is the digit of EQ1 ... EQ6; combinations that cannot occur are
+ * missing. Sorted by key.
+ */
+struct MacroScore {
+  std::string_view macro;
+  double score;
+};
+
+inline constexpr MacroScore V4_MACRO_SCORES[] = {
+    {"000000", 10.0}, {"000001", 9.9}, {"000010", 9.8}, {"000011", 9.5},
+    {"000020", 9.5},  {"000021", 9.2}, {"000100", 10.0}, {"000101", 9.6},
+    {"000110", 9.3},  {"000111", 8.7}, {"000120", 9.1}, {"000121", 8.1},
+    {"000200", 9.3},  {"000201", 9.0}, {"000210", 8.9}, {"000211", 8.0},
+    {"000220", 8.1},  {"000221", 6.8}, {"001000", 9.8}, {"001001", 9.5},
+    {"001010", 9.5},  {"001011", 9.2}, {"001020", 9.0}, {"001021", 8.4},
+    {"001100", 9.3},  {"001101", 9.2}, {"001110", 8.9}, {"001111", 8.1},
+    {"001120", 8.1},  {"001121", 6.5}, {"001200", 8.8}, {"001201", 8.0},
+    {"001210", 7.8},  {"001211", 7.0}, {"001220", 6.9}, {"001221", 4.8},
+    {"002001", 9.2},  {"002011", 8.2}, {"002021", 7.2}, {"002101", 7.9},
+    {"002111", 6.9},  {"002121", 5.0}, {"002201", 6.9}, {"002211", 5.5},
+    {"002221", 2.7},  {"010000", 9.9}, {"010001", 9.7}, {"010010", 9.5},
+    {"010011", 9.2},  {"010020", 9.2}, {"010021", 8.5}, {"010100", 9.5},
+    {"010101", 9.1},  {"010110", 9.0}, {"010111", 8.3}, {"010120", 8.4},
+    {"010121", 7.1},  {"010200", 9.2}, {"010201", 8.1}, {"010210", 8.2},
+    {"010211", 7.1},  {"010220", 7.2}, {"010221", 5.3}, {"011000", 9.5},
+    {"011001", 9.3},  {"011010", 9.2}, {"011011", 8.5}, {"011020", 8.5},
+    {"011021", 7.3},  {"011100", 9.2}, {"011101", 8.2}, {"011110", 8.0},
+    {"011111", 7.2},  {"011120", 7.0}, {"011121", 5.9}, {"011200", 8.4},
+    {"011201", 7.0},  {"011210", 7.1}, {"011211", 5.2}, {"011220", 5.0},
+    {"011221", 3.0},  {"012001", 8.6}, {"012011", 7.5}, {"012021", 5.2},
+    {"012101", 7.1},  {"012111", 5.2}, {"012121", 2.9}, {"012201", 6.3},
+    {"012211", 2.9},  {"012221", 1.7}, {"100000", 9.8}, {"100001", 9.5},
+    {"100010", 9.4},  {"100011", 8.7}, {"100020", 9.1}, {"100021", 8.1},
+    {"100100", 9.4},  {"100101", 8.9}, {"100110", 8.6}, {"100111", 7.4},
+    {"100120", 7.7},  {"100121", 6.4}, {"100200", 8.7}, {"100201", 7.5},
+    {"100210", 7.4},  {"100211", 6.3}, {"100220", 6.3}, {"100221", 4.9},
+    {"101000", 9.4},  {"101001", 8.9}, {"101010", 8.8}, {"101011", 7.7},
+    {"101020", 7.6},  {"101021", 6.7}, {"101100", 8.6}, {"101101", 7.6},
+    {"101110", 7.4},  {"101111", 5.8}, {"101120", 5.9}, {"101121", 5.0},
+    {"101200", 7.2},  {"101201", 5.7}, {"101210", 5.7}, {"101211", 5.2},
+    {"101220", 5.2},  {"101221", 2.5}, {"102001", 8.3}, {"102011", 7.0},
+    {"102021", 5.4},  {"102101", 6.5}, {"102111", 5.8}, {"102121", 2.6},
+    {"102201", 5.3},  {"102211", 2.1}, {"102221", 1.3}, {"110000", 9.5},
+    {"110001", 9.0},  {"110010", 8.8}, {"110011", 7.6}, {"110020", 7.6},
+    {"110021", 7.0},  {"110100", 9.0}, {"110101", 7.7}, {"110110", 7.5},
+    {"110111", 6.2},  {"110120", 6.1}, {"110121", 5.3}, {"110200", 7.7},
+    {"110201", 6.6},  {"110210", 6.8}, {"110211", 5.9}, {"110220", 5.2},
+    {"110221", 3.0},  {"111000", 8.9}, {"111001", 7.8}, {"111010", 7.6},
+    {"111011", 6.7},  {"111020", 6.2}, {"111021", 5.8}, {"111100", 7.4},
+    {"111101", 5.9},  {"111110", 5.7}, {"111111", 5.7}, {"111120", 4.7},
+    {"111121", 2.3},  {"111200", 6.1}, {"111201", 5.2}, {"111210", 5.7},
+    {"111211", 2.9},  {"111220", 2.4}, {"111221", 1.6}, {"112001", 7.1},
+    {"112011", 5.9},  {"112021", 3.0}, {"112101", 5.8}, {"112111", 2.6},
+    {"112121", 1.5},  {"112201", 2.3}, {"112211", 1.3}, {"112221", 0.6},
+    {"200000", 9.3},  {"200001", 8.7}, {"200010", 8.6}, {"200011", 7.2},
+    {"200020", 7.5},  {"200021", 5.8}, {"200100", 8.6}, {"200101", 7.4},
+    {"200110", 7.4},  {"200111", 6.1}, {"200120", 5.6}, {"200121", 3.4},
+    {"200200", 7.0},  {"200201", 5.4}, {"200210", 5.2}, {"200211", 4.0},
+    {"200220", 4.0},  {"200221", 2.2}, {"201000", 8.5}, {"201001", 7.5},
+    {"201010", 7.4},  {"201011", 5.5}, {"201020", 6.2}, {"201021", 5.1},
+    {"201100", 7.2},  {"201101", 5.7}, {"201110", 5.5}, {"201111", 4.1},
+    {"201120", 4.6},  {"201121", 1.9}, {"201200", 5.3}, {"201201", 3.6},
+    {"201210", 3.4},  {"201211", 1.9}, {"201220", 1.9}, {"201221", 0.8},
+    {"202001", 6.4},  {"202011", 5.1}, {"202021", 2.0}, {"202101", 4.7},
+    {"202111", 2.1},  {"202121", 1.1}, {"202201", 2.4}, {"202211", 0.9},
+    {"202221", 0.4},  {"210000", 8.8}, {"210001", 7.5}, {"210010", 7.3},
+    {"210011", 5.3},  {"210020", 6.0}, {"210021", 5.0}, {"210100", 7.3},
+    {"210101", 5.5},  {"210110", 5.9}, {"210111", 4.0}, {"210120", 4.1},
+    {"210121", 2.0},  {"210200", 5.4}, {"210201", 4.3}, {"210210", 4.5},
+    {"210211", 2.2},  {"210220", 2.0}, {"210221", 1.1}, {"211000", 7.5},
+    {"211001", 5.5},  {"211010", 5.8}, {"211011", 4.5}, {"211020", 4.0},
+    {"211021", 2.1},  {"211100", 6.1}, {"211101", 5.1}, {"211110", 4.8},
+    {"211111", 1.8},  {"211120", 2.0}, {"211121", 0.9}, {"211200", 4.6},
+    {"211201", 1.8},  {"211210", 1.7}, {"211211", 0.7}, {"211220", 0.8},
+    {"211221", 0.2},  {"212001", 5.3}, {"212011", 2.4}, {"212021", 1.4},
+    {"212101", 2.4},  {"212111", 1.2}, {"212121", 0.5}, {"212201", 1.0},
+    {"212211", 0.3},  {"212221", 0.1},
+};
+
+/// The score of a MacroVector (negative if it cannot occur).
+inline double macro_score(const int (&eq)[6]) {
+  char key[6];
+  for (int i = 0; i < 6; ++i) {
+    if (eq[i] < 0 || eq[i] > 9)
+      return -1.0;
+    key[i] = static_cast<char>('0' + eq[i]);
+  }
+  std::string_view k(key, 6);
+  const auto *it = std::lower_bound(
+      std::begin(V4_MACRO_SCORES), std::end(V4_MACRO_SCORES), k,
+      [](const MacroScore &m, std::string_view x) { return m.macro < x; });
+  return it != std::end(V4_MACRO_SCORES) && it->macro == k ? it->score : -1.0;
+}
+
+/**
+ * @brief Severity level of a metric value in tenths (section 8.2; lower is
+ * more severe).
+ */
+inline int v4_level(std::string_view metric, char value) {
+  auto pick = [value](std::string_view values, int first) {
+    std::size_t i = values.find(value);
+    return i == std::string_view::npos ? -1 : first + static_cast<int>(i);
+  };
+  if (metric == "AV")
+    return pick("NALP", 0);
+  if (metric == "PR" || metric == "CR" || metric == "IR" || metric == "AR")
+    return pick(metric == "PR" ? "NLH" : "HML", 0);
+  if (metric == "UI")
+    return pick("NPA", 0);
+  if (metric == "AC")
+    return pick("LH", 0);
+  if (metric == "AT")
+    return pick("NP", 0);
+  if (metric == "SC")
+    return pick("HLN", 1);
+  if (metric == "SI" || metric == "SA")
+    return pick("SHLN", 0);
+  return pick("HLN", 0); // VC, VI, VA
+}
+
+/// The most severe vectors of each EQ level (metric:value pairs).
+struct MaxVectors {
+  std::string_view metrics;
+  std::array<std::string_view, 5> vectors;
+};
+
+inline constexpr MaxVectors V4_EQ1_MAX[] = {
+    {"AV PR UI", {"NNN"}},
+    {"AV PR UI", {"ANN", "NLN", "NNP"}},
+    {"AV PR UI", {"PNN", "ALP"}},
+};
+inline constexpr MaxVectors V4_EQ2_MAX[] = {
+    {"AC AT", {"LN"}},
+    {"AC AT", {"HN", "LP"}},
+};
+/// Indexed by EQ3 * 2 + EQ6 (EQ3 2 implies EQ6 1).
+inline constexpr MaxVectors V4_EQ3EQ6_MAX[] = {
+    {"VC VI VA CR IR AR", {"HHHHHH"}},
+    {"VC VI VA CR IR AR", {"HHLMMH", "HHHMMM"}},
+    {"VC VI VA CR IR AR", {"LHHHHH", "HLHHHH"}},
+    {"VC VI VA CR IR AR",
+     {"LHLHMH", "LHHHMM", "HLHMHM", "HLLMHH", "LLHHHM"}},
+    {"VC VI VA CR IR AR", {}},
+    {"VC VI VA CR IR AR", {"LLLHHH"}},
+};
+inline constexpr MaxVectors V4_EQ4_MAX[] = {
+    {"SC SI SA", {"HSS"}},
+    {"SC SI SA", {"HHH"}},
+    {"SC SI SA", {"LLL"}},
+};
+
+/// Depth (number of steps) of each EQ level.
+inline constexpr int V4_EQ1_DEPTH[] = {1, 4, 5};
+inline constexpr int V4_EQ2_DEPTH[] = {1, 2};
+inline constexpr int V4_EQ3EQ6_DEPTH[] = {7, 6, 8, 8, 0, 10};
+inline constexpr int V4_EQ4_DEPTH[] = {6, 5, 4};
+
+/**
+ * @brief Severity distance of a vector below the most severe vector of its
+ * EQ level, in tenths.
+ *
+ * @param value Returns the effective value of a metric of the vector.
+ * @return int The distance of the first max vector the vector does not
+ * exceed (0 if none fits).
+ */
+template <class Value>
+int eq_distance(const MaxVectors &max, Value &&value) {
+  std::array<std::string_view, 6> names{};
+  std::size_t count = 0;
+  for (std::string_view rest = max.metrics; !rest.empty() && count < 6;) {
+    std::size_t space = rest.find(' ');
+    names[count++] = rest.substr(0, space);
+    rest = space == std::string_view::npos ? std::string_view()
+                                           : rest.substr(space + 1);
+  }
+  for (std::string_view vec : max.vectors) {
+    if (vec.empty())
+      break;
+    int total = 0;
+    bool fits = true;
+    for (std::size_t i = 0; i < count; ++i) {
+      int d = v4_level(names[i], value(names[i])) - v4_level(names[i], vec[i]);
+      if (d < 0) {
+        fits = false;
+        break;
+      }
+      total += d;
+    }
+    if (fits)
+      return total;
+  }
+  return 0;
+}
+
+/**
+ * @brief Base (or environmental) score of a v4.0 vector (without prefix)
+ * by the MacroVector method of the v4.0 specification, section 8.2.
+ *
+ * The vector is mapped to its MacroVector (EQ1 ... EQ6), whose score is
+ * lowered by the mean proportional distance of the vector below the most
+ * severe vectors of its MacroVector. Threat (`E`) and environmental
+ * metrics are honoured; supplemental metrics are ignored.
+ */
+inline std::optional<double> v4_base_score(std::string_view body) {
+  std::array<char, V4_METRICS.size()> v{};
+  if (!read_base_metrics(body, V4_METRICS, v, V4_BASE_METRICS))
+    return std::nullopt;
+  // Allowed values per metric; optional metrics also accept X
+  static constexpr std::string_view allowed[] = {
+      "NALP", "LH",   "NP",    "NLH",   "NPA",   "HLN",   "HLN",
+      "HLN",  "HLN",  "HLN",   "HLN",   "XAPU",  "XHML",  "XHML",
+      "XHML", "XNALP", "XLH",  "XNP",   "XNLH",  "XNPA",  "XHLN",
+      "XHLN", "XHLN", "XHLN",  "XSHLN", "XSHLN"};
+  for (std::size_t i = 0; i < v.size(); ++i)
+    if (v[i] != 0 && allowed[i].find(v[i]) == std::string_view::npos)
+      return std::nullopt;
+
+  // Effective values: modified metrics override, E defaults to A, the
+  // requirements to H
+  auto value = [&v](std::string_view metric) -> char {
+    for (std::size_t i = 0; i < V4_BASE_METRICS; ++i)
+      if (V4_METRICS[i] == metric) {
+        char m = v[V4_BASE_METRICS + 4 + i];
+        return m != 0 && m != 'X' ? m : v[i];
+      }
+    for (std::size_t i = V4_BASE_METRICS; i < V4_BASE_METRICS + 4; ++i)
+      if (V4_METRICS[i] == metric)
+        return v[i] != 0 && v[i] != 'X' ? v[i] : (i == V4_BASE_METRICS ? 'A' : 'H');
+    return 0;
+  };
+  const char AV = value("AV"), AC = value("AC"), AT = value("AT"),
+             PR = value("PR"), UI = value("UI"), VC = value("VC"),
+             VI = value("VI"), VA = value("VA"), SC = value("SC"),
+             SI = value("SI"), SA = value("SA"), E = value("E"),
+             CR = value("CR"), IR = value("IR"), AR = value("AR");
+  if (VC == 'N' && VI == 'N' && VA == 'N' && SC == 'N' && SI == 'N' &&
+      SA == 'N')
+    return 0.0;
+
+  int eq[6];
+  eq[0] = (AV == 'N' && PR == 'N' && UI == 'N')                    ? 0
+          : ((AV == 'N' || PR == 'N' || UI == 'N') && AV != 'P') ? 1
+                                                                   : 2;
+  eq[1] = AC == 'L' && AT == 'N' ? 0 : 1;
+  eq[2] = (VC == 'H' && VI == 'H')                 ? 0
+          : (VC == 'H' || VI == 'H' || VA == 'H') ? 1
+                                                   : 2;
+  eq[3] = (SI == 'S' || SA == 'S')                 ? 0
+          : (SC == 'H' || SI == 'H' || SA == 'H') ? 1
+                                                   : 2;
+  eq[4] = E == 'A' ? 0 : E == 'P' ? 1 : 2;
+  eq[5] = (CR == 'H' && VC == 'H') || (IR == 'H' && VI == 'H') ||
+                  (AR == 'H' && VA == 'H')
+              ? 0
+              : 1;
+
+  const double score = macro_score(eq);
+  if (score < 0.0)
+    return std::nullopt;
+
+  // Score of the next lower MacroVector of an EQ (negative if none)
+  auto lower = [&eq](int index, int step) {
+    int next[6];
+    std::copy(std::begin(eq), std::end(eq), next);
+    next[index] += step;
+    return macro_score(next);
+  };
+  double lower_eq3eq6;
+  if (eq[2] == 0 && eq[5] == 0) {
+    lower_eq3eq6 = std::max(lower(5, 1), lower(2, 1));
+  } else if (eq[2] == 1 && eq[5] == 0) {
+    lower_eq3eq6 = lower(5, 1);
+  } else if (eq[5] == 1 && eq[2] < 2) {
+    lower_eq3eq6 = lower(2, 1);
+  } else {
+    lower_eq3eq6 = -1.0;
+  }
+
+  const int eq36 = eq[2] * 2 + eq[5];
+  struct Part {
+    double lower;   ///< Score of the next lower MacroVector.
+    int distance;   ///< Severity distance in tenths.
+    int depth;      ///< Steps to the next lower MacroVector.
+  };
+  const Part parts[] = {
+      {lower(0, 1), eq_distance(V4_EQ1_MAX[eq[0]], value), V4_EQ1_DEPTH[eq[0]]},
+      {lower(1, 1), eq_distance(V4_EQ2_MAX[eq[1]], value), V4_EQ2_DEPTH[eq[1]]},
+      {lower_eq3eq6, eq_distance(V4_EQ3EQ6_MAX[eq36], value),
+       V4_EQ3EQ6_DEPTH[eq36]},
+      {lower(3, 1), eq_distance(V4_EQ4_MAX[eq[3]], value), V4_EQ4_DEPTH[eq[3]]},
+      {lower(4, 1), 0, 1}, // E has no distance within its level
+  };
+
+  double sum = 0.0;
+  int existing = 0;
+  for (const Part &p : parts) {
+    if (p.lower < 0.0)
+      continue;
+    ++existing;
+    sum += (score - p.lower) * p.distance / p.depth;
+  }
+  double result = score - (existing ? sum / existing : 0.0);
+  result = std::clamp(result, 0.0, 10.0);
+  return std::round(result * 10.0 + 1e-9) / 10.0;
+}
+
+} // namespace cvss_detail
+
+/**
+ * @brief How far a score derived from a severity string can be trusted.
+ */
+enum class CvssScoreKind {
+  Exact,    ///< A number, or a vector scored by its specification.
+  Unscored, ///< A severity that could not be scored (score 0.0).
+};
+
+/**
+ * @brief A score together with its reliability.
+ */
+struct CvssScore {
+  double value = 0.0;
+  CvssScoreKind kind = CvssScoreKind::Exact;
+};
+
+/**
+ * @brief Computes the base score of a CVSS vector.
+ *
+ * CVSS v3.0 and v3.1 (`CVSS:3.x/...`) and v2 (`AV:N/AC:L/Au:N/...`, also
+ * with `CVSS:2.0/` or in parentheses) are scored with the formulas of their
+ * specifications. v4.0 vectors are scored by the MacroVector method (see
+ * cvss_detail::v4_base_score()), including their threat and environmental
+ * metrics; for v2 and v3.x, temporal and environmental metrics are
+ * ignored.
+ *
+ * @param vector The vector string.
+ * @return std::optional<double> The score, or nullopt if the vector is
+ * malformed or of an unknown version.
+ */
+inline std::optional<double> cvss_base_score(std::string_view vector) {
+  if (vector.starts_with("CVSS:3.1/"))
+    return cvss_detail::v3_base_score(vector.substr(9), true);
+  if (vector.starts_with("CVSS:3.0/"))
+    return cvss_detail::v3_base_score(vector.substr(9), false);
+  if (vector.starts_with("CVSS:4.0/"))
+    return cvss_detail::v4_base_score(vector.substr(9));
+  if (vector.starts_with("CVSS:2.0/"))
+    vector.remove_prefix(9);
+  else if (vector.size() > 2 && vector.front() == '(' && vector.back() == ')')
+    vector = vector.substr(1, vector.size() - 2);
+  if (vector.starts_with("AV:"))
+    return cvss_detail::v2_base_score(vector);
+  return std::nullopt;
+}
+
+/**
+ * @brief Process-wide memo of vector scores.
+ *
+ * OSV reports the same few vectors for thousands of vulnerabilities, so
+ * each distinct string is scored once. A vector that cannot be scored is
+ * reported the first time it is seen.
+ */
+class CvssScoreMemo {
+public:
+  static CvssScoreMemo &instance() {
+    static CvssScoreMemo memo;
+    return memo;
+  }
+
+  /**
+   * @brief Returns the base score of a vector.
+   */
+  CvssScore score(const std::string &vector) {
+    {
+      std::lock_guard lock(mutex_);
+      auto it = scores_.find(vector);
+      if (it != scores_.end())
+        return it->second;
+    }
+    CvssScore s;
+    if (auto base = cvss_base_score(vector))
+      s.value = *base;
+    else
+      s.kind = CvssScoreKind::Unscored;
+    bool first;
+    {
+      std::lock_guard lock(mutex_);
+      first = scores_.try_emplace(vector, s).second;
+    }
+    // Through the stage's log buffer: this runs on the CVE stage
+    if (first && s.kind == CvssScoreKind::Unscored)
+      scan_log() << "[Warning] Cannot score CVSS severity: " << vector << "\n";
+    return s;
+  }
+
+private:
+  CvssScoreMemo() = default;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, CvssScore> scores_;
+};
+
+/**
+ * @brief Scores a severity string.
+ *
+ * Numeric strings are parsed with std::from_chars; vectors are scored by
+ * cvss_base_score() through the CvssScoreMemo. No exceptions are thrown.
+ * "UNKNOWN", "NONE" and empty strings are exact zeros; anything else is
+ * CvssScoreKind::Unscored.
+ *
+ * @param severity_str The severity string (e.g., "7.5" or
+ * "CVSS:3.1/AV:N/AC:L/PR:N/UI:N/S:U/C:H/I:H/A:H").
+ * @return CvssScore The score and its reliability.
+ */
+inline CvssScore score_severity(const std::string &severity_str) {
+  if (severity_str == "UNKNOWN" || severity_str == "NONE" ||
+      severity_str.empty())
+    return {};
+
+  const char *begin = severity_str.data();
+  const char *end = begin + severity_str.size();
+  while (begin != end && (*begin == ' ' || *begin == '\t'))
+    ++begin;
+  double value = 0.0;
+  auto [ptr, ec] = std::from_chars(begin, end, value);
+  if (ptr != begin) {
+    if (ec == std::errc())
+      return {value, CvssScoreKind::Exact};
+    return {0.0, CvssScoreKind::Unscored};
+  }
+
+  return CvssScoreMemo::instance().score(severity_str);
+}
+
+/**
+ * @brief Extracts a CVSS score from a severity string.
+ *
+ * @param severity_str The severity string.
+ * @return double The score of score_severity() (0.0 if unknown).
+ */
+inline double extract_cvss_score(const std::string &severity_str) {
+  return score_severity(severity_str).value;
+}
+
+} // namespace depdiscover
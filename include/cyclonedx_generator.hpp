@@ -6,9 +6,9 @@
  * SPDX-License-Identifier: MIT
  *
  * @file cyclonedx_generator.hpp
- * @brief Generates a valid CycloneDX 1.4 SBOM from internal JSON data.
- * @version 1.0.0
- * @date 2026-02-22
+ * @brief Generates a valid CycloneDX 1.4 SBOM from the dependency list.
+ * @version 1.3.1
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -17,18 +17,21 @@
  */
 
 #pragma once
+#include "json_writer.hpp"
+#include "license_classifier.hpp"
+#include "report_model.hpp"
+#include "types.hpp"
 #include <chrono>
 #include <fstream>
 #include <iomanip>
-#include <nlohmann/json.hpp>
+#include <ostream>
 #include <random>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace depdiscover {
 
-using json = nlohmann::json;
-
 /**
  * @brief Returns an ISO-8601 timestamp for CycloneDX (YYYY-MM-DDThh:mm:ssZ).
  *
@@ -67,147 +70,127 @@ inline std::string generate_uuid_v4() {
 }
 
 /**
- * @brief Generates a CycloneDX 1.4 report from the internal JSON representation.
+ * @brief Writes a CycloneDX 1.4 SBOM to a stream.
  *
- * @param internal_root The root of the internal JSON data.
- * @param filepath The path where the report will be saved.
+ * Members are written in sorted order (as the former nlohmann document
+ * dumped them); `vulnerabilities` comes last and is omitted if empty. Each
+ * vulnerability ID is written once, with all components reporting it in
+ * `affects`; its details come from the first finding.
+ *
+ * @param out The output stream.
+ * @param header The report header.
+ * @param deps The dependencies.
+ * @param model The report model of `deps`.
  */
-inline void generate_cyclonedx_report(const json &internal_root,
-                                      const std::string &filepath) {
-  json cdx;
-  cdx["bomFormat"] = "CycloneDX";
-  cdx["specVersion"] = "1.4";
-  cdx["serialNumber"] = "urn:uuid:" + generate_uuid_v4();
-  cdx["version"] = 1;
-
-  // --- Metadata ---
-  json metadata;
-  metadata["timestamp"] = get_iso8601_timestamp();
-
-  if (internal_root.contains("header")) {
-    auto &h = internal_root["header"];
-
-    // Tool Info
-    json tool;
-    tool["vendor"] = h["tool"].value("author", "Unknown");
-    tool["name"] = h["tool"].value("name", "depdiscover");
-    tool["version"] = h["tool"].value("version", "1.0.0");
-    metadata["tools"] = json::array({tool});
-
-    // Project/Component Info
-    json component;
-    component["type"] = "application";
-    component["name"] = h["project"].value("name", "UnknownProject");
-    metadata["component"] = component;
-  }
-  cdx["metadata"] = metadata;
-
-  // --- Components & Vulnerabilities ---
-  json components = json::array();
-  json vulnerabilities = json::array();
-
-  if (internal_root.contains("dependencies")) {
-    for (const auto &dep : internal_root["dependencies"]) {
-      json comp;
-      std::string name = dep.value("name", "unknown");
-      std::string version = dep.value("version", "unknown");
-
-      // PURL (Package URL) as unique reference
-      std::string purl = "pkg:generic/" + name + "@" + version;
-
-      comp["type"] = "library";
-      comp["name"] = name;
-      comp["version"] = version;
-      comp["bom-ref"] = purl; // Connection point for CVEs
-      comp["purl"] = purl;
-
-      // Licenses
-      if (dep.contains("licenses") && !dep["licenses"].empty()) {
-        json licenses_arr = json::array();
-        for (const auto &lic : dep["licenses"]) {
-          std::string l_str = lic.get<std::string>();
-          // Assuming licenses are SPDX-IDs; fallback to name if unknown
-          if (l_str != "UNKNOWN" && l_str != "unknown") {
-            licenses_arr.push_back({{"license", {{"id", l_str}}}});
-          } else {
-            licenses_arr.push_back({{"license", {{"name", l_str}}}});
-          }
-        }
-        comp["licenses"] = licenses_arr;
-      }
-
-      components.push_back(comp);
-
-      // Vulnerabilities
-      if (dep.contains("cves") && !dep["cves"].empty()) {
-        for (const auto &cve : dep["cves"]) {
-          std::string id = cve.value("id", "UNKNOWN");
-
-          // Ignore internal "Safe" markers for CycloneDX
-          if (id == "SAFE" || id == "NOT-CHECKED" || id == "CHECK-ERROR") {
-            continue;
-          }
-
-          json vuln;
-          vuln["bom-ref"] = purl; // Points to the component above
-          vuln["id"] = id;
-
-          json source;
-          source["name"] = "OSV.dev";
-          vuln["source"] = source;
-
-          std::string summary = cve.value("summary", "");
-          if (!summary.empty())
-            vuln["description"] = summary;
-
-          // Ratings require a mapping to enums (low, medium, high, critical).
-          std::string severity_str = cve.value("severity", "UNKNOWN");
-          double score = cve.value("score", 0.0);
-
-          if (severity_str != "UNKNOWN" && severity_str != "NONE") {
-            json rating;
-            rating["score"] = score;
-            
-            // Map numeric score to CycloneDX severity levels
-            if (score >= 9.0) rating["severity"] = "critical";
-            else if (score >= 7.0) rating["severity"] = "high";
-            else if (score >= 4.0) rating["severity"] = "medium";
-            else if (score >= 0.1) rating["severity"] = "low";
-            else if (severity_str == "CRITICAL" || severity_str == "critical") rating["severity"] = "critical";
-            else if (severity_str == "HIGH" || severity_str == "high") rating["severity"] = "high";
-            else if (severity_str == "MEDIUM" || severity_str == "medium") rating["severity"] = "medium";
-            else if (severity_str == "LOW" || severity_str == "low") rating["severity"] = "low";
-            else rating["severity"] = "unknown";
-
-            vuln["ratings"] = json::array({rating});
-          }
-
-          // Advisories / Links
-          json advisory;
-          if (id.find("CVE-") == 0)
-            advisory["url"] = "https://nvd.nist.gov/vuln/detail/" + id;
-          else if (id.find("GHSA-") == 0)
-            advisory["url"] = "https://github.com/advisories/" + id;
-          else
-            advisory["url"] = "https://osv.dev/vulnerability/" + id;
-          vuln["advisories"] = json::array({advisory});
-
-          vulnerabilities.push_back(vuln);
+inline void write_cyclonedx_report(std::ostream &out,
+                                   const ReportHeader &header,
+                                   const std::vector<Dependency> &deps,
+                                   const ReportModel &model) {
+  JsonWriter w(out, 2);
+  w.begin_object().key("bomFormat").value("CycloneDX");
+
+  // --- Components ---
+  w.key("components").begin_array();
+  for (std::size_t i = 0; i < deps.size(); ++i) {
+    const Dependency &dep = deps[i];
+    const DependencySummary &sum = model.deps[i];
+
+    // Unique reference (the PURL) the vulnerabilities point to
+    w.begin_object().key("bom-ref").value(sum.bom_ref);
+    if (!dep.licenses.empty()) {
+      w.key("licenses").begin_array();
+      for (const auto &l_str : dep.licenses) {
+        // Only list identifiers are ids; compound expressions stand alone
+        std::string_view id;
+        switch (spdx_license_form(l_str, &id)) {
+        case SpdxLicenseForm::Id:
+          w.begin_object().key("license").begin_object()
+              .key("id").value(id).end_object().end_object();
+          break;
+        case SpdxLicenseForm::Expression:
+          w.begin_object().key("expression").value(l_str).end_object();
+          break;
+        case SpdxLicenseForm::Name:
+          w.begin_object().key("license").begin_object()
+              .key("name").value(l_str).end_object().end_object();
+          break;
         }
       }
+      w.end_array();
     }
+    w.key("name").value(dep.name)
+        .key("purl").value(sum.purl)
+        .key("type").value("library")
+        .key("version").value(dep.version)
+        .end_object();
   }
+  w.end_array();
 
-  cdx["components"] = components;
-  if (!vulnerabilities.empty()) {
-    cdx["vulnerabilities"] = vulnerabilities;
+  // --- Metadata ---
+  w.key("metadata").begin_object()
+      .key("component").begin_object()
+      .key("name").value(header.project_name)
+      .key("type").value("application")
+      .end_object()
+      .key("timestamp").value(get_iso8601_timestamp())
+      .key("tools").begin_array().begin_object()
+      .key("name").value(header.tool_name)
+      .key("vendor").value(header.tool_author)
+      .key("version").value(header.tool_version)
+      .end_object().end_array()
+      .end_object();
+
+  w.key("serialNumber").value("urn:uuid:" + generate_uuid_v4())
+      .key("specVersion").value("1.4")
+      .key("version").value(1);
+
+  // --- Vulnerabilities ---
+  if (model.any_vulnerability) {
+    w.key("vulnerabilities").begin_array();
+    for (const VulnerabilityEntry &vuln : model.vulnerabilities) {
+      const CVE &cve = deps[vuln.dep].cves[vuln.cve];
+      w.begin_object()
+          .key("advisories").begin_array().begin_object()
+          .key("url").value(model.deps[vuln.dep].advisory_urls[vuln.cve])
+          .end_object().end_array();
+      w.key("affects").begin_array();
+      for (std::size_t i : vuln.affected)
+        w.begin_object().key("ref").value(model.deps[i].bom_ref).end_object();
+      w.end_array();
+      if (!cve.summary.empty())
+        w.key("description").value(cve.summary);
+      w.key("id").value(cve.id);
+
+      // Ratings require a mapping to enums (low, medium, high, critical).
+      if (cve.severity != "UNKNOWN" && cve.severity != "NONE") {
+        w.key("ratings").begin_array().begin_object()
+            .key("score").value(cve.score)
+            .key("severity")
+            .value(SEVERITY_LEVEL_NAMES[std::size_t(
+                severity_level(cve.score, cve.severity))])
+            .end_object().end_array();
+      }
+      w.key("source").begin_object().key("name").value("OSV.dev").end_object();
+      w.end_object();
+    }
+    w.end_array();
   }
+  w.end_object();
+}
 
-  // Save to file
+/**
+ * @brief Generates a CycloneDX 1.4 report file.
+ *
+ * @param header The report header.
+ * @param deps The dependencies.
+ * @param filepath The path where the report will be saved.
+ */
+inline void generate_cyclonedx_report(const ReportHeader &header,
+                                      const std::vector<Dependency> &deps,
+                                      const std::string &filepath) {
   std::ofstream out(filepath);
-  if (out) {
-    out << cdx.dump(2);
-  }
+  if (out)
+    write_cyclonedx_report(out, header, deps, build_report_model(deps));
 }
 
 } // namespace depdiscover
@@ -0,0 +1,405 @@
+/**
+ * SPDX-FileComment: Indexed Header/Library to Dependency Mapping
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file dependency_mapper.hpp
+ * @brief Assigns scanned headers and libraries to dependencies via indexes.
+ * @version 1.1.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace depdiscover {
+
+/**
+ * @brief Lowercases ASCII characters (as the former `std::tolower` compare).
+ */
+inline std::string ascii_lower(std::string_view s) {
+  std::string out(s);
+  for (auto &c : out)
+    if (c >= 'A' && c <= 'Z')
+      c = static_cast<char>(c - 'A' + 'a');
+  return out;
+}
+
+/**
+ * @brief Claims headers and libraries for dependencies.
+ *
+ * Every item can be claimed by exactly one dependency (the first that
+ * matches). The sorted item lists are indexed once: prefix lookups use
+ * binary search, fuzzy header matches a sorted index of lowercase path
+ * components, and substring matches a lazily built trigram index. Claimed
+ * items are skipped through a "next unclaimed" forest, so each lookup only
+ * touches items it can actually return. All claim functions return the
+ * items in sorted order, like the former linear passes over the std::set.
+ *
+ * The mapper only holds views of the items: header paths are typically
+ * StringPool strings, and a lowercase copy is only made for paths that
+ * contain uppercase characters. The items have to outlive the mapper.
+ */
+class DependencyMapper {
+public:
+  /**
+   * @brief Indexes the headers and libraries to distribute.
+   *
+   * @param headers All resolved header paths (sorted, unique).
+   * @param libs All library file names.
+   */
+  DependencyMapper(const std::vector<std::string_view> &headers,
+                   const std::set<std::string> &libs)
+      : headers_(headers), libs_(libs) {
+    lower_.reserve(headers_.items.size());
+    for (std::string_view h : headers_.items) {
+      if (std::none_of(h.begin(), h.end(),
+                       [](char c) { return c >= 'A' && c <= 'Z'; })) {
+        lower_.push_back(h);
+        continue;
+      }
+      lowered_.push_back(ascii_lower(h));
+      lower_.push_back(lowered_.back());
+    }
+
+    // Components preceded by '/', e.g. "/usr/include/zlib.h" ->
+    // usr (dir), include (dir), zlib.h (file)
+    std::size_t slashes = 0;
+    for (std::string_view p : lower_)
+      slashes += static_cast<std::size_t>(std::count(p.begin(), p.end(), '/'));
+    components_.reserve(slashes);
+    for (std::uint32_t id = 0; id < lower_.size(); ++id) {
+      std::string_view p = lower_[id];
+      std::size_t slash = p.find('/');
+      while (slash != std::string_view::npos) {
+        std::size_t next = p.find('/', slash + 1);
+        std::size_t end = next == std::string_view::npos ? p.size() : next;
+        if (end > slash + 1)
+          components_.push_back(
+              {p.substr(slash + 1, end - slash - 1), id,
+               next != std::string_view::npos});
+        slash = next;
+      }
+    }
+    std::sort(components_.begin(), components_.end(),
+              [](const Component &a, const Component &b) {
+                return a.text < b.text || (a.text == b.text && a.id < b.id);
+              });
+
+    for (std::uint32_t id = 0; id < libs_.items.size(); ++id)
+      lib_stems_.push_back({strip_lib(libs_.items[id]), id});
+    std::sort(lib_stems_.begin(), lib_stems_.end());
+  }
+
+  // The component index holds views into lower_ and lowered_
+  DependencyMapper(const DependencyMapper &) = delete;
+  DependencyMapper &operator=(const DependencyMapper &) = delete;
+
+  /**
+   * @brief Claims all headers below an include directory (string prefix).
+   *
+   * @param dir The include directory.
+   * @return std::vector<std::string> The claimed headers.
+   */
+  std::vector<std::string> claim_headers_with_prefix(const std::string &dir) {
+    std::vector<std::string> out;
+    const auto &items = headers_.items;
+    auto lo = std::lower_bound(items.begin(), items.end(), dir);
+    for (auto i = headers_.find(static_cast<std::uint32_t>(lo - items.begin()));
+         i < items.size() && items[i].compare(0, dir.size(), dir) == 0;
+         i = headers_.find(i + 1))
+      out.push_back(headers_.claim(i));
+    return out;
+  }
+
+  /**
+   * @brief Claims headers matching a package name fuzzily.
+   *
+   * Case-insensitive matches of `/name/`, `/name.h` (incl. `.hpp`) and
+   * `/segment/` for every name segment (split at '_', '-' and blanks) of at
+   * least three characters other than "lib".
+   *
+   * @param name The package name.
+   * @return std::vector<std::string> The claimed headers.
+   */
+  std::vector<std::string> claim_headers_fuzzy(const std::string &name) {
+    const std::string lname = ascii_lower(name);
+
+    std::vector<std::string> segments;
+    std::string clean = lname;
+    std::replace(clean.begin(), clean.end(), '_', ' ');
+    std::replace(clean.begin(), clean.end(), '-', ' ');
+    std::size_t pos = 0;
+    while (pos < clean.size()) {
+      std::size_t b = clean.find_first_not_of(" \t\n\r\f\v", pos);
+      if (b == std::string::npos)
+        break;
+      std::size_t e = clean.find_first_of(" \t\n\r\f\v", b);
+      if (e == std::string::npos)
+        e = clean.size();
+      std::string seg = clean.substr(b, e - b);
+      if (seg.size() >= 3 && seg != "lib")
+        segments.push_back(std::move(seg));
+      pos = e;
+    }
+
+    // Patterns spanning a '/' cannot be answered from the component index
+    if (lname.find('/') != std::string::npos)
+      return claim_linear([&](std::uint32_t id) {
+        const auto &h = lower_[id];
+        if (h.find("/" + lname + "/") != std::string::npos ||
+            h.find("/" + lname + ".h") != std::string::npos)
+          return true;
+        for (const auto &seg : segments)
+          if (h.find("/" + seg + "/") != std::string::npos)
+            return true;
+        return false;
+      });
+
+    std::vector<std::uint32_t> ids;
+    add_dir_component(lname, ids);
+    add_component_prefix(lname + ".h", ids);
+    for (const auto &seg : segments)
+      add_dir_component(seg, ids);
+    return claim_ids(ids);
+  }
+
+  /**
+   * @brief Claims headers containing a string (case-insensitive).
+   *
+   * @param needle The string to look for.
+   * @return std::vector<std::string> The claimed headers.
+   */
+  std::vector<std::string> claim_headers_containing(const std::string &needle) {
+    const std::string lneedle = ascii_lower(needle);
+    if (lneedle.size() < 3)
+      return claim_linear([&](std::uint32_t id) {
+        return lower_[id].find(lneedle) != std::string::npos;
+      });
+
+    build_trigrams();
+    std::uint32_t best = 0, best_size = 0;
+    for (std::size_t i = 0; i + 3 <= lneedle.size(); ++i) {
+      auto it = trigram_slots_.find(trigram(lneedle, i));
+      if (it == trigram_slots_.end())
+        return {};
+      std::uint32_t size =
+          posting_offsets_[it->second + 1] - posting_offsets_[it->second];
+      if (best_size == 0 || size < best_size) {
+        best = it->second;
+        best_size = size;
+      }
+    }
+
+    std::vector<std::string> out;
+    for (auto p = posting_offsets_[best]; p < posting_offsets_[best + 1]; ++p) {
+      auto id = postings_[p];
+      if (!headers_.claimed(id) && lower_[id].find(lneedle) != std::string::npos)
+        out.push_back(headers_.claim(id));
+    }
+    return out;
+  }
+
+  /**
+   * @brief Claims libraries whose file name contains a string.
+   *
+   * @param needle The string to look for (case-sensitive).
+   * @return std::vector<std::string> The claimed libraries.
+   */
+  std::vector<std::string> claim_libs_containing(const std::string &needle) {
+    std::vector<std::string> out;
+    for (auto i = libs_.find(0); i < libs_.items.size(); i = libs_.find(i + 1))
+      if (libs_.items[i].find(needle) != std::string::npos)
+        out.push_back(libs_.claim(i));
+    return out;
+  }
+
+  /**
+   * @brief Claims libraries whose name (without "lib") starts with the
+   * package name (without "lib").
+   *
+   * @param name The package name.
+   * @return std::vector<std::string> The claimed libraries.
+   */
+  std::vector<std::string> claim_libs_fuzzy(const std::string &name) {
+    const std::string stem = strip_lib(name);
+    std::vector<std::uint32_t> ids;
+    auto it = std::lower_bound(lib_stems_.begin(), lib_stems_.end(),
+                               std::make_pair(stem, std::uint32_t{0}));
+    for (; it != lib_stems_.end() && it->first.compare(0, stem.size(), stem) == 0;
+         ++it)
+      ids.push_back(it->second);
+    std::sort(ids.begin(), ids.end());
+
+    std::vector<std::string> out;
+    for (auto id : ids)
+      if (!libs_.claimed(id))
+        out.push_back(libs_.claim(id));
+    return out;
+  }
+
+  /**
+   * @brief Returns the libraries no dependency has claimed (sorted).
+   */
+  std::vector<std::string> unclaimed_libs() {
+    std::vector<std::string> out;
+    for (auto i = libs_.find(0); i < libs_.items.size(); i = libs_.find(i + 1))
+      out.emplace_back(libs_.items[i]);
+    return out;
+  }
+
+private:
+  /**
+   * @brief Sorted items with a union-find "next unclaimed index" forest.
+   */
+  struct Pool {
+    template <class Range>
+    explicit Pool(const Range &sorted)
+        : items(sorted.begin(), sorted.end()), next(items.size() + 1) {
+      for (std::uint32_t i = 0; i < next.size(); ++i)
+        next[i] = i;
+    }
+    /// Smallest unclaimed index >= i (items.size() if none).
+    std::uint32_t find(std::uint32_t i) {
+      std::uint32_t root = i;
+      while (next[root] != root)
+        root = next[root];
+      while (next[i] != root) {
+        std::uint32_t n = next[i];
+        next[i] = root;
+        i = n;
+      }
+      return root;
+    }
+    bool claimed(std::uint32_t i) const { return next[i] != i; }
+    std::string claim(std::uint32_t i) {
+      next[i] = i + 1;
+      return std::string(items[i]);
+    }
+
+    std::vector<std::string_view> items;
+    std::vector<std::uint32_t> next;
+  };
+
+  struct Component {
+    std::string_view text; ///< Lowercase component (view into lower_).
+    std::uint32_t id;      ///< Header index.
+    bool dir;              ///< Followed by '/'.
+  };
+
+  static std::string strip_lib(std::string_view s) {
+    return std::string(s.rfind("lib", 0) == 0 ? s.substr(3) : s);
+  }
+
+  static std::uint32_t trigram(std::string_view s, std::size_t i) {
+    return (std::uint32_t(static_cast<unsigned char>(s[i])) << 16) |
+           (std::uint32_t(static_cast<unsigned char>(s[i + 1])) << 8) |
+           std::uint32_t(static_cast<unsigned char>(s[i + 2]));
+  }
+
+  void build_trigrams() {
+    if (trigrams_built_)
+      return;
+    trigrams_built_ = true;
+
+    // Count first, then fill one flat posting array (no per-trigram vectors)
+    constexpr std::uint32_t NONE = 0xffffffffu;
+    std::vector<std::uint32_t> last;
+    std::vector<std::uint32_t> cursor;
+    for (int pass = 0; pass < 2; ++pass) {
+      last.assign(trigram_slots_.size(), NONE);
+      for (std::uint32_t id = 0; id < lower_.size(); ++id) {
+        std::string_view h = lower_[id];
+        for (std::size_t i = 0; i + 3 <= h.size(); ++i) {
+          auto [it, inserted] = trigram_slots_.try_emplace(
+              trigram(h, i), static_cast<std::uint32_t>(last.size()));
+          if (inserted) {
+            last.push_back(NONE);
+            cursor.push_back(0);
+          }
+          std::uint32_t slot = it->second;
+          if (last[slot] == id)
+            continue; // ids ascend, so only the last can repeat
+          last[slot] = id;
+          if (pass == 0)
+            ++cursor[slot];
+          else
+            postings_[cursor[slot]++] = id;
+        }
+      }
+      if (pass == 0) {
+        posting_offsets_.assign(cursor.size() + 1, 0);
+        for (std::size_t slot = 0; slot < cursor.size(); ++slot)
+          posting_offsets_[slot + 1] = posting_offsets_[slot] + cursor[slot];
+        postings_.resize(posting_offsets_.back());
+        cursor.assign(posting_offsets_.begin(), posting_offsets_.end() - 1);
+      }
+    }
+  }
+
+  void add_dir_component(const std::string &text,
+                         std::vector<std::uint32_t> &ids) const {
+    auto it = std::lower_bound(
+        components_.begin(), components_.end(), text,
+        [](const Component &c, const std::string &t) { return c.text < t; });
+    for (; it != components_.end() && it->text == text; ++it)
+      if (it->dir)
+        ids.push_back(it->id);
+  }
+
+  void add_component_prefix(const std::string &prefix,
+                            std::vector<std::uint32_t> &ids) const {
+    auto it = std::lower_bound(
+        components_.begin(), components_.end(), prefix,
+        [](const Component &c, const std::string &t) { return c.text < t; });
+    for (; it != components_.end() &&
+           it->text.substr(0, prefix.size()) == prefix;
+         ++it)
+      ids.push_back(it->id);
+  }
+
+  std::vector<std::string> claim_ids(std::vector<std::uint32_t> &ids) {
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    std::vector<std::string> out;
+    for (auto id : ids)
+      if (!headers_.claimed(id))
+        out.push_back(headers_.claim(id));
+    return out;
+  }
+
+  template <class Pred> std::vector<std::string> claim_linear(Pred match) {
+    std::vector<std::string> out;
+    for (auto i = headers_.find(0); i < headers_.items.size();
+         i = headers_.find(i + 1))
+      if (match(i))
+        out.push_back(headers_.claim(i));
+    return out;
+  }
+
+  Pool headers_;
+  Pool libs_;
+  std::vector<std::string_view> lower_; ///< Lowercase view per header.
+  std::deque<std::string> lowered_;     ///< Storage of lowercased paths.
+  std::vector<Component> components_;
+  std::vector<std::pair<std::string, std::uint32_t>> lib_stems_;
+  std::unordered_map<std::uint32_t, std::uint32_t> trigram_slots_;
+  std::vector<std::uint32_t> posting_offsets_; ///< Per slot (+ end).
+  std::vector<std::uint32_t> postings_;        ///< Header ids, per slot.
+  bool trigrams_built_ = false;
+};
+
+} // namespace depdiscover
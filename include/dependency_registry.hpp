@@ -0,0 +1,289 @@
+/**
+ * SPDX-FileComment: Dependency Registry
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file dependency_registry.hpp
+ * @brief Indexed lookups for merging manifest entries and system libraries.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "types.hpp"
+
+namespace depdiscover {
+
+namespace registry_detail {
+
+inline std::string ascii_lower(std::string_view s) {
+  std::string out(s);
+  for (auto &c : out)
+    if (c >= 'A' && c <= 'Z')
+      c = static_cast<char>(c - 'A' + 'a');
+  return out;
+}
+
+/// Package names that name the same project (after normalization).
+inline constexpr std::pair<std::string_view, std::string_view> NAME_ALIASES[] = {
+    {"crypto", "openssl"}, {"ssl", "openssl"},    {"z", "zlib"},
+    {"json", "nlohmann-json"}, {"fmtlib", "fmt"}, {"gtest", "googletest"},
+    {"gmock", "googletest"},
+};
+
+} // namespace registry_detail
+
+/**
+ * @brief Normalizes a dependency name to its merge key.
+ *
+ * Rules, applied in order:
+ * 1. ASCII lower case (`ZLIB` -> `zlib`).
+ * 2. CMake namespaces keep the package part (`CURL::libcurl` -> `curl`).
+ * 3. `_` and `-` are equivalent (`nlohmann_json` -> `nlohmann-json`).
+ * 4. A leading `lib` is dropped if a name remains (`libcurl` -> `curl`).
+ * 5. Development package suffixes are dropped (`zlib1g-dev` -> `zlib1g`).
+ * 6. Aliases map to one canonical name (`ssl`, `crypto` -> `openssl`).
+ *
+ * @param name The name from a manifest, libs.txt or FetchContent.
+ * @return std::string The merge key.
+ */
+inline std::string normalize_dependency_name(std::string_view name) {
+  std::string key = registry_detail::ascii_lower(name);
+  if (auto ns = key.find("::"); ns != std::string::npos && ns > 0)
+    key.resize(ns);
+  std::replace(key.begin(), key.end(), '_', '-');
+  if (key.size() > 3 && key.starts_with("lib"))
+    key.erase(0, 3);
+  for (std::string_view suffix : {"-devel", "-dev"})
+    if (key.size() > suffix.size() && key.ends_with(suffix))
+      key.resize(key.size() - suffix.size());
+  for (const auto &[alias, canonical] : registry_detail::NAME_ALIASES)
+    if (key == alias)
+      return std::string(canonical);
+  return key;
+}
+
+/**
+ * @brief Name index answering "first name containing or contained in x".
+ *
+ * Names get ascending indices as they are added. Names contained in the
+ * needle are found by looking up every substring of the needle; names
+ * containing the needle through the posting list of the needle's rarest
+ * trigram (needles shorter than three characters fall back to a scan).
+ */
+class NameContainmentIndex {
+public:
+  static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+  /**
+   * @brief Adds the name with the next index.
+   */
+  void add(std::string name) {
+    auto index = static_cast<std::uint32_t>(names_.size());
+    names_.push_back(std::move(name));
+    std::string_view n = names_.back();
+    first_.try_emplace(n, index);
+    for (std::size_t i = 0; i + 3 <= n.size(); ++i) {
+      auto &list = postings_[trigram(n, i)];
+      if (list.empty() || list.back() != index)
+        list.push_back(index);
+    }
+  }
+
+  /**
+   * @brief Returns the lowest index whose name contains the needle or is
+   * contained in it (npos if none).
+   */
+  std::size_t first_related(std::string_view needle) const {
+    std::size_t best = npos;
+
+    // Names contained in the needle (including the needle itself)
+    for (std::size_t i = 0; i <= needle.size(); ++i)
+      for (std::size_t len = (i == 0 ? 0 : 1); i + len <= needle.size(); ++len) {
+        auto it = first_.find(needle.substr(i, len));
+        if (it != first_.end())
+          best = std::min<std::size_t>(best, it->second);
+      }
+
+    // Names containing the needle
+    if (needle.size() < 3) {
+      for (std::size_t k = 0; k < names_.size() && k < best; ++k)
+        if (names_[k].find(needle) != std::string::npos)
+          return k;
+      return best;
+    }
+    const std::vector<std::uint32_t> *rarest = nullptr;
+    for (std::size_t i = 0; i + 3 <= needle.size(); ++i) {
+      auto it = postings_.find(trigram(needle, i));
+      if (it == postings_.end())
+        return best; // no name has this trigram
+      if (!rarest || it->second.size() < rarest->size())
+        rarest = &it->second;
+    }
+    for (std::uint32_t k : *rarest) {
+      if (k >= best)
+        break;
+      if (names_[k].find(needle) != std::string::npos)
+        return k;
+    }
+    return best;
+  }
+
+private:
+  static std::uint32_t trigram(std::string_view s, std::size_t i) {
+    return (std::uint32_t(static_cast<unsigned char>(s[i])) << 16) |
+           (std::uint32_t(static_cast<unsigned char>(s[i + 1])) << 8) |
+           std::uint32_t(static_cast<unsigned char>(s[i + 2]));
+  }
+
+  std::deque<std::string> names_; ///< Stable storage for the views.
+  std::unordered_map<std::string_view, std::uint32_t> first_;
+  std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> postings_;
+};
+
+/**
+ * @brief Index over the dependency list while manifests are merged.
+ *
+ * find() applies the merge rules in this order and returns the first
+ * matching dependency in list order:
+ * 1. Same normalize_dependency_name() key.
+ * 2. One name contains the other: case-sensitive for libs.txt targets,
+ *    case-insensitive for FetchContent entries (the former linear rules).
+ *
+ * The registry keeps referring to the given vector; dependencies must be
+ * added through add() so the index stays complete.
+ */
+class DependencyRegistry {
+public:
+  /// How names are compared by the containment fallback.
+  enum class Match { CaseSensitive, CaseInsensitive };
+
+  /**
+   * @brief Indexes the existing dependencies.
+   *
+   * @param deps The dependency list (must outlive the registry).
+   */
+  explicit DependencyRegistry(std::vector<Dependency> &deps) : deps_(deps) {
+    for (std::size_t i = 0; i < deps_.size(); ++i)
+      index(deps_[i]);
+  }
+
+  /**
+   * @brief Returns the dependency a new entry merges into.
+   *
+   * @param name The entry's name.
+   * @param match Comparison of the containment fallback.
+   * @return Dependency* The dependency, or nullptr if the entry is new
+   * (valid until the next add()).
+   */
+  Dependency *find(const std::string &name, Match match) {
+    auto key = keys_.find(normalize_dependency_name(name));
+    if (key != keys_.end())
+      return &deps_[key->second];
+    std::size_t i =
+        match == Match::CaseSensitive
+            ? exact_.first_related(name)
+            : folded_.first_related(registry_detail::ascii_lower(name));
+    return i == NameContainmentIndex::npos ? nullptr : &deps_[i];
+  }
+
+  /**
+   * @brief Appends a dependency and indexes it.
+   */
+  void add(Dependency dep) {
+    deps_.push_back(std::move(dep));
+    index(deps_.back());
+  }
+
+private:
+  void index(const Dependency &dep) {
+    keys_.try_emplace(normalize_dependency_name(dep.name), indexed_++);
+    exact_.add(dep.name);
+    folded_.add(registry_detail::ascii_lower(dep.name));
+  }
+
+  std::vector<Dependency> &deps_;
+  std::size_t indexed_ = 0;
+  std::unordered_map<std::string, std::size_t> keys_;
+  NameContainmentIndex exact_;
+  NameContainmentIndex folded_;
+};
+
+/**
+ * @brief Answers whether a library is already accounted for by a list of
+ * dependencies (step 4 of the scan: leftover ELF libraries).
+ *
+ * A library is accounted for if a dependency lists it, lists a path that
+ * contains `/<lib>`, is named in `<lib>` after a `/`, or if the library
+ * name (without `lib` prefix) starts with the dependency name (without
+ * `lib` prefix). Each check is a hash or ordered-set lookup instead of a
+ * pass over all dependencies.
+ */
+class LibraryIndex {
+public:
+  /**
+   * @brief Adds the libraries and the name of a dependency.
+   */
+  void add(const Dependency &dep) {
+    for (const auto &lib : dep.libraries) {
+      libraries_.insert(lib);
+      for (std::size_t p = lib.find('/'); p != std::string::npos;
+           p = lib.find('/', p + 1))
+        after_slash_.insert(lib.substr(p + 1));
+    }
+    package_stems_.insert(stem(dep.name));
+  }
+
+  /**
+   * @brief True if the library is accounted for.
+   */
+  bool accounts_for(const std::string &lib) const {
+    if (libraries_.contains(lib))
+      return true;
+    // A listed path contains "/<lib>"
+    auto it = after_slash_.lower_bound(lib);
+    if (it != after_slash_.end() && it->starts_with(lib))
+      return true;
+    // "<lib>" contains "/<listed>"
+    for (std::size_t p = lib.find('/'); p != std::string::npos;
+         p = lib.find('/', p + 1))
+      for (std::size_t len = 0; p + 1 + len <= lib.size(); ++len)
+        if (libraries_.contains(lib.substr(p + 1, len)))
+          return true;
+    // Library name starts with the package name
+    std::string s = stem(lib);
+    for (std::size_t len = 0; len <= s.size(); ++len)
+      if (package_stems_.contains(s.substr(0, len)))
+        return true;
+    return false;
+  }
+
+private:
+  static std::string stem(const std::string &name) {
+    return name.rfind("lib", 0) == 0 ? name.substr(3) : name;
+  }
+
+  std::unordered_set<std::string> libraries_;
+  std::set<std::string> after_slash_;
+  std::unordered_set<std::string> package_stems_;
+};
+
+} // namespace depdiscover
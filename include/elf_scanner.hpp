@@ -1,5 +1,5 @@
 /**
- * SPDX-FileComment: Minimal ELF64 Scanner
+ * SPDX-FileComment: Minimal ELF Scanner
  * SPDX-FileType: SOURCE
  * SPDX-FileContributor: ZHENG Robert
  * SPDX-FileCopyrightText: 2026 ZHENG Robert
@@ -7,8 +7,8 @@
  *
  * @file elf_scanner.hpp
  * @brief Scans ELF binaries for dependencies (DT_NEEDED) without external libelf dependency.
- * @version 1.0.0
- * @date 2026-02-18
+ * @version 2.0.0
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -16,94 +16,219 @@
  * @license MIT License
  */
 #pragma once
+#include "file_reader.hpp"
+#include "thread_pool.hpp"
 #include <algorithm>
 #include <cstdint>
-#include <cstring>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
-#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <glob.h>
+#include <sys/stat.h>
+#endif
+
 namespace depdiscover {
 
-// --- Minimal ELF64 structures (to avoid <elf.h> dependency) ---
+namespace fs = std::filesystem;
 
-using Elf64_Addr = uint64_t;
-using Elf64_Off = uint64_t;
-using Elf64_Half = uint16_t;
-using Elf64_Word = uint32_t;
-using Elf64_Xword = uint64_t;
+// ELF Constants (to avoid <elf.h> dependency)
+constexpr uint32_t PT_LOAD = 1;
+constexpr uint32_t PT_DYNAMIC = 2;
+constexpr uint64_t DT_NULL = 0;
+constexpr uint64_t DT_NEEDED = 1;
+constexpr uint64_t DT_STRTAB = 5;
+constexpr uint64_t DT_STRSZ = 10;
+constexpr uint64_t DT_SONAME = 14;
+constexpr uint64_t DT_RPATH = 15;
+constexpr uint64_t DT_RUNPATH = 29;
 
 /**
- * @brief ELF64 File Header structure.
+ * @brief The dynamic-linking information of an ELF file.
  */
-struct Elf64_Ehdr {
-  unsigned char e_ident[16]; ///< Magic number and other info.
-  Elf64_Half e_type;         ///< Object file type.
-  Elf64_Half e_machine;      ///< Architecture.
-  Elf64_Word e_version;      ///< Object file version.
-  Elf64_Addr e_entry;        ///< Entry point virtual address.
-  Elf64_Off e_phoff;         ///< Program header table file offset.
-  Elf64_Off e_shoff;         ///< Section header table file offset.
-  Elf64_Word e_flags;        ///< Processor-specific flags.
-  Elf64_Half e_ehsize;       ///< ELF header size in bytes.
-  Elf64_Half e_phentsize;    ///< Program header table entry size.
-  Elf64_Half e_phnum;        ///< Number of program header table entries.
-  Elf64_Half e_shentsize;    ///< Section header table entry size.
-  Elf64_Half e_shnum;        ///< Number of section header table entries.
-  Elf64_Half e_shstrndx;     ///< Section header table index of the entry associated with the section name string table.
+struct ElfInfo {
+  bool valid = false;                ///< True if the file is an ELF file.
+  uint8_t elf_class = 0;             ///< 1 = ELF32, 2 = ELF64.
+  uint16_t machine = 0;              ///< e_machine (architecture).
+  std::string soname;                ///< DT_SONAME.
+  std::vector<std::string> needed;   ///< DT_NEEDED entries in order.
+  std::vector<std::string> rpath;    ///< DT_RPATH directories (unexpanded).
+  std::vector<std::string> runpath;  ///< DT_RUNPATH directories (unexpanded).
 };
 
+namespace elf_detail {
+
 /**
- * @brief ELF64 Program Header structure.
+ * @brief Bounds-checked, endian- and class-aware field reader.
  */
-struct Elf64_Phdr {
-  Elf64_Word p_type;    ///< Segment type.
-  Elf64_Word p_flags;   ///< Segment flags.
-  Elf64_Off p_offset;   ///< Segment file offset.
-  Elf64_Addr p_vaddr;   ///< Segment virtual address.
-  Elf64_Addr p_paddr;   ///< Segment physical address.
-  Elf64_Xword p_filesz; ///< Segment size in file.
-  Elf64_Xword p_memsz;  ///< Segment size in memory.
-  Elf64_Xword p_align;  ///< Segment alignment.
+struct Reader {
+  std::string_view buf;
+  bool is64 = true;
+  bool big_endian = false;
+  bool ok = true;
+
+  uint64_t read(uint64_t off, unsigned size) {
+    if (off > buf.size() || size > buf.size() - off) {
+      ok = false;
+      return 0;
+    }
+    uint64_t v = 0;
+    for (unsigned i = 0; i < size; ++i) {
+      unsigned idx = big_endian ? i : size - 1 - i;
+      v = (v << 8) | static_cast<unsigned char>(buf[off + idx]);
+    }
+    return v;
+  }
+  uint64_t u16(uint64_t off) { return read(off, 2); }
+  uint64_t u32(uint64_t off) { return read(off, 4); }
+  uint64_t word(uint64_t off) { return read(off, is64 ? 8 : 4); }
 };
 
-/**
- * @brief ELF64 Dynamic Entry structure (found in .dynamic section).
- */
-struct Elf64_Dyn {
-  Elf64_Xword d_tag; ///< Entry type (e.g., DT_NEEDED).
-  union {
-    Elf64_Xword d_val;
-    Elf64_Addr d_ptr;
-  } d_un;
+struct Segment {
+  uint64_t type, offset, vaddr, filesz, memsz;
 };
 
-// ELF Constants
-constexpr uint32_t PT_LOAD = 1;
-constexpr uint32_t PT_DYNAMIC = 2;
-constexpr uint64_t DT_NEEDED = 1;
-constexpr uint64_t DT_STRTAB = 5;
-constexpr uint64_t DT_STRSZ = 10;
+inline std::vector<std::string> split_path_list(const std::string &s) {
+  std::vector<std::string> out;
+  std::size_t start = 0;
+  while (start <= s.size()) {
+    std::size_t end = s.find(':', start);
+    if (end == std::string::npos)
+      end = s.size();
+    if (end > start)
+      out.push_back(s.substr(start, end - start));
+    start = end + 1;
+  }
+  return out;
+}
+
+} // namespace elf_detail
 
 /**
- * @brief Converts a virtual memory address (VMA) to a file offset.
+ * @brief Parses the dynamic section of an ELF file.
  *
- * @param vaddr The virtual address.
- * @param phdrs A list of program headers to search in.
- * @return uint64_t The calculated file offset, or 0 if not found.
+ * Supports ELF32 and ELF64 in little- and big-endian byte order. All reads
+ * are bounds-checked against the buffer.
+ *
+ * @param data The file content.
+ * @return ElfInfo The parsed information (valid = false if not ELF).
  */
-inline uint64_t vaddr_to_offset(Elf64_Addr vaddr,
-                                const std::vector<Elf64_Phdr> &phdrs) {
-  for (const auto &ph : phdrs) {
-    if (ph.p_type == PT_LOAD) {
-      // Check if the VMA lies within this segment
-      if (vaddr >= ph.p_vaddr && vaddr < (ph.p_vaddr + ph.p_memsz)) {
-        return vaddr - ph.p_vaddr + ph.p_offset;
-      }
+inline ElfInfo parse_elf(std::string_view data) {
+  ElfInfo info;
+  // Check Magic Bytes: 0x7F 'E' 'L' 'F'
+  if (data.size() < 16 || data[0] != 0x7F || data[1] != 'E' ||
+      data[2] != 'L' || data[3] != 'F')
+    return info;
+
+  const auto cls = static_cast<uint8_t>(data[4]);
+  const auto enc = static_cast<uint8_t>(data[5]);
+  if ((cls != 1 && cls != 2) || (enc != 1 && enc != 2))
+    return info;
+
+  elf_detail::Reader r{data, cls == 2, enc == 2};
+  info.valid = true;
+  info.elf_class = cls;
+  info.machine = static_cast<uint16_t>(r.u16(18));
+
+  // Program headers
+  const uint64_t phoff = r.is64 ? r.read(32, 8) : r.u32(28);
+  const uint64_t phentsize = r.u16(r.is64 ? 54 : 42);
+  const uint64_t phnum = r.u16(r.is64 ? 56 : 44);
+  if (!r.ok || phentsize == 0)
+    return info;
+
+  std::vector<elf_detail::Segment> segs;
+  for (uint64_t i = 0; i < phnum; ++i) {
+    const uint64_t p = phoff + i * phentsize;
+    elf_detail::Segment s{};
+    s.type = r.u32(p);
+    if (r.is64) {
+      s.offset = r.read(p + 8, 8);
+      s.vaddr = r.read(p + 16, 8);
+      s.filesz = r.read(p + 32, 8);
+      s.memsz = r.read(p + 40, 8);
+    } else {
+      s.offset = r.u32(p + 4);
+      s.vaddr = r.u32(p + 8);
+      s.filesz = r.u32(p + 16);
+      s.memsz = r.u32(p + 20);
+    }
+    if (!r.ok)
+      return info;
+    segs.push_back(s);
+  }
+
+  auto dyn_it = std::find_if(segs.begin(), segs.end(), [](const auto &s) {
+    return s.type == PT_DYNAMIC;
+  });
+  if (dyn_it == segs.end())
+    return info; // Not dynamically linked
+
+  // Dynamic entries
+  const uint64_t entsize = r.is64 ? 16 : 8;
+  const unsigned wsize = r.is64 ? 8 : 4;
+  std::vector<std::pair<uint64_t, uint64_t>> dyns;
+  uint64_t strtab_vaddr = 0, strtab_size = 0;
+  for (uint64_t off = dyn_it->offset;
+       off + entsize <= dyn_it->offset + dyn_it->filesz; off += entsize) {
+    uint64_t tag = r.word(off);
+    uint64_t val = r.word(off + wsize);
+    if (!r.ok || tag == DT_NULL)
+      break;
+    if (tag == DT_STRTAB)
+      strtab_vaddr = val;
+    else if (tag == DT_STRSZ)
+      strtab_size = val;
+    else
+      dyns.emplace_back(tag, val);
+  }
+  if (strtab_vaddr == 0 || strtab_size == 0)
+    return info;
+
+  // Calculate address of String Table in file (via the PT_LOAD segments)
+  uint64_t strtab_offset = 0;
+  for (const auto &s : segs)
+    if (s.type == PT_LOAD && strtab_vaddr >= s.vaddr &&
+        strtab_vaddr < s.vaddr + s.memsz) {
+      strtab_offset = strtab_vaddr - s.vaddr + s.offset;
+      break;
+    }
+  if (strtab_offset == 0 || strtab_offset >= data.size())
+    return info;
+  std::string_view strtab =
+      data.substr(strtab_offset, std::min<uint64_t>(strtab_size,
+                                                    data.size() - strtab_offset));
+
+  auto str_at = [&strtab](uint64_t idx) -> std::string {
+    if (idx >= strtab.size())
+      return {};
+    std::string_view s = strtab.substr(idx);
+    return std::string(s.substr(0, s.find('\0')));
+  };
+
+  for (const auto &[tag, val] : dyns) {
+    if (tag == DT_NEEDED) {
+      auto name = str_at(val);
+      if (!name.empty())
+        info.needed.push_back(std::move(name));
+    } else if (tag == DT_SONAME) {
+      info.soname = str_at(val);
+    } else if (tag == DT_RPATH) {
+      info.rpath = elf_detail::split_path_list(str_at(val));
+    } else if (tag == DT_RUNPATH) {
+      info.runpath = elf_detail::split_path_list(str_at(val));
     }
   }
-  return 0; // Not found
+  return info;
 }
 
 /**
@@ -116,99 +241,342 @@ inline uint64_t vaddr_to_offset(Elf64_Addr vaddr,
  */
 inline std::vector<std::string>
 scan_elf_dependencies(const std::string &binary_path) {
-  std::vector<std::string> dependencies;
-  std::ifstream file(binary_path, std::ios::binary);
+  MappedFile file(binary_path);
+  if (!file.is_open())
+    return {};
+  return parse_elf(file.view()).needed;
+}
 
-  if (!file)
-    return dependencies;
+/**
+ * @brief Reads the library directories configured in ld.so.conf.
+ *
+ * Follows `include` directives (glob patterns, relative to the including
+ * file); `hwcap` lines and comments are ignored.
+ *
+ * @param conf The configuration file (default: /etc/ld.so.conf).
+ * @param depth Include nesting (guards against include cycles).
+ * @return std::vector<std::string> The directories in configuration order.
+ */
+inline std::vector<std::string>
+read_ld_so_conf(const fs::path &conf = "/etc/ld.so.conf", int depth = 0) {
+  std::vector<std::string> dirs;
+  std::ifstream f(conf);
+  if (!f || depth > 8)
+    return dirs;
 
-  // 1. Read ELF Header
-  Elf64_Ehdr ehdr;
-  file.read(reinterpret_cast<char *>(&ehdr), sizeof(ehdr));
-  if (!file)
-    return dependencies;
+  std::string line;
+  while (std::getline(f, line)) {
+    if (auto hash = line.find('#'); hash != std::string::npos)
+      line.erase(hash);
+    auto b = line.find_first_not_of(" \t\r");
+    if (b == std::string::npos)
+      continue;
+    line = line.substr(b, line.find_last_not_of(" \t\r") - b + 1);
 
-  // Check Magic Bytes: 0x7F 'E' 'L' 'F'
-  if (ehdr.e_ident[0] != 0x7F || ehdr.e_ident[1] != 'E' ||
-      ehdr.e_ident[2] != 'L' || ehdr.e_ident[3] != 'F') {
-    return dependencies; // Not an ELF file
+    if (line.rfind("include", 0) == 0 && line.size() > 7 &&
+        (line[7] == ' ' || line[7] == '\t')) {
+      std::string pattern = line.substr(line.find_first_not_of(" \t", 7));
+      if (!pattern.empty() && pattern[0] != '/')
+        pattern = (conf.parent_path() / pattern).string();
+#if defined(__unix__) || defined(__APPLE__)
+      glob_t g{};
+      if (::glob(pattern.c_str(), 0, nullptr, &g) == 0) {
+        for (std::size_t i = 0; i < g.gl_pathc; ++i) {
+          auto more = read_ld_so_conf(g.gl_pathv[i], depth + 1);
+          dirs.insert(dirs.end(), more.begin(), more.end());
+        }
+      }
+      ::globfree(&g);
+#endif
+    } else if (line.rfind("hwcap", 0) != 0) {
+      dirs.push_back(line);
+    }
+  }
+  return dirs;
+}
+
+/**
+ * @brief Scans several ELF binaries, optionally with their transitive
+ * library closure.
+ *
+ * Every ELF file is mapped and parsed exactly once (memoized by device and
+ * inode, so hard links and symlinks share one entry). DT_NEEDED entries are
+ * resolved like the dynamic loader: DT_RPATH of the object and its loaders
+ * (only without DT_RUNPATH), DT_RUNPATH, the ld.so.conf directories and the
+ * default directories, accepting only libraries of the same ELF class and
+ * machine. `$ORIGIN` is expanded and resolutions are cached per soname,
+ * ELF class/machine and search path. Independent binaries are scanned in
+ * parallel. Thread-safe.
+ */
+class ElfScanner {
+public:
+  /**
+   * @brief Creates a scanner.
+   *
+   * @param closure If true, follow resolved libraries transitively;
+   * otherwise only the direct DT_NEEDED entries are reported.
+   */
+  explicit ElfScanner(bool closure) : closure_(closure) { load_search_dirs(); }
+
+  /**
+   * @brief Expands directories into the ELF files they contain.
+   *
+   * @param inputs Files and/or directories.
+   * @return std::vector<std::string> The ELF files (sorted per directory).
+   */
+  std::vector<std::string> expand_inputs(const std::vector<std::string> &inputs) {
+    std::vector<std::string> files;
+    for (const auto &in : inputs) {
+      std::error_code ec;
+      if (!fs::is_directory(in, ec)) {
+        files.push_back(in);
+        continue;
+      }
+      std::vector<std::string> found;
+      for (auto it = fs::recursive_directory_iterator(
+               in, fs::directory_options::skip_permission_denied, ec);
+           it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (ec)
+          break;
+        if (it->is_regular_file(ec) && !it->is_symlink(ec) &&
+            load(it->path().string())->valid)
+          found.push_back(it->path().string());
+      }
+      std::sort(found.begin(), found.end());
+      files.insert(files.end(), found.begin(), found.end());
+    }
+    return files;
   }
 
-  // Check Class (e_ident[4]): 2 = 64-bit. Only 64-bit supported here for simplicity.
-  if (ehdr.e_ident[4] != 2) {
-    return dependencies;
+  /**
+   * @brief Scans the given ELF files.
+   *
+   * @param binaries The ELF files.
+   * @param pool The pool to scan independent binaries on.
+   * @return std::set<std::string> The required library names.
+   */
+  std::set<std::string> scan(const std::vector<std::string> &binaries,
+                             ThreadPool &pool) {
+    auto partial = pool.parallel_chunks<std::set<std::string>>(
+        binaries.size(), [&](std::size_t begin, std::size_t end) {
+          std::set<std::string> libs;
+          for (std::size_t i = begin; i < end; ++i)
+            scan_one(binaries[i], libs);
+          return libs;
+        });
+    std::set<std::string> all;
+    for (auto &p : partial)
+      all.merge(p);
+    return all;
   }
 
-  // 2. Read Program Headers
-  file.seekg(ehdr.e_phoff);
-  std::vector<Elf64_Phdr> phdrs(ehdr.e_phnum);
-  file.read(reinterpret_cast<char *>(phdrs.data()),
-            ehdr.e_phnum * sizeof(Elf64_Phdr));
+  /**
+   * @brief Starts a new run of a long-lived scanner: soname lookups and
+   * counters are reset, parsed files stay memoized (and are re-parsed if
+   * their size or mtime changed).
+   */
+  void begin_run() {
+    std::lock_guard lock(mutex_);
+    resolved_.clear();
+    unresolved_.clear();
+    parsed_ = 0;
+    load_search_dirs();
+  }
 
-  // 3. Find Dynamic Segment
-  Elf64_Phdr *dyn_phdr = nullptr;
-  for (auto &ph : phdrs) {
-    if (ph.p_type == PT_DYNAMIC) {
-      dyn_phdr = &ph;
-      break;
+  /**
+   * @brief Number of ELF files parsed in this run.
+   */
+  std::size_t parsed_count() {
+    std::lock_guard lock(mutex_);
+    return parsed_;
+  }
+
+  /**
+   * @brief Number of DT_NEEDED entries that could not be resolved.
+   */
+  std::size_t unresolved_count() {
+    std::lock_guard lock(mutex_);
+    return unresolved_.size();
+  }
+
+private:
+  using Key = std::pair<uint64_t, uint64_t>;
+
+  void load_search_dirs() {
+    search_dirs_.clear();
+    if (!closure_)
+      return;
+    search_dirs_ = read_ld_so_conf();
+    for (const char *d : {"/lib64", "/usr/lib64", "/lib", "/usr/lib"})
+      search_dirs_.push_back(d);
+  }
+
+  /**
+   * @brief Returns the (memoized) parse result of a file.
+   */
+  std::shared_ptr<const ElfInfo> load(const std::string &path) {
+    FileStamp stamp;
+    Key key = file_key(path, &stamp);
+    {
+      std::lock_guard lock(mutex_);
+      if (auto it = by_inode_.find(key);
+          it != by_inode_.end() && it->second.size == stamp.size &&
+          it->second.mtime == stamp.mtime)
+        return it->second.info;
     }
+    auto info = std::make_shared<ElfInfo>();
+    MappedFile file(path);
+    if (file.is_open())
+      *info = parse_elf(file.view());
+
+    std::lock_guard lock(mutex_);
+    ++parsed_;
+    by_inode_[key] = Parsed{info, stamp.size, stamp.mtime};
+    return info;
   }
 
-  if (!dyn_phdr)
-    return dependencies; // Not dynamically linked
+  Key file_key(const std::string &path, FileStamp *stamp = nullptr) {
+#if defined(__unix__) || defined(__APPLE__)
+    struct stat st {};
+    if (::stat(path.c_str(), &st) == 0) {
+      if (stamp) {
+        stamp->size = static_cast<std::uint64_t>(st.st_size);
+#if defined(__APPLE__)
+        stamp->mtime = std::int64_t(st.st_mtimespec.tv_sec) * 1000000000 +
+                       st.st_mtimespec.tv_nsec;
+#else
+        stamp->mtime =
+            std::int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+      }
+      return {static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)};
+    }
+#endif
+    // No inode: key by canonical path
+    if (stamp)
+      stat_file(path, *stamp);
+    std::error_code ec;
+    auto canon = fs::weakly_canonical(path, ec).string();
+    std::lock_guard lock(mutex_);
+    auto [it, inserted] = path_keys_.try_emplace(canon, path_keys_.size());
+    return {~uint64_t{0}, it->second};
+  }
 
-  // 4. Read Dynamic Entries
-  size_t num_dyns = dyn_phdr->p_filesz / sizeof(Elf64_Dyn);
-  std::vector<Elf64_Dyn> dyns(num_dyns);
+  static std::string expand_origin(std::string dir, const std::string &origin) {
+    for (const char *token : {"${ORIGIN}", "$ORIGIN"}) {
+      std::size_t pos;
+      while ((pos = dir.find(token)) != std::string::npos)
+        dir.replace(pos, std::string_view(token).size(), origin);
+    }
+    return dir;
+  }
+
+  /**
+   * @brief Resolves a DT_NEEDED entry to a file path ("" if not found).
+   */
+  std::string resolve(const std::string &name, const ElfInfo &requester,
+                      const std::string &origin,
+                      const std::vector<std::string> &inherited_rpath) {
+    auto compatible = [&](const std::string &candidate) {
+      std::error_code ec;
+      if (!fs::is_regular_file(candidate, ec))
+        return false;
+      auto info = load(candidate);
+      return info->valid && info->elf_class == requester.elf_class &&
+             info->machine == requester.machine;
+    };
 
-  file.seekg(dyn_phdr->p_offset);
-  file.read(reinterpret_cast<char *>(dyns.data()), dyn_phdr->p_filesz);
+    if (name.find('/') != std::string::npos)
+      return compatible(name) ? name : std::string{};
 
-  // 5. Find String Table (DT_STRTAB)
-  Elf64_Addr strtab_vaddr = 0;
-  Elf64_Xword strtab_size = 0;
+    std::vector<std::string> dirs;
+    std::string cache_key = name + '\0' + std::to_string(requester.elf_class) +
+                            '\0' + std::to_string(requester.machine);
+    if (requester.runpath.empty()) {
+      for (const auto &d : requester.rpath)
+        dirs.push_back(expand_origin(d, origin));
+      dirs.insert(dirs.end(), inherited_rpath.begin(), inherited_rpath.end());
+    } else {
+      for (const auto &d : requester.runpath)
+        dirs.push_back(expand_origin(d, origin));
+    }
+    // Soname cache: same name, class/machine and object-specific dirs
+    for (const auto &d : dirs)
+      cache_key += '\0' + d;
+    {
+      std::lock_guard lock(mutex_);
+      if (auto it = resolved_.find(cache_key); it != resolved_.end())
+        return it->second;
+    }
+    dirs.insert(dirs.end(), search_dirs_.begin(), search_dirs_.end());
 
-  for (const auto &dyn : dyns) {
-    if (dyn.d_tag == DT_STRTAB)
-      strtab_vaddr = dyn.d_un.d_ptr;
-    if (dyn.d_tag == DT_STRSZ)
-      strtab_size = dyn.d_un.d_val;
+    std::string found;
+    for (const auto &d : dirs) {
+      std::string candidate = (fs::path(d) / name).string();
+      if (compatible(candidate)) {
+        found = std::move(candidate);
+        break;
+      }
+    }
+    std::lock_guard lock(mutex_);
+    resolved_.try_emplace(std::move(cache_key), found);
+    return found;
   }
 
-  if (strtab_vaddr == 0 || strtab_size == 0)
-    return dependencies;
-
-  // Calculate address of String Table in file
-  uint64_t strtab_offset = vaddr_to_offset(strtab_vaddr, phdrs);
-  if (strtab_offset == 0)
-    return dependencies;
-
-  // 6. Load String Table into memory
-  std::vector<char> strtab(strtab_size);
-  file.seekg(strtab_offset);
-  file.read(strtab.data(), strtab_size);
-
-  // 7. Extract dependencies (DT_NEEDED)
-  for (const auto &dyn : dyns) {
-    if (dyn.d_tag == DT_NEEDED) {
-      // d_val is the index into the String Table
-      if (dyn.d_un.d_val < strtab_size) {
-        // Safe string extraction: find the null-terminator within the remaining buffer
-        const char *start = &strtab[dyn.d_un.d_val];
-        size_t max_len = strtab_size - dyn.d_un.d_val;
-        size_t actual_len = 0;
-        while (actual_len < max_len && start[actual_len] != '\0') {
-          actual_len++;
-        }
-        if (actual_len > 0) {
-          std::string lib_name(start, actual_len);
-          dependencies.push_back(lib_name);
+  void scan_one(const std::string &binary, std::set<std::string> &libs) {
+    auto root = load(binary);
+    if (!root->valid)
+      return;
+    if (!closure_) {
+      libs.insert(root->needed.begin(), root->needed.end());
+      return;
+    }
+
+    struct Node {
+      std::string path;
+      std::shared_ptr<const ElfInfo> info;
+      std::vector<std::string> rpath_chain; // DT_RPATH of all loaders
+    };
+    std::set<Key> visited{file_key(binary)};
+    std::vector<Node> queue{{binary, root, {}}};
+
+    // Breadth-first, like the loader's search order
+    for (std::size_t q = 0; q < queue.size(); ++q) {
+      Node node = queue[q];
+      std::string origin = fs::path(node.path).parent_path().string();
+      std::vector<std::string> chain = node.rpath_chain;
+      if (node.info->runpath.empty())
+        for (const auto &d : node.info->rpath)
+          chain.push_back(expand_origin(d, origin));
+
+      for (const auto &name : node.info->needed) {
+        libs.insert(fs::path(name).filename().string());
+        std::string path = resolve(name, *node.info, origin, node.rpath_chain);
+        if (path.empty()) {
+          std::lock_guard lock(mutex_);
+          unresolved_.insert(name);
+          continue;
         }
+        if (visited.insert(file_key(path)).second)
+          queue.push_back({path, load(path), chain});
       }
     }
   }
 
-  return dependencies;
-}
+  bool closure_;
+  std::vector<std::string> search_dirs_;
+  std::mutex mutex_;
+  struct Parsed {
+    std::shared_ptr<const ElfInfo> info;
+    std::uint64_t size;
+    std::int64_t mtime;
+  };
+
+  std::map<Key, Parsed> by_inode_;
+  std::size_t parsed_ = 0;
+  std::map<std::string, uint64_t> path_keys_;
+  std::set<std::string> unresolved_;
+  std::map<std::string, std::string> resolved_;
+};
 
 } // namespace depdiscover
@@ -0,0 +1,265 @@
+/**
+ * SPDX-FileComment: Zero-Copy File Reader
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file file_reader.hpp
+ * @brief Memory-mapped file access handing out std::string_view buffers.
+ * @version 1.1.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace depdiscover {
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Fingerprint of a file or directory.
+ *
+ * Size and modification time are the fast check; `hash` (file content, or
+ * the sorted entry names of a directory) is only filled by callers that
+ * need to tell touched from modified files.
+ */
+struct FileStamp {
+  bool exists = false;
+  bool dir = false;
+  std::uint64_t size = 0;
+  std::int64_t mtime = 0; ///< Nanoseconds since the epoch.
+  std::uint64_t hash = 0;
+};
+
+/**
+ * @brief Reads size, type and modification time of a path (one stat()).
+ *
+ * @param path The file or directory.
+ * @param st Receives the stamp (hash untouched).
+ * @return true If the path exists.
+ */
+inline bool stat_file(const std::string &path, FileStamp &st) {
+#if defined(__unix__) || defined(__APPLE__)
+  struct stat sb {};
+  if (::stat(path.c_str(), &sb) != 0)
+    return false;
+  st.exists = true;
+  st.dir = S_ISDIR(sb.st_mode);
+  st.size = st.dir ? 0 : static_cast<std::uint64_t>(sb.st_size);
+#if defined(__APPLE__)
+  st.mtime = std::int64_t(sb.st_mtimespec.tv_sec) * 1000000000 +
+             sb.st_mtimespec.tv_nsec;
+#else
+  st.mtime = std::int64_t(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec;
+#endif
+  return true;
+#else
+  std::error_code ec;
+  auto status = fs::status(path, ec);
+  if (ec || !fs::exists(status))
+    return false;
+  st.exists = true;
+  st.dir = fs::is_directory(status);
+  st.size = st.dir ? 0 : fs::file_size(path, ec);
+  st.mtime = static_cast<std::int64_t>(
+      fs::last_write_time(path, ec).time_since_epoch().count());
+  return true;
+#endif
+}
+
+/**
+ * @brief Reads at most the first `max_bytes` of a regular file.
+ *
+ * A single read() in the common case; no mapping is set up, so it is
+ * cheap for many small files that are only inspected at the start.
+ *
+ * @param path The file to read.
+ * @param max_bytes The prefix length.
+ * @param out Receives the prefix (shorter for smaller files).
+ * @return true If the file is a readable regular file.
+ */
+inline bool read_file_prefix(const fs::path &path, std::size_t max_bytes,
+                             std::string &out) {
+  out.clear();
+#if defined(__unix__) || defined(__APPLE__)
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+  struct stat st {};
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    return false;
+  }
+  out.resize(max_bytes);
+  std::size_t done = 0;
+  while (done < max_bytes) {
+    ssize_t n = ::read(fd, out.data() + done, max_bytes - done);
+    if (n <= 0)
+      break;
+    done += static_cast<std::size_t>(n);
+  }
+  out.resize(done);
+  ::close(fd);
+  return true;
+#else
+  std::ifstream f(path, std::ios::binary);
+  if (!f)
+    return false;
+  out.resize(max_bytes);
+  f.read(out.data(), static_cast<std::streamsize>(max_bytes));
+  out.resize(static_cast<std::size_t>(f.gcount()));
+  return true;
+#endif
+}
+
+/**
+ * @brief Read-only view of a whole file.
+ *
+ * On POSIX systems files are opened with a single open()/fstat() pair and
+ * either memory-mapped or, below `MMAP_THRESHOLD`, read with one read()
+ * into an owned buffer (mapping small files costs more than copying them).
+ * Other systems fall back to std::ifstream. Move-only; the view stays valid
+ * for the lifetime of the object.
+ */
+class MappedFile {
+public:
+  /// Files smaller than this are read instead of mapped.
+  static constexpr std::size_t MMAP_THRESHOLD = 16 * 1024;
+
+  MappedFile() = default;
+
+  /**
+   * @brief Opens and maps (or reads) a file.
+   *
+   * @param path The file to open.
+   */
+  explicit MappedFile(const fs::path &path) { open(path); }
+
+  ~MappedFile() { release(); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+  MappedFile &operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+      release();
+      map_ = std::exchange(other.map_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      buffer_ = std::move(other.buffer_);
+      ok_ = std::exchange(other.ok_, false);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Opens a file, replacing the current content.
+   *
+   * @param path The file to open.
+   * @return true If the file is a readable regular file.
+   */
+  bool open(const fs::path &path) {
+    release();
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return false;
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+      ::close(fd);
+      return false;
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size >= MMAP_THRESHOLD) {
+      void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        ::madvise(p, size, MADV_SEQUENTIAL);
+        map_ = p;
+        size_ = size;
+        ok_ = true;
+        ::close(fd);
+        return true;
+      }
+    }
+    // Small file (or mmap failed): one read() into an owned buffer
+    buffer_.resize(size);
+    std::size_t done = 0;
+    while (done < size) {
+      ssize_t n = ::read(fd, buffer_.data() + done, size - done);
+      if (n <= 0)
+        break;
+      done += static_cast<std::size_t>(n);
+    }
+    buffer_.resize(done);
+    ::close(fd);
+    ok_ = true;
+    return true;
+#else
+    std::ifstream f(path, std::ios::binary);
+    if (!f)
+      return false;
+    buffer_.assign(std::istreambuf_iterator<char>(f),
+                   std::istreambuf_iterator<char>());
+    ok_ = true;
+    return true;
+#endif
+  }
+
+  /**
+   * @brief Checks whether a file is open.
+   */
+  bool is_open() const { return ok_; }
+
+  /**
+   * @brief Returns the file content.
+   */
+  std::string_view view() const {
+    if (map_)
+      return {static_cast<const char *>(map_), size_};
+    return buffer_;
+  }
+
+  /**
+   * @brief Returns the file size in bytes.
+   */
+  std::size_t size() const { return map_ ? size_ : buffer_.size(); }
+
+private:
+  void release() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (map_)
+      ::munmap(map_, size_);
+#endif
+    map_ = nullptr;
+    size_ = 0;
+    buffer_.clear();
+    ok_ = false;
+  }
+
+  void *map_ = nullptr;
+  std::size_t size_ = 0;
+  std::string buffer_;
+  bool ok_ = false;
+};
+
+} // namespace depdiscover
@@ -7,8 +7,8 @@
  *
  * @file header_resolver.hpp
  * @brief Scans include directives and resolves them to absolute paths.
- * @version 1.0.0
- * @date 2026-02-18
+ * @version 1.2.3
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -16,11 +16,20 @@
  * @license MIT License
  */
 #pragma once
+#include "file_reader.hpp"
+#include "include_lexer.hpp"
+#include "string_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
-#include <regex>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace depdiscover {
@@ -30,27 +39,20 @@ namespace fs = std::filesystem;
 /**
  * @brief Scans a source file for `#include` directives.
  *
+ * Uses the hand-written lexer on a memory-mapped view of the file, so
+ * commented-out includes are ignored and line continuations are honoured.
+ *
  * @param source_file The path to the source file.
+ * @param preamble_only Stop at the end of the directive preamble (see
+ * lex_include_directives()).
  * @return std::vector<std::string> A list of included header names.
  */
-inline std::vector<std::string> scan_includes(const std::string &source_file) {
-  std::vector<std::string> included_headers;
-  if (!fs::exists(source_file))
-    return {};
-
-  std::ifstream f(source_file);
-  if (!f)
+inline std::vector<std::string> scan_includes(const std::string &source_file,
+                                              bool preamble_only = false) {
+  MappedFile file(source_file);
+  if (!file.is_open())
     return {};
-
-  static const std::regex re(R"(\s*#\s*include\s*[<"]([^>"]+)[>"])");
-  std::string line;
-  while (std::getline(f, line)) {
-    std::smatch m;
-    if (std::regex_search(line, m, re)) {
-      included_headers.push_back(m[1].str());
-    }
-  }
-  return included_headers;
+  return lex_include_directives(file.view(), preamble_only);
 }
 
 /**
@@ -113,4 +115,406 @@ inline std::string resolve_header(const std::string &header_name,
   return "";
 }
 
+/**
+ * @brief Hit/miss counters of the HeaderResolveCache.
+ */
+struct HeaderCacheStats {
+  std::size_t hits = 0;          ///< Lookups answered from the memo table.
+  std::size_t misses = 0;        ///< Lookups that had to probe the file system.
+  std::size_t negative = 0;      ///< Misses that did not resolve (cached as such).
+  std::size_t path_lists = 0;    ///< Number of interned include-path lists.
+  std::size_t dir_listings = 0;  ///< Directories read into the listing cache.
+};
+
+/**
+ * @brief Memoizing front-end for resolve_header().
+ *
+ * Include-path lists (together with the working directory that relative
+ * `-I` entries are based on) are interned to a numeric ID, and every
+ * (path-list ID, header name) lookup is memoized, including negative
+ * results; names and paths are StringPool IDs, so a memo entry is two
+ * integers. File-system probes go through a per-directory listing cache, so
+ * a directory such as `/usr/include` is read once instead of being stat'ed
+ * for every candidate header. All methods are thread-safe.
+ */
+class HeaderResolveCache {
+public:
+  /**
+   * @brief Returns the process-wide cache instance.
+   */
+  static HeaderResolveCache &instance() {
+    static HeaderResolveCache cache;
+    return cache;
+  }
+
+  /**
+   * @brief Interns an include-path list.
+   *
+   * @param include_paths The -I directories of a compile command.
+   * @param work_dir The compiler working directory.
+   * @return std::uint32_t The ID of the (deduplicated) list.
+   */
+  std::uint32_t intern(const std::vector<std::string> &include_paths,
+                       const std::string &work_dir = "") {
+    std::string key = work_dir;
+    for (const auto &p : include_paths) {
+      key += '\0';
+      key += p;
+    }
+
+    {
+      std::shared_lock lock(mutex_);
+      auto it = list_ids_.find(key);
+      if (it != list_ids_.end())
+        return it->second;
+    }
+
+    // Same directory order as resolve_header(): -I paths, then system paths
+    std::vector<fs::path> dirs;
+    for (const auto &inc_str : include_paths) {
+      fs::path inc_path(inc_str);
+      if (inc_path.is_relative() && !work_dir.empty())
+        inc_path = fs::path(work_dir) / inc_path;
+      dirs.push_back(inc_path);
+    }
+    for (const auto &sys_path : system_include_paths())
+      dirs.emplace_back(sys_path);
+
+    std::unique_lock lock(mutex_);
+    auto [it, inserted] = list_ids_.try_emplace(
+        key, static_cast<std::uint32_t>(lists_.size()));
+    if (inserted)
+      lists_.push_back(std::move(dirs));
+    return it->second;
+  }
+
+  /**
+   * @brief Resolves a header against an interned include-path list.
+   *
+   * @param list_id The ID returned by intern().
+   * @param header_name The name of the header file.
+   * @return std::string The canonical path, or empty if not found.
+   */
+  std::string resolve(std::uint32_t list_id, const std::string &header_name) {
+    StringId path = resolve_id(list_id, StringPool::instance().intern(header_name));
+    return path == NO_STRING_ID ? std::string()
+                                : StringPool::instance().str(path);
+  }
+
+  /**
+   * @brief Resolves an interned header name against an include-path list.
+   *
+   * @param list_id The ID returned by intern().
+   * @param name The interned header name.
+   * @return StringId The interned canonical path, or NO_STRING_ID.
+   */
+  StringId resolve_id(std::uint32_t list_id, StringId name) {
+    std::uint64_t key = (std::uint64_t(list_id) << 32) | name;
+    StringId cached;
+    if (find_memo(list_memo_, key, cached))
+      return cached;
+
+    std::vector<fs::path> dirs;
+    {
+      std::shared_lock lock(mutex_);
+      dirs = lists_.at(list_id);
+    }
+    return store_memo(list_memo_, key, lookup(name, dirs));
+  }
+
+  /**
+   * @brief Resolves a header relative to a single directory (e.g., the
+   * directory of the including file).
+   *
+   * @param dir The directory to search in.
+   * @param header_name The name of the header file.
+   * @return std::string The canonical path, or empty if not found.
+   */
+  std::string resolve_in(const fs::path &dir, const std::string &header_name) {
+    auto &pool = StringPool::instance();
+    StringId path =
+        resolve_in_id(pool.intern(dir.string()), pool.intern(header_name));
+    return path == NO_STRING_ID ? std::string() : pool.str(path);
+  }
+
+  /**
+   * @brief Resolves an interned header name relative to one directory.
+   *
+   * @param dir The interned directory.
+   * @param name The interned header name.
+   * @return StringId The interned canonical path, or NO_STRING_ID.
+   */
+  StringId resolve_in_id(StringId dir, StringId name) {
+    std::uint64_t key = (std::uint64_t(dir) << 32) | name;
+    StringId cached;
+    if (find_memo(dir_memo_, key, cached))
+      return cached;
+    return store_memo(dir_memo_, key,
+                      lookup(name, {fs::path(StringPool::instance().view(dir))}));
+  }
+
+  /**
+   * @brief Returns the search directories of an interned include-path list.
+   *
+   * @param list_id The ID returned by intern().
+   * @return std::vector<fs::path> The directories in search order.
+   */
+  std::vector<fs::path> directories(std::uint32_t list_id) const {
+    std::shared_lock lock(mutex_);
+    return lists_.at(list_id);
+  }
+
+  /**
+   * @brief Returns the directories whose contents decide how a header name
+   * resolves against an include-path list.
+   *
+   * That is the directory of every candidate path (`<dir>/<name>`) up to
+   * and including the first one that exists, whether or not the directory
+   * exists itself. Incremental scans stamp them, so a header that appears
+   * in an earlier directory (or below a directory created later)
+   * invalidates the result. Memoized like resolve_id().
+   *
+   * @param list_id The ID returned by intern().
+   * @param name The interned header name.
+   * @return std::vector<StringId> The interned directories.
+   */
+  std::vector<StringId> probed_directories(std::uint32_t list_id,
+                                           StringId name) {
+    std::uint64_t key = (std::uint64_t(list_id) << 32) | name;
+    std::vector<fs::path> dirs;
+    {
+      std::shared_lock lock(mutex_);
+      auto it = probe_memo_.find(key);
+      if (it != probe_memo_.end())
+        return it->second;
+      dirs = lists_.at(list_id);
+    }
+
+    auto &pool = StringPool::instance();
+    fs::path p_header(pool.view(name));
+    std::vector<StringId> out;
+    std::error_code ec;
+    if (p_header.is_absolute()) {
+      out.push_back(pool.intern(p_header.parent_path().string()));
+    } else {
+      for (const auto &dir : dirs) {
+        fs::path full_p = dir / p_header;
+        out.push_back(pool.intern(full_p.parent_path().string()));
+        // Same stop condition as lookup()
+        if (may_exist(dir, p_header) && fs::exists(full_p, ec) &&
+            !fs::canonical(full_p, ec).empty())
+          break;
+      }
+    }
+    std::unique_lock lock(mutex_);
+    return probe_memo_.try_emplace(key, std::move(out)).first->second;
+  }
+
+  /**
+   * @brief Forgets every result that holds StringPool IDs (before
+   * StringPool::reset()).
+   */
+  void forget_interned() {
+    std::unique_lock lock(mutex_);
+    list_memo_.clear();
+    dir_memo_.clear();
+    probe_memo_.clear();
+  }
+
+  /**
+   * @brief Drops results that may have become stale (long-running server).
+   *
+   * Resolved headers are forgotten; directory listings are kept unless the
+   * directory was modified since it was listed. Interned include-path lists
+   * are pure and stay valid. Counters restart at zero.
+   */
+  void refresh() {
+    std::unique_lock lock(mutex_);
+    list_memo_.clear();
+    dir_memo_.clear();
+    probe_memo_.clear();
+    for (auto it = listings_.begin(); it != listings_.end();) {
+      FileStamp st;
+      stat_file(it->first, st);
+      if (st.mtime != it->second.mtime)
+        it = listings_.erase(it);
+      else
+        ++it;
+    }
+    hits_ = 0;
+    misses_ = 0;
+    negative_ = 0;
+  }
+
+  /**
+   * @brief Returns a snapshot of the cache counters.
+   */
+  HeaderCacheStats stats() const {
+    HeaderCacheStats st;
+    st.hits = hits_.load(std::memory_order_relaxed);
+    st.misses = misses_.load(std::memory_order_relaxed);
+    st.negative = negative_.load(std::memory_order_relaxed);
+    std::shared_lock lock(mutex_);
+    st.path_lists = lists_.size();
+    st.dir_listings = listings_.size();
+    return st;
+  }
+
+private:
+  /**
+   * @brief The entry names of a directory, sorted in one buffer.
+   */
+  struct DirListing {
+    std::string buffer;                 ///< All names, concatenated.
+    std::vector<std::uint32_t> offsets; ///< Start of each name (+ end).
+
+    std::string_view name(std::size_t i) const {
+      return std::string_view(buffer).substr(offsets[i],
+                                             offsets[i + 1] - offsets[i]);
+    }
+    bool contains(std::string_view n) const {
+      std::size_t lo = 0, hi = offsets.size() - 1;
+      while (lo < hi) {
+        std::size_t mid = (lo + hi) / 2;
+        if (name(mid) < n)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      return lo < offsets.size() - 1 && name(lo) == n;
+    }
+  };
+  using Listing = std::shared_ptr<const DirListing>;
+  /// (path-list or directory ID, header name ID) -> resolved path ID
+  using Memo = std::unordered_map<std::uint64_t, StringId>;
+
+  struct CachedListing {
+    Listing names;
+    std::int64_t mtime; ///< Directory mtime when listed.
+  };
+
+  static const std::vector<std::string> &system_include_paths() {
+    static const std::vector<std::string> system_paths = {
+        "/usr/include", "/usr/local/include", "/usr/include/x86_64-linux-gnu",
+        "/opt/local/include"};
+    return system_paths;
+  }
+
+  /**
+   * @brief Returns the (cached) entry names of a directory.
+   */
+  Listing listing(const fs::path &dir) {
+    std::string key = dir.string();
+    {
+      std::shared_lock lock(mutex_);
+      auto it = listings_.find(key);
+      if (it != listings_.end())
+        return it->second.names;
+    }
+
+    FileStamp st;
+    stat_file(key, st);
+    std::vector<std::string> entries;
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end;
+         it.increment(ec))
+      entries.push_back(it->path().filename().string());
+    std::sort(entries.begin(), entries.end());
+    auto names = std::make_shared<DirListing>();
+    for (const auto &e : entries) {
+      names->offsets.push_back(static_cast<std::uint32_t>(names->buffer.size()));
+      names->buffer += e;
+    }
+    names->offsets.push_back(static_cast<std::uint32_t>(names->buffer.size()));
+
+    std::unique_lock lock(mutex_);
+    return listings_
+        .try_emplace(std::move(key), CachedListing{std::move(names), st.mtime})
+        .first->second.names;
+  }
+
+  /**
+   * @brief Checks whether dir/rel may exist using only cached listings.
+   *
+   * Returns false early as soon as a path component is missing; components
+   * like "." or ".." are left to the final fs::exists() check.
+   */
+  bool may_exist(const fs::path &dir, const fs::path &rel) {
+#if defined(__APPLE__) || defined(_WIN32)
+    (void)dir;
+    (void)rel;
+    return true; // case-insensitive file systems: listings are not reliable
+#else
+    fs::path current = dir;
+    for (const auto &component : rel) {
+      std::string name = component.string();
+      if (name.empty() || name == "." || name == "..")
+        return true;
+      if (!listing(current)->contains(name))
+        return false;
+      current /= component;
+    }
+    return true;
+#endif
+  }
+
+  bool find_memo(const Memo &memo, std::uint64_t key, StringId &out) {
+    std::shared_lock lock(mutex_);
+    auto it = memo.find(key);
+    if (it == memo.end())
+      return false;
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    out = it->second;
+    return true;
+  }
+
+  StringId store_memo(Memo &memo, std::uint64_t key, StringId result) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    if (result == NO_STRING_ID)
+      negative_.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock lock(mutex_);
+    memo.try_emplace(key, result);
+    return result;
+  }
+
+  StringId lookup(StringId name, const std::vector<fs::path> &dirs) {
+    fs::path p_header(StringPool::instance().view(name));
+    std::error_code ec;
+
+    auto canonical_id = [&](const fs::path &p) {
+      std::string path = fs::canonical(p, ec).string();
+      return path.empty() ? NO_STRING_ID : StringPool::instance().intern(path);
+    };
+
+    if (p_header.is_absolute())
+      return fs::exists(p_header, ec) ? canonical_id(p_header) : NO_STRING_ID;
+
+    for (const auto &dir : dirs) {
+      if (!may_exist(dir, p_header))
+        continue;
+      fs::path full_p = dir / p_header;
+      if (!fs::exists(full_p, ec))
+        continue;
+      // An entry that cannot be canonicalized does not hide later dirs
+      StringId id = canonical_id(full_p);
+      if (id != NO_STRING_ID)
+        return id;
+    }
+    return NO_STRING_ID;
+  }
+
+  HeaderResolveCache() = default;
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, std::uint32_t> list_ids_;
+  std::vector<std::vector<fs::path>> lists_;
+  Memo list_memo_;
+  Memo dir_memo_;
+  std::unordered_map<std::uint64_t, std::vector<StringId>> probe_memo_;
+  std::unordered_map<std::string, CachedListing> listings_;
+  std::atomic<std::size_t> hits_{0};
+  std::atomic<std::size_t> misses_{0};
+  std::atomic<std::size_t> negative_{0};
+};
+
 } // namespace depdiscover
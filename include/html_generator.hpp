@@ -6,9 +6,9 @@
  * SPDX-License-Identifier: MIT
  *
  * @file html_generator.hpp
- * @brief Generates a user-friendly HTML report from the SBOM JSON data.
- * @version 1.4.0
- * @date 2026-02-22
+ * @brief Generates a user-friendly HTML report from the SBOM data.
+ * @version 1.7.0
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -19,26 +19,27 @@
 #pragma once
 #include <fstream>
 #include <iomanip>
-#include <nlohmann/json.hpp>
-#include <set>
+#include <ostream>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "report_model.hpp"
 #include "types.hpp"
 
 namespace depdiscover {
 
 /**
- * @brief Generates an HTML security report from the internal JSON representation.
-
- * @param root The root of the internal JSON data.
- * @param filepath The path where the report will be saved.
+ * @brief Writes an HTML security report to a stream, row by row.
+ *
+ * @param out The output stream.
+ * @param header The report header.
+ * @param deps The dependencies.
+ * @param model The report model of `deps`.
  */
-inline void generate_html_report(const nlohmann::json &root,
-                                 const std::string &filepath) {
-  std::ofstream out(filepath);
-  if (!out)
-    return;
-
+inline void write_html_report(std::ostream &out, const ReportHeader &header,
+                              const std::vector<Dependency> &deps,
+                              const ReportModel &model) {
   // Basic HTML template with embedded CSS
   out << "<!DOCTYPE html>\n<html lang=\"en\">\n<head>\n"
       << "<meta charset=\"UTF-8\">\n"
@@ -75,20 +76,16 @@ inline void generate_html_report(const nlohmann::json &root,
       << "</style>\n</head>\n<body>\n";
 
   // Header Metadata
-  if (root.contains("header")) {
-    auto &h = root["header"];
-    std::string proj = h.contains("project")
-                           ? h["project"].value("name", "Unknown")
-                           : "Unknown";
-    std::string date = h.value("scan_date", "Unknown");
-    out << "<h1>SBOM Security Report: " << proj << "</h1>\n";
-    out << "<div class=\"metadata\">\n"
-        << "  <strong>Scan Date:</strong> " << date << "<br>\n"
-        << "  <strong>Generator Tool:</strong> "
-        << h["tool"]["name"].get<std::string>() << " v"
-        << h["tool"]["version"].get<std::string>() << "\n"
-        << "</div>\n";
-  }
+  out << "<h1>SBOM Security Report: " << header.project_name << "</h1>\n";
+  out << "<div class=\"metadata\">\n"
+      << "  <strong>Scan Date:</strong> " << header.scan_date << "<br>\n"
+      << "  <strong>Generator Tool:</strong> " << header.tool_name << " v"
+      << header.tool_version << "\n";
+  if (model.any_vulnerability)
+    out << "  <br><strong>Vulnerabilities:</strong> "
+        << model.vulnerabilities.size() << " unique; findings: "
+        << severity_summary(model.severities) << "\n";
+  out << "</div>\n";
 
   // Table Header
   out << "<table>\n"
@@ -104,173 +101,138 @@ inline void generate_html_report(const nlohmann::json &root,
       << "  <tbody>\n";
 
   // Dependencies
-  if (root.contains("dependencies")) {
-    for (const auto &dep : root["dependencies"]) {
-      std::string name = dep.value("name", "Unknown");
-      std::string version = dep.value("version", "Unknown");
-      std::string type = dep.value("type", "Unknown");
-
-      // Format Licenses
-      std::string licenses = "";
-      if (dep.contains("licenses")) {
-        for (const auto &lic : dep["licenses"]) {
-          licenses +=
-              "<span class=\"badge\">" + lic.get<std::string>() + "</span>";
-        }
-      }
-
-      // Security Status & Fixed Versions evaluation
-      std::string sec_class = "";
-      std::string sec_text = "Unknown";
-      std::set<std::string> unique_fixes;
-
-      double max_score = 0.0;
-      int active_vulns = 0;
-
-      if (dep.contains("cves") && !dep["cves"].empty()) {
-        auto first_cve = dep["cves"][0];
-        std::string first_id = first_cve.value("id", "UNKNOWN");
-
-        if (first_id == "SAFE") {
-          sec_class = "safe";
-          sec_text = "✅ Safe";
-        } else if (first_id == "NOT-CHECKED" || first_id == "CHECK-ERROR") {
-          sec_class = "warn";
-          sec_text = "⚠️ " + first_id;
-        } else {
-          int suppressed_vulns = 0;
-
-          for (const auto &cve : dep["cves"]) {
-            if (cve.value("suppressed", false)) {
-              suppressed_vulns++;
-            } else {
-              active_vulns++;
-              double s = cve.value("score", 0.0);
-              if (s > max_score)
-                max_score = s;
-            }
-          }
-
-          if (active_vulns > 0) {
-            sec_class = "vuln";
-            sec_text = "<span class=\"vuln-title\">❌ " +
-                       std::to_string(active_vulns) + " Vulnerabilit" +
-                       (active_vulns > 1 ? "ies" : "y") + "</span>";
-          } else {
-            sec_class = "warn";
-            sec_text = "<span style=\"color:#856404; font-weight:bold;\">⚠️ " +
-                       std::to_string(suppressed_vulns) + " Suppressed</span>";
-          }
-
-          sec_text += "\n<details><summary>Show details</summary>\n<ul "
-                      "class=\"clean-list\">\n";
-
-          for (const auto &cve : dep["cves"]) {
-            std::string id = cve.value("id", "UNKNOWN");
-            std::string summary = cve.value("summary", "");
-            std::string fixed = cve.value("fixed_version", "");
-            bool is_suppressed = cve.value("suppressed", false);
-
-            if (!fixed.empty() && !is_suppressed) {
-              unique_fixes.insert(fixed);
-            }
-
-            std::string url;
-            if (id.find("CVE-") == 0) {
-              url = "https://nvd.nist.gov/vuln/detail/" + id;
-            } else if (id.find("GHSA-") == 0) {
-              url = "https://github.com/advisories/" + id;
-            } else {
-              url = "https://osv.dev/vulnerability/" + id;
-            }
-
-            std::string li_style =
-                is_suppressed ? "opacity: 0.6; text-decoration: line-through;"
-                              : "";
-            std::string reason_html = "";
-            if (is_suppressed) {
-              std::string reason = cve.value("suppression_reason",
-                                             "No reason provided.");
-              reason_html = "<br><small style=\"text-decoration: none; "
-                            "display:block; color:#666;\">↳ <i>Suppressed: " +
-                            reason + "</i></small>";
-            }
-
-            sec_text += "  <li style=\"" + li_style +
-                        "\"><a class=\"cve-link\" href=\"" + url +
-                        "\" target=\"_blank\">" + id + "</a>";
-            if (!summary.empty()) {
-              if (summary.length() > 80)
-                summary = summary.substr(0, 77) + "...";
-              sec_text += ": " + summary;
-            }
-            sec_text += reason_html + "</li>\n";
-          }
-          sec_text += "</ul>\n</details>";
-        }
-      }
-
-      // Format score badge with color
-      std::string score_html = "-";
-      if (active_vulns > 0) {
-        if (max_score > 0.0) {
-          std::stringstream stream;
-          stream << std::fixed << std::setprecision(1) << max_score;
-          std::string val = stream.str();
+  for (std::size_t i = 0; i < deps.size(); ++i) {
+    const Dependency &dep = deps[i];
+    const DependencySummary &sum = model.deps[i];
+
+    std::string sec_class = "";
+    if (sum.listed)
+      sec_class = sum.active_vulns > 0 ? "vuln" : "warn";
+    else if (!dep.cves.empty())
+      sec_class = dep.cves.front().id == "SAFE" ? "safe" : "warn";
+
+    out << "    <tr class=\"" << sec_class << "\">\n"
+        << "      <td><strong>" << dep.name << "</strong></td>\n"
+        << "      <td>" << dep.version << "</td>\n"
+        << "      <td>";
+
+    // Fixed Versions
+    if (sum.unique_fixes.empty()) {
+      out << "-";
+    } else {
+      std::size_t fix_count = sum.unique_fixes.size();
+      out << "<details><summary>" << fix_count
+          << (fix_count > 1 ? " Versions" : " Version")
+          << "</summary><ul class=\"clean-list\">";
+      for (const auto &f : sum.unique_fixes)
+        out << "<li><strong>v" << f << "</strong></li>";
+      out << "</ul></details>";
+    }
 
-          std::string bg_color = "#6c757d"; // Gray (fallback)
-          std::string text_color = "white";
+    out << "</td>\n"
+        << "      <td>" << dep.type << "</td>\n"
+        << "      <td>";
+    for (const auto &lic : dep.licenses)
+      out << "<span class=\"badge\">" << lic << "</span>";
+    out << "</td>\n"
+        << "      <td>";
+
+    // Score badge with color
+    if (sum.active_vulns == 0) {
+      out << "-";
+    } else if (sum.max_score > 0.0) {
+      const double max_score = sum.max_score;
+      const char *bg_color = "#6c757d"; // Gray (fallback)
+      const char *text_color = "white";
+
+      if (max_score >= 9.0)
+        bg_color = "#dc3545"; // Critical: Red
+      else if (max_score >= 7.0)
+        bg_color = "#fd7e14"; // High: Orange
+      else if (max_score >= 4.0) {
+        bg_color = "#ffc107";
+        text_color = "#212529";
+      } // Medium: Yellow
+      else
+        bg_color = "#17a2b8"; // Low: Blue
+
+      std::ostringstream val;
+      val << std::fixed << std::setprecision(1) << max_score;
+      out << "<span class=\"badge\" style=\"background-color:" << bg_color
+          << "; color:" << text_color << "; font-size: 100%;\">" << val.str()
+          << "</span>";
+    } else {
+      out << "<span class=\"badge\" style=\"background-color:#6c757d; "
+             "font-size: 100%;\">?</span>";
+    }
 
-          if (max_score >= 9.0)
-            bg_color = "#dc3545"; // Critical: Red
-          else if (max_score >= 7.0)
-            bg_color = "#fd7e14"; // High: Orange
-          else if (max_score >= 4.0) {
-            bg_color = "#ffc107";
-            text_color = "#212529";
-          } // Medium: Yellow
+    out << "</td>\n"
+        << "      <td>";
+
+    // Security Status
+    if (dep.cves.empty()) {
+      out << "Unknown";
+    } else if (!sum.listed) {
+      const std::string &first_id = dep.cves.front().id;
+      if (first_id == "SAFE")
+        out << "✅ Safe";
+      else
+        out << "⚠️ " << first_id;
+    } else {
+      if (sum.active_vulns > 0)
+        out << "<span class=\"vuln-title\">❌ " << sum.active_vulns
+            << " Vulnerabilit" << (sum.active_vulns > 1 ? "ies" : "y")
+            << "</span>";
+      else
+        out << "<span style=\"color:#856404; font-weight:bold;\">⚠️ "
+            << sum.suppressed_vulns << " Suppressed</span>";
+
+      out << "\n<details><summary>Show details</summary>\n<ul "
+             "class=\"clean-list\">\n";
+      for (std::size_t c = 0; c < dep.cves.size(); ++c) {
+        const CVE &cve = dep.cves[c];
+        out << "  <li style=\""
+            << (cve.suppressed ? "opacity: 0.6; text-decoration: line-through;"
+                               : "")
+            << "\"><a class=\"cve-link\" href=\"" << sum.advisory_urls[c]
+            << "\" target=\"_blank\">" << cve.id << "</a>";
+        if (!cve.summary.empty()) {
+          out << ": ";
+          if (cve.summary.length() > 80)
+            out << std::string_view(cve.summary).substr(0, 77) << "...";
           else
-            bg_color = "#17a2b8"; // Low: Blue
-
-          score_html =
-              "<span class=\"badge\" style=\"background-color:" + bg_color +
-              "; color:" + text_color + "; font-size: 100%;\">" + val +
-              "</span>";
-        } else {
-          score_html =
-              "<span class=\"badge\" style=\"background-color:#6c757d; "
-              "font-size: 100%;\">?</span>";
-        }
-      }
-
-      std::string fixed_versions_str = "-";
-      if (!unique_fixes.empty()) {
-        size_t fix_count = unique_fixes.size();
-        std::string summary_text = std::to_string(fix_count) +
-                                   (fix_count > 1 ? " Versions" : " Version");
-
-        fixed_versions_str = "<details><summary>" + summary_text +
-                             "</summary><ul class=\"clean-list\">";
-        for (const auto &f : unique_fixes) {
-          fixed_versions_str += "<li><strong>v" + f + "</strong></li>";
+            out << cve.summary;
         }
-        fixed_versions_str += "</ul></details>";
+        if (cve.suppressed)
+          out << "<br><small style=\"text-decoration: none; "
+                 "display:block; color:#666;\">↳ <i>Suppressed: "
+              << cve.suppression_reason << "</i></small>";
+        out << "</li>\n";
       }
-
-      // Write Row
-      out << "    <tr class=\"" << sec_class << "\">\n"
-          << "      <td><strong>" << name << "</strong></td>\n"
-          << "      <td>" << version << "</td>\n"
-          << "      <td>" << fixed_versions_str << "</td>\n"
-          << "      <td>" << type << "</td>\n"
-          << "      <td>" << licenses << "</td>\n"
-          << "      <td>" << score_html << "</td>\n"
-          << "      <td>" << sec_text << "</td>\n"
-          << "    </tr>\n";
+      out << "</ul>\n</details>";
     }
+
+    out << "</td>\n"
+        << "    </tr>\n";
   }
 
   out << "  </tbody>\n</table>\n</body>\n</html>\n";
 }
 
+/**
+ * @brief Generates an HTML security report file.
+ *
+ * @param header The report header.
+ * @param deps The dependencies.
+ * @param filepath The path where the report will be saved.
+ */
+inline void generate_html_report(const ReportHeader &header,
+                                 const std::vector<Dependency> &deps,
+                                 const std::string &filepath) {
+  std::ofstream out(filepath);
+  if (!out)
+    return;
+  write_html_report(out, header, deps, build_report_model(deps));
+}
+
 } // namespace depdiscover
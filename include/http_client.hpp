@@ -0,0 +1,394 @@
+/**
+ * SPDX-FileComment: Shared HTTP Client
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file http_client.hpp
+ * @brief Concurrent HTTP client on curl_multi with shared DNS/TLS/connection cache.
+ * @version 1.1.2
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "profiler.hpp"
+#include "rz_config.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <curl/curl.h>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace depdiscover {
+
+/**
+ * @brief A single HTTP request for the shared client.
+ */
+struct HttpRequest {
+  std::string url;                  ///< Target URL.
+  std::string body;                 ///< Request body (POST only).
+  bool post = false;                ///< True for POST, false for GET.
+  std::string content_type;         ///< Content-Type header (POST only).
+  long timeout_ms = 0;              ///< Per-request timeout (0 = client default).
+};
+
+/**
+ * @brief Result of an HTTP request.
+ */
+struct HttpResponse {
+  long status = 0;     ///< HTTP status code (0 if the transfer failed).
+  std::string body;    ///< Response body.
+  std::string error;   ///< Error message (empty on success).
+  int attempts = 0;    ///< Number of attempts (including retries).
+
+  /**
+   * @brief True if the transfer completed.
+   *
+   * Any final HTTP status counts, except a 429 or 5xx that persisted
+   * through all retries.
+   */
+  bool completed() const { return error.empty() && status != 0; }
+};
+
+/**
+ * @brief Tuning parameters of the shared HTTP client.
+ */
+struct HttpOptions {
+  int max_concurrency = 8;          ///< Maximum parallel transfers (--net-jobs).
+  long timeout_ms = 30000;          ///< Default per-request timeout.
+  long connect_timeout_ms = 10000;  ///< Connect timeout.
+  int max_retries = 3;              ///< Retries on 429/5xx or transport errors.
+  long backoff_ms = 500;            ///< Initial backoff, doubled on each retry.
+  long max_backoff_ms = 60000;      ///< Cap of a single backoff (and Retry-After).
+};
+
+/**
+ * @brief Process-wide HTTP client.
+ *
+ * All transfers of one perform() call run in flight together on a
+ * `curl_multi` handle (with HTTP/2 multiplexing where available). DNS
+ * results, TLS sessions and connections are kept in a `curl_share` handle,
+ * so consecutive calls reuse warm connections instead of doing a new
+ * handshake per request. perform() may be called from several threads.
+ */
+class HttpClient {
+public:
+  /**
+   * @brief Returns the shared client instance.
+   */
+  static HttpClient &instance() {
+    static HttpClient client;
+    return client;
+  }
+
+  HttpClient(const HttpClient &) = delete;
+  HttpClient &operator=(const HttpClient &) = delete;
+
+  /**
+   * @brief Replaces the client options (call before the first request).
+   *
+   * @param options The new options.
+   */
+  void configure(const HttpOptions &options) {
+    std::lock_guard lock(options_mutex_);
+    options_ = options;
+    options_.max_concurrency = std::max(1, options_.max_concurrency);
+  }
+
+  /**
+   * @brief Returns a copy of the current options.
+   */
+  HttpOptions options() const {
+    std::lock_guard lock(options_mutex_);
+    return options_;
+  }
+
+  /**
+   * @brief Performs a single GET request.
+   *
+   * @param url The target URL.
+   * @return HttpResponse The result.
+   */
+  HttpResponse get(const std::string &url) {
+    return perform({HttpRequest{url, "", false, "", 0}}).front();
+  }
+
+  /**
+   * @brief Performs a single POST request with a JSON body.
+   *
+   * @param url The target URL.
+   * @param json_payload The JSON payload.
+   * @return HttpResponse The result.
+   */
+  HttpResponse post_json(const std::string &url,
+                         const std::string &json_payload) {
+    return perform({HttpRequest{url, json_payload, true, "application/json", 0}})
+        .front();
+  }
+
+  /**
+   * @brief Performs all requests concurrently.
+   *
+   * At most `max_concurrency` transfers are active at a time. Transport
+   * errors as well as HTTP 429 and 5xx responses are retried with
+   * exponential backoff (honouring `Retry-After`). A 429 or 5xx status
+   * that remains after the last retry is reported in `error`.
+   *
+   * @param requests The requests to perform.
+   * @return std::vector<HttpResponse> One response per request, same order.
+   */
+  std::vector<HttpResponse> perform(const std::vector<HttpRequest> &requests) {
+    using clock = std::chrono::steady_clock;
+    const HttpOptions opts = options();
+
+    std::vector<HttpResponse> responses(requests.size());
+    if (requests.empty())
+      return responses;
+
+    CURLM *multi = curl_multi_init();
+    if (!multi) {
+      for (auto &r : responses)
+        r.error = "curl_multi_init failed";
+      return responses;
+    }
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                      static_cast<long>(opts.max_concurrency));
+
+    struct Transfer {
+      std::size_t index = 0;
+      CURL *easy = nullptr;
+      curl_slist *headers = nullptr;
+    };
+
+    std::deque<std::size_t> pending;
+    for (std::size_t i = 0; i < requests.size(); ++i)
+      pending.push_back(i);
+    std::vector<std::pair<clock::time_point, std::size_t>> delayed;
+    std::vector<Transfer> active;
+    std::vector<CURL *> idle; // easy handles are reused inside one call
+
+    auto start = [&](std::size_t index) {
+      const auto &req = requests[index];
+      CURL *easy = nullptr;
+      if (!idle.empty()) {
+        easy = idle.back();
+        idle.pop_back();
+        curl_easy_reset(easy);
+      } else {
+        easy = curl_easy_init();
+      }
+      if (!easy) {
+        responses[index].error = "curl_easy_init failed";
+        return;
+      }
+
+      auto &resp = responses[index];
+      resp.body.clear();
+      resp.status = 0;
+      resp.error.clear();
+      resp.attempts++;
+
+      Transfer t;
+      t.index = index;
+      t.easy = easy;
+
+      curl_easy_setopt(easy, CURLOPT_URL, req.url.c_str());
+      curl_easy_setopt(easy, CURLOPT_SHARE, share_);
+      curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &HttpClient::write_body);
+      curl_easy_setopt(easy, CURLOPT_WRITEDATA, &resp.body);
+      curl_easy_setopt(easy, CURLOPT_USERAGENT, user_agent_.c_str());
+      curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+      curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+      curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+      curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+      curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+      curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS,
+                       opts.connect_timeout_ms);
+      curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS,
+                       req.timeout_ms > 0 ? req.timeout_ms : opts.timeout_ms);
+
+      if (req.post) {
+        if (!req.content_type.empty())
+          t.headers = curl_slist_append(
+              nullptr, ("Content-Type: " + req.content_type).c_str());
+        curl_easy_setopt(easy, CURLOPT_HTTPHEADER, t.headers);
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDS, req.body.c_str());
+        curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE,
+                         static_cast<long>(req.body.size()));
+      }
+
+      curl_multi_add_handle(multi, easy);
+      active.push_back(t);
+    };
+
+    while (!pending.empty() || !delayed.empty() || !active.empty()) {
+      // Promote delayed retries whose backoff has elapsed
+      auto now = clock::now();
+      for (auto it = delayed.begin(); it != delayed.end();) {
+        if (it->first <= now) {
+          pending.push_back(it->second);
+          it = delayed.erase(it);
+        } else {
+          ++it;
+        }
+      }
+
+      while (!pending.empty() &&
+             active.size() < static_cast<std::size_t>(opts.max_concurrency)) {
+        std::size_t index = pending.front();
+        pending.pop_front();
+        start(index);
+      }
+
+      int running = 0;
+      curl_multi_perform(multi, &running);
+
+      int msgs_left = 0;
+      while (CURLMsg *msg = curl_multi_info_read(multi, &msgs_left)) {
+        if (msg->msg != CURLMSG_DONE)
+          continue;
+
+        CURL *easy = msg->easy_handle;
+        auto it = std::find_if(active.begin(), active.end(),
+                               [&](const Transfer &t) { return t.easy == easy; });
+        if (it == active.end())
+          continue;
+
+        auto &resp = responses[it->index];
+        CURLcode res = msg->data.result;
+        long retry_after_s = 0;
+        if (Profiler::instance().enabled()) {
+          curl_off_t total_us = 0;
+          if (curl_easy_getinfo(easy, CURLINFO_TOTAL_TIME_T, &total_us) ==
+              CURLE_OK)
+            Profiler::instance().sample("http.request",
+                                        double(total_us) / 1000.0);
+          Profiler::instance().count(resp.attempts > 1 ? "http.retries"
+                                                       : "http.requests");
+        }
+        if (res == CURLE_OK) {
+          curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &resp.status);
+          curl_off_t retry_after = 0;
+          if (curl_easy_getinfo(easy, CURLINFO_RETRY_AFTER, &retry_after) ==
+              CURLE_OK)
+            retry_after_s = static_cast<long>(
+                std::clamp<curl_off_t>(retry_after, 0, 24 * 3600));
+        } else {
+          resp.status = 0;
+          resp.error = curl_easy_strerror(res);
+        }
+
+        bool retryable = (res != CURLE_OK) || resp.status == 429 ||
+                         resp.status >= 500;
+        std::size_t index = it->index;
+
+        curl_multi_remove_handle(multi, easy);
+        curl_slist_free_all(it->headers);
+        idle.push_back(easy);
+        active.erase(it);
+
+        if (retryable && resp.attempts <= opts.max_retries) {
+          // Shift clamped: --net-retries may be large
+          long delay = opts.backoff_ms << std::min(resp.attempts - 1, 10);
+          delay = std::max(delay, retry_after_s * 1000);
+          delay = std::clamp(delay, 0L, opts.max_backoff_ms);
+          delayed.emplace_back(clock::now() + std::chrono::milliseconds(delay),
+                               index);
+        } else if (retryable && res == CURLE_OK) {
+          resp.error = "HTTP " + std::to_string(resp.status) + " after " +
+                       std::to_string(resp.attempts) + " attempts";
+        }
+      }
+
+      if (active.empty() && pending.empty() && !delayed.empty()) {
+        auto next = std::min_element(delayed.begin(), delayed.end())->first;
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        next - clock::now())
+                        .count();
+        curl_multi_poll(multi, nullptr, 0,
+                        static_cast<int>(std::clamp<long long>(wait, 0, 1000)),
+                        nullptr);
+      } else if (!active.empty()) {
+        curl_multi_poll(multi, nullptr, 0, 100, nullptr);
+      }
+    }
+
+    for (CURL *easy : idle)
+      curl_easy_cleanup(easy);
+    curl_multi_cleanup(multi);
+    return responses;
+  }
+
+private:
+  HttpClient() {
+    // Keeps libcurl initialized until the shared handle is released
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    user_agent_ = std::string(rz::config::EXECUTABLE_NAME) + "/" +
+                  std::string(rz::config::VERSION);
+
+    share_ = curl_share_init();
+    if (share_) {
+      curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &HttpClient::lock_cb);
+      curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &HttpClient::unlock_cb);
+      curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+      curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+      curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+      curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    }
+  }
+
+  ~HttpClient() {
+    if (share_)
+      curl_share_cleanup(share_);
+    curl_global_cleanup();
+  }
+
+  /**
+   * @brief CURL write callback appending to a std::string.
+   */
+  static size_t write_body(void *contents, size_t size, size_t nmemb,
+                           void *userp) {
+    size_t total = size * nmemb;
+    static_cast<std::string *>(userp)->append(static_cast<char *>(contents),
+                                              total);
+    return total;
+  }
+
+  /**
+   * @brief Lock callback for the share handle (one mutex per data type).
+   */
+  static void lock_cb(CURL *, curl_lock_data data, curl_lock_access,
+                      void *userp) {
+    auto *self = static_cast<HttpClient *>(userp);
+    self->share_locks_[static_cast<std::size_t>(data) %
+                       self->share_locks_.size()]
+        .lock();
+  }
+
+  /**
+   * @brief Unlock callback for the share handle.
+   */
+  static void unlock_cb(CURL *, curl_lock_data data, void *userp) {
+    auto *self = static_cast<HttpClient *>(userp);
+    self->share_locks_[static_cast<std::size_t>(data) %
+                       self->share_locks_.size()]
+        .unlock();
+  }
+
+  CURLSH *share_ = nullptr;
+  std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks_;
+  std::string user_agent_;
+  mutable std::mutex options_mutex_;
+  HttpOptions options_;
+};
+
+} // namespace depdiscover
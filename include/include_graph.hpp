@@ -0,0 +1,298 @@
+/**
+ * SPDX-FileComment: Transitive Include Graph
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file include_graph.hpp
+ * @brief Walks headers included by headers, parsing each header only once.
+ * @version 1.2.3
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "file_reader.hpp"
+#include "header_resolver.hpp"
+#include "include_lexer.hpp"
+#include "string_pool.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace depdiscover {
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Limits for the transitive include traversal.
+ */
+struct IncludeGraphOptions {
+  int max_depth = 32;                           ///< Max. nesting below the TU.
+  std::uintmax_t max_file_size = 1024 * 1024;   ///< Headers above are not parsed.
+  bool preamble_only = false; ///< Stop parsing after the directive preamble.
+};
+
+/**
+ * @brief Process-wide cache of parsed header include lists.
+ *
+ * A header shared by thousands of translation units is read and parsed
+ * once; later visits only walk the cached list. Headers and include names
+ * are StringPool IDs, so a walk compares and hashes integers only. Nested includes are first
+ * looked up next to the including header, then in the include-path list of
+ * the translation unit. Thread-safe.
+ */
+class IncludeGraph {
+public:
+  /**
+   * @brief Returns the process-wide graph instance.
+   */
+  static IncludeGraph &instance() {
+    static IncludeGraph graph;
+    return graph;
+  }
+
+  /**
+   * @brief Sets the traversal limits (call before scanning).
+   *
+   * @param options The new limits.
+   */
+  void configure(const IncludeGraphOptions &options) {
+    std::unique_lock lock(mutex_);
+    // Parsed lists depend on the size limit and the preamble mode
+    if (options.max_file_size != options_.max_file_size ||
+        options.preamble_only != options_.preamble_only) {
+      parsed_.clear();
+      ++generation_;
+    }
+    options_ = options;
+  }
+
+  /**
+   * @brief A parsed header in plain strings (see release_interned()).
+   */
+  struct ParsedHeader {
+    std::string path;
+    std::string dir;
+    std::vector<std::string> includes;
+    std::uint64_t size;
+    std::int64_t mtime;
+  };
+
+  /**
+   * @brief Moves the parsed headers out as strings, so they survive a
+   * StringPool::reset().
+   *
+   * @return std::vector<ParsedHeader> The headers for restore_interned().
+   */
+  std::vector<ParsedHeader> release_interned() {
+    auto &pool = StringPool::instance();
+    std::unique_lock lock(mutex_);
+    std::vector<ParsedHeader> out;
+    out.reserve(parsed_.size());
+    for (const auto &[header, node] : parsed_) {
+      ParsedHeader &h = out.emplace_back(ParsedHeader{
+          pool.str(header), pool.str(node->dir), {}, node->size, node->mtime});
+      h.includes.reserve(node->includes.size());
+      for (StringId name : node->includes)
+        h.includes.push_back(pool.str(name));
+    }
+    parsed_.clear();
+    probes_.clear();
+    return out;
+  }
+
+  /**
+   * @brief Interns headers released by release_interned() again.
+   */
+  void restore_interned(std::vector<ParsedHeader> &&headers) {
+    auto &pool = StringPool::instance();
+    std::unique_lock lock(mutex_);
+    for (auto &h : headers) {
+      auto node = std::make_shared<Node>();
+      node->dir = pool.intern(h.dir);
+      node->includes.reserve(h.includes.size());
+      for (const auto &name : h.includes)
+        node->includes.push_back(pool.intern(name));
+      node->size = h.size;
+      node->mtime = h.mtime;
+      parsed_.try_emplace(pool.intern(h.path), std::move(node));
+    }
+  }
+
+  /**
+   * @brief Forgets parsed headers that changed on disk (long-running
+   * server).
+   */
+  void refresh() {
+    auto &pool = StringPool::instance();
+    std::unique_lock lock(mutex_);
+    probes_.clear(); // directory contents may have changed
+    for (auto it = parsed_.begin(); it != parsed_.end();) {
+      FileStamp st;
+      stat_file(std::string(pool.view(it->first)), st);
+      if (st.size != it->second->size || st.mtime != it->second->mtime)
+        it = parsed_.erase(it);
+      else
+        ++it;
+    }
+  }
+
+  /**
+   * @brief A parsed header: its directory and its raw `#include` names.
+   */
+  struct Node {
+    StringId dir;                   ///< Directory of the header.
+    std::vector<StringId> includes; ///< Interned include names.
+    std::uint64_t size;             ///< File size when parsed.
+    std::int64_t mtime;             ///< File mtime when parsed.
+  };
+
+  /**
+   * @brief Returns the parsed form of a header (parsed once).
+   *
+   * @param header The interned canonical path of the header.
+   * @return std::shared_ptr<const Node> The directory and include names.
+   */
+  std::shared_ptr<const Node> node_of(StringId header) {
+    IncludeGraphOptions options;
+    std::uint64_t generation;
+    {
+      std::shared_lock lock(mutex_);
+      auto it = parsed_.find(header);
+      if (it != parsed_.end())
+        return it->second;
+      options = options_;
+      generation = generation_;
+    }
+
+    auto &pool = StringPool::instance();
+    std::string path(pool.view(header));
+    FileStamp st;
+    stat_file(path, st);
+    auto node = std::make_shared<Node>();
+    node->dir = pool.intern(fs::path(path).parent_path().string());
+    node->size = st.size;
+    node->mtime = st.mtime;
+    MappedFile file(path);
+    if (file.is_open() && file.size() <= options.max_file_size)
+      for (const auto &name :
+           lex_include_directives(file.view(), options.preamble_only))
+        node->includes.push_back(pool.intern(name));
+
+    std::unique_lock lock(mutex_);
+    // Parsed with options that configure() replaced meanwhile: not cached
+    if (generation != generation_)
+      return node;
+    return parsed_.try_emplace(header, std::move(node)).first->second;
+  }
+
+  /**
+   * @brief Adds all headers reachable from the given direct includes.
+   *
+   * @param direct_headers Resolved headers included by the translation unit.
+   * @param list_id The interned include-path list of the translation unit.
+   * @param out Receives every reachable header (incl. direct ones) once.
+   */
+  void collect(const std::vector<StringId> &direct_headers,
+               std::uint32_t list_id, std::vector<StringId> &out) {
+    auto &resolver = HeaderResolveCache::instance();
+    int max_depth;
+    {
+      std::shared_lock lock(mutex_);
+      max_depth = options_.max_depth;
+    }
+    std::unordered_set<StringId> visited;
+    std::vector<std::pair<StringId, int>> stack;
+
+    for (StringId h : direct_headers)
+      if (visited.insert(h).second)
+        stack.emplace_back(h, 0);
+
+    while (!stack.empty()) {
+      auto [header, depth] = stack.back();
+      stack.pop_back();
+      out.push_back(header);
+
+      if (depth >= max_depth)
+        continue;
+
+      auto node = node_of(header);
+      for (StringId name : node->includes) {
+        StringId path = resolver.resolve_in_id(node->dir, name);
+        if (path == NO_STRING_ID)
+          path = resolver.resolve_id(list_id, name);
+        if (path != NO_STRING_ID && visited.insert(path).second)
+          stack.emplace_back(path, depth + 1);
+      }
+    }
+  }
+
+  /**
+   * @brief Returns the directories the nested includes of a header are
+   * looked up in: next to the header, then as in
+   * HeaderResolveCache::probed_directories().
+   *
+   * @param header The interned canonical path of the header.
+   * @param list_id The include-path list of the translation unit.
+   * @return std::vector<StringId> The interned directories (memoized).
+   */
+  std::vector<StringId> probed_directories(StringId header,
+                                           std::uint32_t list_id) {
+    std::uint64_t key = (std::uint64_t(list_id) << 32) | header;
+    {
+      std::shared_lock lock(mutex_);
+      auto it = probes_.find(key);
+      if (it != probes_.end())
+        return it->second;
+    }
+
+    auto &pool = StringPool::instance();
+    auto &resolver = HeaderResolveCache::instance();
+    auto node = node_of(header);
+    std::unordered_set<StringId> dirs;
+    for (StringId name : node->includes) {
+      std::string_view n = pool.view(name);
+      dirs.insert(n.find('/') == std::string_view::npos
+                      ? node->dir
+                      : pool.intern((fs::path(pool.view(node->dir)) / n)
+                                        .parent_path()
+                                        .string()));
+      if (resolver.resolve_in_id(node->dir, name) == NO_STRING_ID)
+        for (StringId d : resolver.probed_directories(list_id, name))
+          dirs.insert(d);
+    }
+    std::vector<StringId> out(dirs.begin(), dirs.end());
+    std::unique_lock lock(mutex_);
+    return probes_.try_emplace(key, std::move(out)).first->second;
+  }
+
+  /**
+   * @brief Number of distinct headers parsed so far.
+   */
+  std::size_t parsed_count() const {
+    std::shared_lock lock(mutex_);
+    return parsed_.size();
+  }
+
+private:
+  IncludeGraph() = default;
+
+  IncludeGraphOptions options_;
+  std::uint64_t generation_ = 0; ///< Bumped when `parsed_` is invalidated.
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<StringId, std::shared_ptr<const Node>> parsed_;
+  std::unordered_map<std::uint64_t, std::vector<StringId>> probes_;
+};
+
+} // namespace depdiscover
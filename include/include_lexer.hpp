@@ -0,0 +1,445 @@
+/**
+ * SPDX-FileComment: Include Directive and Compiler Flag Lexer
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file include_lexer.hpp
+ * @brief Hand-written scanners for #include directives and command-line flags.
+ * @version 1.1.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace depdiscover {
+
+namespace lexer_detail {
+
+inline bool is_ident_char(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_';
+}
+
+inline bool is_hspace(char c) {
+  return c == ' ' || c == '\t' || c == '\f' || c == '\v' || c == '\r';
+}
+
+/**
+ * @brief Characters that can start a comment, literal, continuation or line.
+ */
+inline bool is_special(char c) {
+  return c == '\n' || c == '/' || c == '"' || c == '\'' || c == '\\';
+}
+
+/**
+ * @brief Cursor over a source buffer that transparently skips line
+ * continuations (backslash-newline).
+ */
+struct Cursor {
+  std::string_view src;
+  std::size_t pos = 0;
+
+  void skip_continuations() {
+    while (pos < src.size() && src[pos] == '\\') {
+      std::size_t n = pos + 1;
+      if (n < src.size() && src[n] == '\r')
+        ++n;
+      if (n < src.size() && src[n] == '\n')
+        pos = n + 1;
+      else
+        return;
+    }
+  }
+  bool eof() {
+    skip_continuations();
+    return pos >= src.size();
+  }
+  char peek() {
+    skip_continuations();
+    return pos < src.size() ? src[pos] : '\0';
+  }
+  char peek_next() {
+    skip_continuations();
+    std::size_t save = pos;
+    if (pos < src.size())
+      ++pos;
+    char c = peek();
+    pos = save;
+    return c;
+  }
+  char get() {
+    char c = peek();
+    if (pos < src.size())
+      ++pos;
+    return c;
+  }
+};
+
+/**
+ * @brief Skips a block comment; the cursor is placed after the closing delimiter.
+ */
+inline void skip_block_comment(Cursor &cur) {
+  cur.get(); // '/'
+  cur.get(); // '*'
+  while (!cur.eof()) {
+    // Jump to the next '*' on the raw buffer, then check for the closing '/'
+    std::size_t star = cur.src.find('*', cur.pos);
+    if (star == std::string_view::npos) {
+      cur.pos = cur.src.size();
+      return;
+    }
+    cur.pos = star + 1;
+    if (cur.peek() == '/') {
+      cur.get();
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Skips a line comment up to (not including) the terminating newline.
+ *
+ * A backslash before the newline continues the comment on the next line.
+ */
+inline void skip_line_comment(Cursor &cur) {
+  while (true) {
+    std::size_t nl = cur.src.find('\n', cur.pos);
+    if (nl == std::string_view::npos) {
+      cur.pos = cur.src.size();
+      return;
+    }
+    std::size_t k = nl;
+    if (k > cur.pos && cur.src[k - 1] == '\r')
+      --k;
+    if (k > cur.pos && cur.src[k - 1] == '\\') {
+      cur.pos = nl + 1;
+      continue;
+    }
+    cur.pos = nl;
+    return;
+  }
+}
+
+/**
+ * @brief Skips horizontal whitespace and comments inside a directive.
+ */
+inline void skip_directive_space(Cursor &cur) {
+  while (!cur.eof()) {
+    char c = cur.peek();
+    if (is_hspace(c)) {
+      cur.get();
+    } else if (c == '/' && cur.peek_next() == '*') {
+      skip_block_comment(cur);
+    } else {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Skips the rest of a logical line, honouring comments.
+ */
+inline void skip_rest_of_line(Cursor &cur) {
+  while (!cur.eof()) {
+    char c = cur.peek();
+    if (c == '\n')
+      return;
+    if (c == '/' && cur.peek_next() == '*')
+      skip_block_comment(cur);
+    else if (c == '/' && cur.peek_next() == '/')
+      skip_line_comment(cur);
+    else
+      cur.get();
+  }
+}
+
+/**
+ * @brief Skips a string or character literal (quote is the current char).
+ */
+inline void skip_quoted(Cursor &cur) {
+  char quote = cur.get();
+  while (!cur.eof()) {
+    char c = cur.get();
+    if (c == '\\') {
+      cur.get();
+    } else if (c == quote || c == '\n') {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Skips a raw string literal R"delim(...)delim" (cursor on the quote).
+ */
+inline void skip_raw_string(Cursor &cur) {
+  // Raw strings do not know line continuations: work on the plain buffer
+  std::size_t open = cur.src.find('(', cur.pos);
+  if (open == std::string_view::npos || open - cur.pos > 17) {
+    skip_quoted(cur);
+    return;
+  }
+  std::string close = ")";
+  close += cur.src.substr(cur.pos + 1, open - cur.pos - 1);
+  close += '"';
+  std::size_t end = cur.src.find(close, open + 1);
+  cur.pos = (end == std::string_view::npos) ? cur.src.size()
+                                            : end + close.size();
+}
+
+/**
+ * @brief Checks whether the quote at `quote_pos` opens a raw string, i.e. is
+ * preceded by the identifier R, u8R, uR, UR or LR.
+ */
+inline bool is_raw_string_prefix(std::string_view src, std::size_t quote_pos) {
+  std::size_t start = quote_pos;
+  while (start > 0 && is_ident_char(src[start - 1]))
+    --start;
+  std::string_view id = src.substr(start, quote_pos - start);
+  return id == "R" || id == "u8R" || id == "uR" || id == "UR" || id == "LR";
+}
+
+/**
+ * @brief Parses a directive after '#'; appends the header of an #include.
+ *
+ * @param cur The cursor (placed after the '#').
+ * @param out Receives the header name of an #include.
+ * @param depth The #if nesting depth, updated by #if / #endif.
+ */
+inline void parse_directive(Cursor &cur, std::vector<std::string> &out,
+                            int &depth) {
+  skip_directive_space(cur);
+
+  std::string name;
+  while (!cur.eof() && is_ident_char(cur.peek()) && name.size() < 16)
+    name += cur.get();
+
+  if (name == "if" || name == "ifdef" || name == "ifndef") {
+    depth++;
+  } else if (name == "endif") {
+    depth = depth > 0 ? depth - 1 : 0;
+  } else if (name == "include") {
+    skip_directive_space(cur);
+    char open = cur.peek();
+    if (open == '<' || open == '"') {
+      char close = (open == '<') ? '>' : '"';
+      cur.get();
+      std::string header;
+      while (!cur.eof()) {
+        char c = cur.peek();
+        if (c == close || c == '\n' || (close == '>' && c == '"'))
+          break;
+        header += cur.get();
+      }
+      if (!header.empty() && cur.peek() == close)
+        out.push_back(std::move(header));
+    }
+  }
+  skip_rest_of_line(cur);
+}
+
+} // namespace lexer_detail
+
+/**
+ * @brief Extracts the header names of all `#include` directives.
+ *
+ * Only directives at the start of a logical line are recognized. Comments,
+ * string/character/raw-string literals and line continuations are handled,
+ * so commented-out includes are ignored.
+ *
+ * With `preamble_only`, scanning stops at the first token outside of a
+ * directive that is not nested in an #if block, i.e. once the file's
+ * directive preamble is over. Tokens inside conditionals (such as the
+ * `extern "C" {` of C headers) do not end the preamble.
+ *
+ * @param source The source buffer.
+ * @param preamble_only Stop after the directive preamble.
+ * @return std::vector<std::string> The included header names in order.
+ */
+inline std::vector<std::string> lex_include_directives(std::string_view source,
+                                                       bool preamble_only = false) {
+  using namespace lexer_detail;
+  std::vector<std::string> out;
+  Cursor cur{source, 0};
+  bool at_line_start = true;
+  int depth = 0;
+
+  while (!cur.eof()) {
+    char c = cur.peek();
+    if (c == '\n') {
+      cur.get();
+      at_line_start = true;
+      continue;
+    }
+    if (is_hspace(c)) {
+      cur.get();
+      continue;
+    }
+    if (c == '/' && cur.peek_next() == '/') {
+      skip_line_comment(cur);
+      continue;
+    }
+    if (c == '/' && cur.peek_next() == '*') {
+      skip_block_comment(cur);
+      continue;
+    }
+    if (c == '#' && at_line_start) {
+      cur.get();
+      parse_directive(cur, out, depth);
+      continue;
+    }
+
+    if (preamble_only && depth == 0)
+      break;
+    at_line_start = false;
+    if (c == '"' && is_raw_string_prefix(source, cur.pos)) {
+      skip_raw_string(cur);
+    } else if (c == '"' || c == '\'') {
+      skip_quoted(cur);
+    } else {
+      cur.get();
+      // Fast path: ordinary code up to the next character of interest
+      const std::size_t n = source.size();
+      std::size_t p = cur.pos;
+      while (p < n && !is_special(source[p]))
+        ++p;
+      cur.pos = p;
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief Splits a shell-style command line into arguments.
+ *
+ * Whitespace separates arguments except inside single or double quotes; a
+ * backslash escapes the next character. The returned views still contain
+ * quotes/escapes, see unquote_argument().
+ *
+ * @param cmd The command line.
+ * @return std::vector<std::string_view> The raw arguments.
+ */
+inline std::vector<std::string_view> split_command_line(std::string_view cmd) {
+  std::vector<std::string_view> args;
+  std::size_t i = 0;
+  const std::size_t n = cmd.size();
+  while (i < n) {
+    while (i < n && (cmd[i] == ' ' || cmd[i] == '\t' || cmd[i] == '\n' ||
+                     cmd[i] == '\r'))
+      ++i;
+    if (i >= n)
+      break;
+    std::size_t start = i;
+    char quote = '\0';
+    while (i < n) {
+      char c = cmd[i];
+      if (quote) {
+        if (c == '\\' && quote == '"' && i + 1 < n)
+          ++i;
+        else if (c == quote)
+          quote = '\0';
+      } else if (c == '\\' && i + 1 < n) {
+        ++i;
+      } else if (c == '"' || c == '\'') {
+        quote = c;
+      } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        break;
+      }
+      ++i;
+    }
+    args.push_back(cmd.substr(start, i - start));
+  }
+  return args;
+}
+
+/**
+ * @brief Removes shell quoting and escapes from a single argument.
+ *
+ * @param arg The raw argument (as returned by split_command_line()).
+ * @return std::string The literal argument value.
+ */
+inline std::string unquote_argument(std::string_view arg) {
+  if (arg.find_first_of("\"'\\") == std::string_view::npos)
+    return std::string(arg);
+
+  std::string out;
+  out.reserve(arg.size());
+  char quote = '\0';
+  for (std::size_t i = 0; i < arg.size(); ++i) {
+    char c = arg[i];
+    if (quote) {
+      if (c == quote)
+        quote = '\0';
+      else if (c == '\\' && quote == '"' && i + 1 < arg.size())
+        out += arg[++i];
+      else
+        out += c;
+    } else if (c == '"' || c == '\'') {
+      quote = c;
+    } else if (c == '\\' && i + 1 < arg.size()) {
+      out += arg[++i];
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief Collects the values of a flag from a list of arguments.
+ *
+ * Supports both the joined (`-I/usr/include`) and the separate
+ * (`-I /usr/include`) form.
+ *
+ * @tparam Arg std::string or std::string_view.
+ * @param args The (raw) arguments.
+ * @param flag The flag, e.g. "-I" or "-isystem".
+ * @param out Receives the unquoted values.
+ * @param shell_quoted False if the arguments are literal tokens (the
+ * `arguments` form of compile_commands.json) that must not be unquoted.
+ */
+template <class Arg>
+inline void collect_flag_values(const std::vector<Arg> &args,
+                                std::string_view flag,
+                                std::vector<std::string> &out,
+                                bool shell_quoted = true) {
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    std::string_view a = args[i];
+    if (!shell_quoted) {
+      if (!a.starts_with(flag))
+        continue;
+      if (a.size() > flag.size())
+        out.emplace_back(a.substr(flag.size()));
+      else if (i + 1 < args.size())
+        out.emplace_back(args[++i]);
+      continue;
+    }
+    // A fully quoted argument ("-I/path with space") is matched unquoted
+    std::string unquoted;
+    const bool quoted = !a.empty() && (a.front() == '"' || a.front() == '\'');
+    if (quoted) {
+      unquoted = unquote_argument(a);
+      a = unquoted;
+    }
+    if (a.size() < flag.size() || a.substr(0, flag.size()) != flag)
+      continue;
+    std::string_view rest = a.substr(flag.size());
+    if (rest.empty()) {
+      if (i + 1 < args.size())
+        out.push_back(unquote_argument(args[++i]));
+    } else {
+      out.push_back(quoted ? std::string(rest) : unquote_argument(rest));
+    }
+  }
+}
+
+} // namespace depdiscover
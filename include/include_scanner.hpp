@@ -7,8 +7,8 @@
  *
  * @file include_scanner.hpp
  * @brief Scans compiler flags for include paths and library names.
- * @version 1.0.0
- * @date 2026-02-18
+ * @version 1.2.0
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -16,33 +16,47 @@
  * @license MIT License
  */
 #pragma once
-#include <regex>
+#include "include_lexer.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace depdiscover {
 
 /**
- * @brief Extracts include paths (-I flag) from a compiler command string.
+ * @brief Extracts include paths (-I and -isystem flags) from a compiler
+ * command string.
+ *
+ * Both the joined (`-I/usr/include`) and the separate (`-I /usr/include`)
+ * form are recognized; quoted paths are unquoted. The -I paths come first,
+ * as the compiler searches them before the -isystem paths.
  *
  * @param cmd The compiler command string.
  * @return std::vector<std::string> A list of extracted include paths.
  */
-inline std::vector<std::string> extract_include_paths(const std::string &cmd) {
+inline std::vector<std::string> extract_include_paths(std::string_view cmd) {
   std::vector<std::string> out;
-  // Fix: \\s* allows spaces (e.g., "-I /usr/include")
-  // ([^\\s]+) captures everything until the next whitespace
-  std::regex re("-I\\s*([^\\s]+)");
-  std::smatch m;
-
-  auto begin = cmd.cbegin();
-  auto end = cmd.cend();
-
-  while (std::regex_search(begin, end, m, re)) {
-    out.push_back(m[1]);
-    begin = m.suffix().first;
-  }
+  auto args = split_command_line(cmd);
+  collect_flag_values(args, "-I", out);
+  collect_flag_values(args, "-isystem", out);
+  return out;
+}
 
+/**
+ * @brief Extracts include paths from the literal argument list of a
+ * compile command (the `arguments` form of compile_commands.json).
+ *
+ * Same order and flag forms as the string overload; the tokens are used
+ * as they are, without shell splitting or unquoting.
+ *
+ * @param arguments The compiler arguments.
+ * @return std::vector<std::string> A list of extracted include paths.
+ */
+inline std::vector<std::string>
+extract_include_paths(const std::vector<std::string> &arguments) {
+  std::vector<std::string> out;
+  collect_flag_values(arguments, "-I", out, false);
+  collect_flag_values(arguments, "-isystem", out, false);
   return out;
 }
 
@@ -52,20 +66,9 @@ inline std::vector<std::string> extract_include_paths(const std::string &cmd) {
  * @param cmd The compiler command string.
  * @return std::vector<std::string> A list of extracted library names.
  */
-inline std::vector<std::string> extract_libraries(const std::string &cmd) {
+inline std::vector<std::string> extract_libraries(std::string_view cmd) {
   std::vector<std::string> out;
-  // Same fix for libraries (-l lib vs -llib)
-  std::regex re("-l\\s*([^\\s]+)");
-  std::smatch m;
-
-  auto begin = cmd.cbegin();
-  auto end = cmd.cend();
-
-  while (std::regex_search(begin, end, m, re)) {
-    out.push_back(m[1]);
-    begin = m.suffix().first;
-  }
-
+  collect_flag_values(split_command_line(cmd), "-l", out);
   return out;
 }
 
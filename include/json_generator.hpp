@@ -0,0 +1,118 @@
+/**
+ * SPDX-FileComment: JSON Report Generator
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file json_generator.hpp
+ * @brief Streams the SBOM JSON report straight from the dependency list.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "json_writer.hpp"
+#include "types.hpp"
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace depdiscover {
+
+/*
+ * Keys are written in the sorted order of the former nlohmann objects (see
+ * to_json() in types.hpp), so the reports stay byte-identical.
+ */
+
+/**
+ * @brief Writes a CVE as JSON object.
+ */
+inline void write_json(JsonWriter &w, const CVE &c) {
+  w.begin_object()
+      .key("fixed_version").value(c.fixed_version)
+      .key("id").value(c.id)
+      .key("score").value(c.score)
+      .key("severity").value(c.severity)
+      .key("summary").value(c.summary)
+      .key("suppressed").value(c.suppressed)
+      .key("suppression_reason").value(c.suppression_reason)
+      .end_object();
+}
+
+/**
+ * @brief Writes a Dependency as JSON object.
+ */
+inline void write_json(JsonWriter &w, const Dependency &d) {
+  w.begin_object().key("cves").begin_array();
+  for (const auto &c : d.cves)
+    write_json(w, c);
+  w.end_array()
+      .key("headers").string_array(d.headers)
+      .key("libraries").string_array(d.libraries)
+      .key("licenses").string_array(d.licenses)
+      .key("name").value(d.name)
+      .key("source").value(d.source.empty() ? "manifest" : d.source)
+      .key("type").value(d.type)
+      .key("version").value(d.version)
+      .end_object();
+}
+
+/**
+ * @brief Writes the SBOM JSON report to a stream.
+ *
+ * @param out The output stream.
+ * @param header The report header.
+ * @param deps The dependencies.
+ * @param indent Indentation as for `json::dump()` (negative: compact).
+ */
+inline void write_json_report(std::ostream &out, const ReportHeader &header,
+                              const std::vector<Dependency> &deps,
+                              int indent = 2) {
+  JsonWriter w(out, indent);
+  w.begin_object().key("dependencies").begin_array();
+  for (const auto &d : deps)
+    write_json(w, d);
+  w.end_array()
+      .key("header").begin_object()
+      .key("project").begin_object()
+      .key("name").value(header.project_name)
+      .key("workspace_root").value(header.workspace_root)
+      .end_object()
+      .key("scan_date").value(header.scan_date)
+      .key("schema_version").value(header.schema_version)
+      .key("tool").begin_object()
+      .key("author").value(header.tool_author)
+      .key("description").value(header.tool_description)
+      .key("homepage").value(header.tool_homepage)
+      .key("name").value(header.tool_name)
+      .key("version").value(header.tool_version)
+      .end_object()
+      .end_object()
+      .end_object();
+}
+
+/**
+ * @brief Writes the SBOM JSON report to a file.
+ *
+ * @param header The report header.
+ * @param deps The dependencies.
+ * @param filepath The path where the report will be saved.
+ * @return bool False if the file could not be written.
+ */
+inline bool generate_json_report(const ReportHeader &header,
+                                 const std::vector<Dependency> &deps,
+                                 const std::string &filepath) {
+  std::ofstream out(filepath);
+  if (!out)
+    return false;
+  write_json_report(out, header, deps);
+  return static_cast<bool>(out);
+}
+
+} // namespace depdiscover
@@ -0,0 +1,186 @@
+/**
+ * SPDX-FileComment: Streaming JSON Writer
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file json_writer.hpp
+ * @brief Writes JSON to a stream without building a document tree.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace depdiscover {
+
+/**
+ * @brief Incremental JSON writer with the layout of `nlohmann::json::dump()`.
+ *
+ * With `indent >= 0` the output matches `dump(indent)` byte for byte (one
+ * member per line, `"key": value`, `{}`/`[]` for empty containers), with a
+ * negative indent it matches the compact `dump()`. Keys are written in the
+ * order they are given: callers reproducing a former nlohmann object (whose
+ * keys are sorted) have to emit them sorted.
+ *
+ * Strings of printable ASCII are escaped here; all others go through the
+ * nlohmann serializer, so control characters, UTF-8 passthrough and the
+ * error on invalid UTF-8 behave exactly as before.
+ */
+class JsonWriter {
+public:
+  explicit JsonWriter(std::ostream &out, int indent = 2)
+      : out_(out), indent_(indent) {}
+
+  JsonWriter &begin_object() { return open('{'); }
+  JsonWriter &end_object() { return close('}'); }
+  JsonWriter &begin_array() { return open('['); }
+  JsonWriter &end_array() { return close(']'); }
+
+  /**
+   * @brief Starts an object member; the next call writes its value.
+   */
+  JsonWriter &key(std::string_view k) {
+    separate();
+    write_string(k);
+    out_ << (indent_ >= 0 ? ": " : ":");
+    after_key_ = true;
+    return *this;
+  }
+
+  JsonWriter &value(std::string_view s) {
+    separate();
+    write_string(s);
+    return *this;
+  }
+  JsonWriter &value(const char *s) { return value(std::string_view(s)); }
+  JsonWriter &value(const std::string &s) { return value(std::string_view(s)); }
+  JsonWriter &value(bool b) {
+    separate();
+    out_ << (b ? "true" : "false");
+    return *this;
+  }
+  JsonWriter &value(int i) { return value(static_cast<std::int64_t>(i)); }
+  JsonWriter &value(std::int64_t i) {
+    separate();
+    out_ << i;
+    return *this;
+  }
+  JsonWriter &value(double d) {
+    separate();
+    out_ << nlohmann::json(d).dump(); // same shortest round-trip digits
+    return *this;
+  }
+  JsonWriter &null() {
+    separate();
+    out_ << "null";
+    return *this;
+  }
+
+  /**
+   * @brief Writes an already serialized JSON value as is.
+   */
+  JsonWriter &raw(std::string_view json_text) {
+    separate();
+    out_ << json_text;
+    return *this;
+  }
+
+  /**
+   * @brief Writes a container of strings as array.
+   */
+  template <class Range> JsonWriter &string_array(const Range &items) {
+    begin_array();
+    for (const auto &s : items)
+      value(std::string_view(s));
+    return end_array();
+  }
+
+private:
+  struct Level {
+    char close;
+    bool empty = true;
+  };
+
+  JsonWriter &open(char c) {
+    separate();
+    out_ << c;
+    levels_.push_back({c == '{' ? '}' : ']'});
+    return *this;
+  }
+
+  JsonWriter &close(char c) {
+    bool empty = levels_.back().empty;
+    levels_.pop_back();
+    if (!empty)
+      newline();
+    out_ << c;
+    return *this;
+  }
+
+  /// Emits the separator and indentation in front of a key or value.
+  void separate() {
+    if (after_key_) {
+      after_key_ = false;
+      return;
+    }
+    if (levels_.empty())
+      return;
+    auto &level = levels_.back();
+    if (!level.empty)
+      out_ << ',';
+    level.empty = false;
+    newline();
+  }
+
+  void newline() {
+    if (indent_ < 0)
+      return;
+    static constexpr std::string_view spaces = "\n                                ";
+    std::size_t width = levels_.size() * std::size_t(indent_);
+    out_.write(spaces.data(),
+               std::streamsize(std::min(width, spaces.size() - 1) + 1));
+    for (width -= std::min(width, spaces.size() - 1); width > 0;) {
+      std::size_t n = std::min(width, spaces.size() - 1);
+      out_.write(spaces.data() + 1, std::streamsize(n));
+      width -= n;
+    }
+  }
+
+  void write_string(std::string_view s) {
+    for (unsigned char c : s)
+      if (c < 0x20 || c >= 0x80) {
+        out_ << nlohmann::json(std::string(s)).dump();
+        return;
+      }
+    out_ << '"';
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < s.size(); ++i)
+      if (s[i] == '"' || s[i] == '\\') {
+        out_.write(s.data() + start, std::streamsize(i - start));
+        out_ << '\\' << s[i];
+        start = i + 1;
+      }
+    out_.write(s.data() + start, std::streamsize(s.size() - start));
+    out_ << '"';
+  }
+
+  std::ostream &out_;
+  int indent_;
+  std::vector<Level> levels_;
+  bool after_key_ = false;
+};
+
+} // namespace depdiscover
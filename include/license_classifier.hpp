@@ -0,0 +1,572 @@
+/**
+ * SPDX-FileComment: License Text Classifier
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file license_classifier.hpp
+ * @brief Multi-pattern (Aho-Corasick) classification of license texts.
+ * @version 1.1.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "file_reader.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <queue>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace depdiscover {
+
+namespace fs = std::filesystem;
+
+/// Bytes of a license file that are classified.
+inline constexpr std::size_t LICENSE_PREFIX_BYTES = 8 * 1024;
+
+/**
+ * @brief A license detected in a text.
+ */
+struct LicenseMatch {
+  std::string spdx_id;     ///< SPDX identifier (or expression for tags).
+  double confidence = 0.0; ///< 1.0 for SPDX tags, lower for phrase matches.
+};
+
+namespace license_detail {
+
+/**
+ * @brief A license and the phrases identifying it.
+ *
+ * All phrases of `all` have to occur and none of `none`. Phrases are
+ * lowercase with single blanks; the first one is the "title" whose
+ * position weights the confidence.
+ */
+struct Rule {
+  const char *spdx_id;
+  double confidence;
+  std::vector<std::string_view> all;
+  std::vector<std::string_view> none = {};
+};
+
+inline const std::vector<Rule> &rules() {
+  static const std::vector<Rule> list = {
+      // Apache
+      {"Apache-2.0", 0.95, {"apache license", "version 2.0"}},
+      {"Apache-2.0", 0.95, {"apache.org/licenses/license-2.0"}},
+      {"Apache-1.1", 0.9, {"apache software license", "version 1.1"}},
+      // MIT family
+      {"MIT", 0.9, {"mit license"}},
+      {"MIT", 0.85,
+       {"permission is hereby granted, free of charge, to any person "
+        "obtaining a copy"}},
+      {"X11", 0.88, {"x consortium", "permission is hereby granted"}},
+      {"MIT-0", 0.92, {"mit no attribution"}},
+      {"ISC", 0.9, {"isc license"}},
+      {"ISC", 0.85,
+       {"permission to use, copy, modify, and/or distribute this software "
+        "for any purpose with or without fee is hereby granted"}},
+      {"ISC", 0.8,
+       {"permission to use, copy, modify, and distribute this software for "
+        "any purpose with or without fee is hereby granted"}},
+      // BSD family
+      {"BSD-3-Clause", 0.9, {"bsd 3-clause"}},
+      {"BSD-2-Clause", 0.9, {"bsd 2-clause"}},
+      {"BSD-4-Clause", 0.8,
+       {"redistribution and use in source and binary forms",
+        "all advertising materials mentioning"}},
+      {"BSD-3-Clause", 0.85,
+       {"redistribution and use in source and binary forms",
+        "neither the name of"},
+       {"all advertising materials mentioning"}},
+      {"BSD-2-Clause", 0.75,
+       {"redistribution and use in source and binary forms"},
+       {"neither the name of", "all advertising materials mentioning"}},
+      {"0BSD", 0.92, {"bsd zero clause license"}},
+      {"0BSD", 0.85, {"zero-clause bsd"}},
+      // GNU
+      {"GPL-3.0", 0.9, {"gnu general public license", "version 3"}},
+      {"GPL-2.0", 0.9, {"gnu general public license", "version 2"}},
+      {"GPL", 0.6, {"gnu general public license"}},
+      {"LGPL-3.0", 0.92, {"gnu lesser general public license", "version 3"}},
+      {"LGPL-2.1", 0.92, {"gnu lesser general public license", "version 2.1"}},
+      {"LGPL-2.0", 0.92, {"gnu library general public license", "version 2"}},
+      {"LGPL", 0.6, {"gnu lesser general public license"}},
+      {"LGPL", 0.6, {"gnu library general public license"}},
+      {"AGPL-3.0", 0.95, {"gnu affero general public license"}},
+      {"GFDL-1.3", 0.9, {"gnu free documentation license", "version 1.3"}},
+      {"GFDL", 0.6, {"gnu free documentation license"}},
+      // Other common licenses
+      {"BSL-1.0", 0.95, {"boost software license"}},
+      {"MPL-2.0", 0.92, {"mozilla public license", "2.0"}},
+      {"MPL-1.1", 0.9, {"mozilla public license", "version 1.1"}},
+      {"MPL-2.0", 0.5, {"mozilla public license"}},
+      {"Zlib", 0.9, {"zlib license"}},
+      {"Zlib", 0.85, {"altered source versions must be plainly marked as such"}},
+      {"Unlicense", 0.95,
+       {"this is free and unencumbered software released into the public "
+        "domain"}},
+      {"CC0-1.0", 0.92, {"cc0 1.0 universal"}},
+      {"CC-BY-4.0", 0.9, {"creative commons attribution 4.0 international"}},
+      {"CC-BY-SA-4.0", 0.92,
+       {"creative commons attribution-sharealike 4.0 international"}},
+      {"EPL-2.0", 0.92, {"eclipse public license - v 2.0"}},
+      {"EPL-1.0", 0.92, {"eclipse public license - v 1.0"}},
+      {"CDDL-1.0", 0.85, {"common development and distribution license"}},
+      {"Artistic-2.0", 0.9, {"artistic license 2.0"}},
+      {"OpenSSL", 0.85, {"openssl license", "ssleay license"}},
+      {"curl", 0.9, {"copyright and permission notice", "daniel stenberg"}},
+      {"NCSA", 0.9, {"university of illinois/ncsa open source license"}},
+      {"Python-2.0", 0.9, {"python software foundation license"}},
+      {"PHP-3.01", 0.9, {"the php license, version 3.01"}},
+      {"PostgreSQL", 0.9, {"postgresql license"}},
+      {"WTFPL", 0.95, {"do what the fuck you want to public license"}},
+      {"BlueOak-1.0.0", 0.92, {"blue oak model license"}},
+      {"UPL-1.0", 0.92, {"universal permissive license"}},
+      {"MS-PL", 0.9, {"microsoft public license"}},
+      {"OFL-1.1", 0.9, {"sil open font license"}},
+      {"ICU", 0.8, {"icu license"}},
+      {"Unicode-DFS-2016", 0.85, {"unicode data files and software"}},
+  };
+  return list;
+}
+
+/// The tag phrase; the expression following it is copied verbatim.
+inline constexpr std::string_view SPDX_TAG = "spdx-license-identifier:";
+
+inline bool is_blank(unsigned char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/**
+ * @brief Reads the license expression after an SPDX tag.
+ */
+inline std::string tag_expression(std::string_view text, std::size_t pos) {
+  while (pos < text.size() && is_blank(static_cast<unsigned char>(text[pos])))
+    ++pos;
+  std::size_t end = pos;
+  while (end < text.size()) {
+    char c = text[end];
+    bool ok = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+              (c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+' ||
+              c == ':' || c == '(' || c == ')' || c == ' ';
+    if (!ok)
+      break;
+    ++end;
+  }
+  // No ID ends in '-': drop the blanks and dashes of a closing "-->"
+  while (end > pos && (text[end - 1] == ' ' || text[end - 1] == '-'))
+    --end;
+  return std::string(text.substr(pos, end - pos));
+}
+
+} // namespace license_detail
+
+/**
+ * @brief Classifies license texts against a fixed set of license phrases.
+ *
+ * All phrases of all rules are compiled once into an Aho-Corasick automaton
+ * with dense transitions over a reduced alphabet, so a text is classified
+ * in a single pass regardless of the number of licenses. The input is
+ * folded while it is fed: ASCII case, runs of white space (incl. line
+ * breaks) and comment leaders at line starts do not matter, so phrases
+ * also match inside wrapped source-file headers.
+ *
+ * `SPDX-License-Identifier:` tags yield their expression with confidence
+ * 1.0. Phrase matches get the rule's confidence, lowered the later their
+ * title phrase occurs (a GPL text that mentions the LGPL in its preamble is
+ * still a GPL text). Thread-safe after construction.
+ */
+class LicenseClassifier {
+public:
+  /**
+   * @brief Returns the process-wide classifier (compiled on first use).
+   */
+  static const LicenseClassifier &instance() {
+    static const LicenseClassifier classifier;
+    return classifier;
+  }
+
+  /**
+   * @brief Classifies a text.
+   *
+   * @param text The license text (typically the first
+   * LICENSE_PREFIX_BYTES of a file).
+   * @return std::vector<LicenseMatch> One entry per license, best first.
+   */
+  std::vector<LicenseMatch> classify(std::string_view text) const {
+    using namespace license_detail;
+    std::vector<std::size_t> first(patterns_.size(), NOT_SEEN);
+    std::vector<LicenseMatch> out;
+
+    // Local copies keep the tables in registers in the hot loop
+    const std::uint32_t *next = next_.data();
+    const std::uint32_t *out_begin = out_begin_.data();
+    const std::uint8_t *class_of = class_of_.data();
+    const std::size_t classes = classes_;
+    const std::uint32_t space_class = class_of_[' '];
+
+    std::uint32_t state = 0;
+    bool line_start = true;
+    bool space = false;
+    auto outputs = [&](std::size_t pos) {
+      for (std::uint32_t p = out_begin[state]; p < out_begin[state + 1]; ++p) {
+        std::uint16_t id = outputs_[p];
+        if (first[id] == NOT_SEEN)
+          first[id] = pos;
+        if (id == tag_pattern_) {
+          std::string expr = tag_expression(text, pos + 1);
+          if (!expr.empty())
+            add(out, std::move(expr), 1.0);
+        }
+      }
+    };
+    for (std::size_t i = 0; i < text.size(); ++i) {
+      auto c = static_cast<unsigned char>(text[i]);
+      switch (kind_[c]) {
+      case NEWLINE:
+        line_start = true;
+        space = true;
+        continue;
+      case BLANK:
+        space = true;
+        continue;
+      case LEADER:
+        if (line_start)
+          continue;
+        break;
+      default:
+        break;
+      }
+      line_start = false;
+      if (space) {
+        space = false;
+        state = next[state * classes + space_class];
+        if (out_begin[state] != out_begin[state + 1])
+          outputs(i);
+      }
+      state = next[state * classes + class_of[c]];
+      if (out_begin[state] != out_begin[state + 1])
+        outputs(i);
+    }
+
+    const auto &list = rules();
+    for (std::size_t r = 0; r < list.size(); ++r) {
+      bool matched = true;
+      for (auto id : rule_all_[r])
+        matched = matched && first[id] != NOT_SEEN;
+      for (auto id : rule_none_[r])
+        matched = matched && first[id] == NOT_SEEN;
+      if (!matched)
+        continue;
+      double pos = static_cast<double>(
+          std::min(first[rule_all_[r].front()], LICENSE_PREFIX_BYTES));
+      double weight = 1.0 - 0.5 * pos / LICENSE_PREFIX_BYTES;
+      add(out, list[r].spdx_id, list[r].confidence * weight);
+    }
+
+    std::stable_sort(out.begin(), out.end(),
+                     [](const LicenseMatch &a, const LicenseMatch &b) {
+                       return a.confidence > b.confidence;
+                     });
+    return out;
+  }
+
+private:
+  static constexpr std::size_t NOT_SEEN = static_cast<std::size_t>(-1);
+
+  LicenseClassifier() {
+    using namespace license_detail;
+
+    // Patterns (deduplicated) and the rules referring to them
+    auto pattern_id = [&](std::string_view p) {
+      auto it = std::find(patterns_.begin(), patterns_.end(), p);
+      if (it != patterns_.end())
+        return static_cast<std::uint16_t>(it - patterns_.begin());
+      patterns_.push_back(p);
+      return static_cast<std::uint16_t>(patterns_.size() - 1);
+    };
+    for (const auto &rule : rules()) {
+      std::vector<std::uint16_t> all, none;
+      for (auto p : rule.all)
+        all.push_back(pattern_id(p));
+      for (auto p : rule.none)
+        none.push_back(pattern_id(p));
+      rule_all_.push_back(std::move(all));
+      rule_none_.push_back(std::move(none));
+    }
+    tag_pattern_ = pattern_id(SPDX_TAG);
+
+    // Reduced alphabet: every byte used in a pattern, all others -> 0
+    class_of_.fill(0);
+    classes_ = 1;
+    for (auto p : patterns_)
+      for (unsigned char c : p)
+        if (class_of_[c] == 0)
+          class_of_[c] = static_cast<std::uint8_t>(classes_++);
+    for (unsigned c = 'A'; c <= 'Z'; ++c)
+      class_of_[c] = class_of_[c - 'A' + 'a']; // case folding
+
+    kind_.fill(CHAR);
+    kind_['\n'] = NEWLINE;
+    for (unsigned char c : std::string_view(" \t\r\f\v"))
+      kind_[c] = BLANK;
+    for (unsigned char c : std::string_view("*#/!;-%"))
+      kind_[c] = LEADER;
+
+    // Trie
+    std::vector<std::vector<std::uint32_t>> child(1);
+    std::vector<std::vector<std::uint16_t>> outs(1);
+    child[0].assign(classes_, NONE);
+    for (std::size_t id = 0; id < patterns_.size(); ++id) {
+      std::uint32_t s = 0;
+      for (unsigned char c : patterns_[id]) {
+        auto &slot = child[s][class_of_[c]];
+        if (slot == NONE) {
+          slot = static_cast<std::uint32_t>(child.size());
+          child.emplace_back(classes_, NONE);
+          outs.emplace_back();
+        }
+        s = child[s][class_of_[c]];
+      }
+      outs[s].push_back(static_cast<std::uint16_t>(id));
+    }
+
+    // Failure links (BFS), folded into dense transitions and merged outputs
+    const std::size_t states = child.size();
+    next_.assign(states * classes_, 0);
+    std::vector<std::uint32_t> fail(states, 0);
+    std::queue<std::uint32_t> queue;
+    for (std::size_t c = 0; c < classes_; ++c) {
+      std::uint32_t t = child[0][c];
+      if (t != NONE) {
+        next_[c] = t;
+        queue.push(t);
+      }
+    }
+    while (!queue.empty()) {
+      std::uint32_t s = queue.front();
+      queue.pop();
+      outs[s].insert(outs[s].end(), outs[fail[s]].begin(), outs[fail[s]].end());
+      for (std::size_t c = 0; c < classes_; ++c) {
+        std::uint32_t t = child[s][c];
+        if (t == NONE) {
+          next_[s * classes_ + c] = next_[fail[s] * classes_ + c];
+          continue;
+        }
+        fail[t] = next_[fail[s] * classes_ + c];
+        next_[s * classes_ + c] = t;
+        queue.push(t);
+      }
+    }
+
+    out_begin_.push_back(0);
+    for (const auto &o : outs) {
+      outputs_.insert(outputs_.end(), o.begin(), o.end());
+      out_begin_.push_back(static_cast<std::uint32_t>(outputs_.size()));
+    }
+  }
+
+  static void add(std::vector<LicenseMatch> &out, std::string id,
+                  double confidence) {
+    for (auto &m : out)
+      if (m.spdx_id == id) {
+        m.confidence = std::max(m.confidence, confidence);
+        return;
+      }
+    out.push_back({std::move(id), confidence});
+  }
+
+  static constexpr std::uint32_t NONE = 0xffffffffu;
+
+  /// Input byte kinds; comment leaders are skipped at line starts only.
+  enum Kind : std::uint8_t { CHAR, BLANK, NEWLINE, LEADER };
+
+  std::vector<std::string_view> patterns_;
+  std::vector<std::vector<std::uint16_t>> rule_all_;
+  std::vector<std::vector<std::uint16_t>> rule_none_;
+  std::uint16_t tag_pattern_ = 0;
+
+  std::array<std::uint8_t, 256> class_of_{}; ///< Folded byte -> class.
+  std::array<Kind, 256> kind_{};
+  std::size_t classes_ = 1;
+  std::vector<std::uint32_t> next_;      ///< states x classes transitions.
+  std::vector<std::uint32_t> out_begin_; ///< Per state (+ end).
+  std::vector<std::uint16_t> outputs_;   ///< Pattern ids ending per state.
+};
+
+/**
+ * @brief Classifies the beginning of a license file.
+ *
+ * @param path The file.
+ * @param matches Receives the detected licenses, best first.
+ * @return true If the file could be read.
+ */
+inline bool classify_license_file(const fs::path &path,
+                                  std::vector<LicenseMatch> &matches) {
+  std::string prefix;
+  if (!read_file_prefix(path, LICENSE_PREFIX_BYTES, prefix))
+    return false;
+  matches = LicenseClassifier::instance().classify(prefix);
+  return true;
+}
+
+namespace license_detail {
+
+/**
+ * @brief SPDX license identifiers known to the SBOM emitters.
+ *
+ * Covers the identifiers of the classifier rules that are on the SPDX
+ * license list (including the deprecated GNU short forms) and others that
+ * are common in package metadata. Bare family names ("GPL", "LGPL",
+ * "GFDL") are not identifiers.
+ */
+inline constexpr std::string_view SPDX_IDS[] = {
+    "0BSD", "AFL-2.1", "AFL-3.0", "AGPL-3.0", "AGPL-3.0-only",
+    "AGPL-3.0-or-later", "Apache-1.0", "Apache-1.1", "Apache-2.0",
+    "Artistic-1.0", "Artistic-2.0", "BlueOak-1.0.0", "BSD-1-Clause",
+    "BSD-2-Clause", "BSD-3-Clause", "BSD-3-Clause-Clear", "BSD-4-Clause",
+    "BSL-1.0", "bzip2-1.0.6", "CC-BY-3.0", "CC-BY-4.0", "CC-BY-SA-3.0",
+    "CC-BY-SA-4.0", "CC0-1.0", "CDDL-1.0", "CDDL-1.1", "curl", "EPL-1.0",
+    "EPL-2.0", "EUPL-1.1", "EUPL-1.2", "FTL", "GFDL-1.1", "GFDL-1.2",
+    "GFDL-1.3", "GFDL-1.3-only", "GFDL-1.3-or-later", "GPL-1.0",
+    "GPL-2.0", "GPL-2.0+", "GPL-2.0-only", "GPL-2.0-or-later", "GPL-3.0",
+    "GPL-3.0+", "GPL-3.0-only", "GPL-3.0-or-later", "ICU", "IJG", "ISC",
+    "LGPL-2.0", "LGPL-2.0+", "LGPL-2.0-only", "LGPL-2.0-or-later",
+    "LGPL-2.1", "LGPL-2.1+", "LGPL-2.1-only", "LGPL-2.1-or-later",
+    "LGPL-3.0", "LGPL-3.0+", "LGPL-3.0-only", "LGPL-3.0-or-later",
+    "Libpng", "libpng-2.0", "libtiff", "MIT", "MIT-0", "MPL-1.0", "MPL-1.1",
+    "MPL-2.0", "MS-PL", "MS-RL", "NCSA", "OFL-1.1", "OpenSSL", "PHP-3.01",
+    "PostgreSQL", "PSF-2.0", "Python-2.0", "Ruby", "Unicode-DFS-2016",
+    "Unicode-3.0", "Unlicense", "UPL-1.0", "W3C", "WTFPL", "X11", "Zlib",
+    "ZPL-2.1",
+};
+
+/// SPDX license exceptions accepted after `WITH`.
+inline constexpr std::string_view SPDX_EXCEPTIONS[] = {
+    "Autoconf-exception-2.0", "Autoconf-exception-3.0",
+    "Bison-exception-2.2", "Classpath-exception-2.0", "Font-exception-2.0",
+    "GCC-exception-2.0", "GCC-exception-3.1", "Libtool-exception",
+    "Linux-syscall-note", "LLVM-exception", "OpenSSL-exception",
+    "Qt-GPL-exception-1.0", "Qt-LGPL-exception-1.1",
+    "Universal-FOSS-exception-1.0", "WxWindows-exception-3.1",
+};
+
+inline bool iequals(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           auto lower = [](char c) {
+             return c >= 'A' && c <= 'Z' ? static_cast<char>(c + 32) : c;
+           };
+           return lower(x) == lower(y);
+         });
+}
+
+/// Canonical spelling of an identifier (SPDX matching ignores case).
+inline std::string_view find_spdx(std::span<const std::string_view> list,
+                                  std::string_view id) {
+  for (std::string_view known : list)
+    if (iequals(known, id))
+      return known;
+  return {};
+}
+
+/**
+ * @brief Checks `<id> (AND|OR|WITH) ...` with parentheses against the
+ * identifier lists.
+ */
+inline bool valid_expression(std::string_view text) {
+  std::vector<std::string_view> tokens;
+  for (std::size_t i = 0; i < text.size();) {
+    char c = text[i];
+    if (c == ' ') {
+      ++i;
+    } else if (c == '(' || c == ')') {
+      tokens.push_back(text.substr(i, 1));
+      ++i;
+    } else {
+      std::size_t end = text.find_first_of(" ()", i);
+      if (end == std::string_view::npos)
+        end = text.size();
+      tokens.push_back(text.substr(i, end - i));
+      i = end;
+    }
+  }
+
+  // Alternating operands and operators; WITH takes an exception
+  int depth = 0;
+  bool want_operand = true;
+  for (std::size_t i = 0; i < tokens.size(); ++i) {
+    std::string_view t = tokens[i];
+    if (want_operand) {
+      if (t == "(") {
+        ++depth;
+        continue;
+      }
+      bool ok = t.starts_with("LicenseRef-") ||
+                !find_spdx(SPDX_IDS, t).empty() ||
+                (t.ends_with('+') &&
+                 !find_spdx(SPDX_IDS, t.substr(0, t.size() - 1)).empty());
+      if (!ok)
+        return false;
+      want_operand = false;
+    } else if (t == ")") {
+      if (--depth < 0)
+        return false;
+    } else if (t == "AND" || t == "OR") {
+      want_operand = true;
+    } else if (t == "WITH") {
+      if (++i == tokens.size() || find_spdx(SPDX_EXCEPTIONS, tokens[i]).empty())
+        return false;
+    } else {
+      return false;
+    }
+  }
+  return !want_operand && depth == 0;
+}
+
+} // namespace license_detail
+
+/**
+ * @brief How a license string is written to an SBOM.
+ */
+enum class SpdxLicenseForm {
+  Id,         ///< A single identifier of the SPDX license list.
+  Expression, ///< A compound SPDX expression ("MIT OR Apache-2.0").
+  Name,       ///< Anything else (family names, "See file: ...", UNKNOWN).
+};
+
+/**
+ * @brief Classifies a detected license for the SBOM emitters.
+ *
+ * @param license The license string (classifier ID, tag expression or
+ * manifest value).
+ * @param canonical Receives the canonical spelling of an identifier
+ * (optional; only set for SpdxLicenseForm::Id).
+ * @return SpdxLicenseForm The form.
+ */
+inline SpdxLicenseForm spdx_license_form(std::string_view license,
+                                         std::string_view *canonical = nullptr) {
+  std::string_view id = license_detail::find_spdx(license_detail::SPDX_IDS,
+                                                  license);
+  if (!id.empty()) {
+    if (canonical)
+      *canonical = id;
+    return SpdxLicenseForm::Id;
+  }
+  if (license.find_first_of(" ()") != std::string_view::npos &&
+      license_detail::valid_expression(license))
+    return SpdxLicenseForm::Expression;
+  return SpdxLicenseForm::Name;
+}
+
+} // namespace depdiscover
@@ -7,8 +7,8 @@
  *
  * @file license_resolver.hpp
  * @brief Resolves licenses for dependencies using heuristics and file scanning.
- * @version 1.0.0
- * @date 2026-02-18
+ * @version 1.3.0
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -16,12 +16,17 @@
  * @license MIT License
  */
 #pragma once
+#include "license_classifier.hpp"
+#include "profiler.hpp"
 #include <algorithm>
+#include <cctype>
 #include <filesystem>
-#include <fstream>
 #include <map>
 #include <set>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace depdiscover {
@@ -31,55 +36,170 @@ namespace fs = std::filesystem;
 /**
  * @brief Guesses the license type from a file's content.
  *
- * Reads the first 20 lines and checks for common license keywords.
+ * Classifies the first LICENSE_PREFIX_BYTES with the LicenseClassifier
+ * and returns the best match.
  *
  * @param path The path to the file (e.g., LICENSE).
- * @return std::string The matched license (e.g., "MIT"), or "See file: ..." if ambiguous.
+ * @return std::string The matched SPDX ID (e.g., "MIT"), "See file: ..." if
+ * no license was recognized, or empty if the file cannot be read.
  */
 inline std::string guess_license_from_content(const fs::path &path) {
-  std::ifstream f(path);
-  if (!f)
+  std::vector<LicenseMatch> matches;
+  if (!classify_license_file(path, matches))
     return "";
+  if (!matches.empty())
+    return matches.front().spdx_id;
 
-  // Read only the first 20 lines for performance and relevance
-  std::string content;
-  std::string line;
-  int lines_read = 0;
-  while (std::getline(f, line) && lines_read < 20) {
-    // ToUpper for easier comparison
-    std::transform(line.begin(), line.end(), line.begin(), ::toupper);
-    content += line + "\n";
-    lines_read++;
+  // Fallback: If we found the file but don't recognize the text, return filename.
+  return "See file: " + path.filename().string();
+}
+
+/**
+ * @brief Process-wide cache of the licenses found per directory.
+ *
+ * A directory is read with one directory_iterator pass; every entry named
+ * like a license file (LICENSE, COPYING, NOTICE, ...) is classified once.
+ * Directories without license files are cached as well, so headers of a
+ * vendored tree and dependencies below the same prefix share the lookups.
+ * All methods are thread-safe.
+ */
+class LicenseDirCache {
+public:
+  /**
+   * @brief Returns the process-wide cache instance.
+   */
+  static LicenseDirCache &instance() {
+    static LicenseDirCache cache;
+    return cache;
   }
 
-  if (content.find("MIT LICENSE") != std::string::npos)
-    return "MIT";
-  if (content.find("APACHE LICENSE") != std::string::npos &&
-      content.find("VERSION 2.0") != std::string::npos)
-    return "Apache-2.0";
-  if (content.find("GNU GENERAL PUBLIC LICENSE") != std::string::npos) {
-    if (content.find("VERSION 3") != std::string::npos)
-      return "GPL-3.0";
-    if (content.find("VERSION 2") != std::string::npos)
-      return "GPL-2.0";
-    return "GPL";
+  /**
+   * @brief Returns the licenses detected in a directory.
+   *
+   * @param dir The directory.
+   * @return std::vector<std::string> The detected licenses in the order of
+   * the candidate file names (empty if there are no license files).
+   */
+  std::vector<std::string> licenses_in(const fs::path &dir) {
+    std::string key = dir.string();
+    {
+      std::shared_lock lock(mutex_);
+      auto it = dirs_.find(key);
+      if (it != dirs_.end()) {
+        Profiler::instance().count("license_dir_cache.hits");
+        return it->second.licenses;
+      }
+    }
+
+    Profiler::instance().count("license_dir_cache.misses");
+    Entry entry;
+    stat_file(key, entry.stamp);
+    std::vector<fs::path> found(candidate_names().size());
+    std::error_code ec;
+    for (fs::directory_iterator it(dir, ec), end; !ec && it != end;
+         it.increment(ec)) {
+      std::size_t c = candidate_index(it->path().filename().string());
+      std::error_code type_ec;
+      if (c < found.size() && it->is_regular_file(type_ec))
+        found[c] = it->path();
+    }
+    for (const auto &path : found) {
+      if (path.empty())
+        continue;
+      std::string detected = guess_license_from_content(path);
+      FileStamp st;
+      stat_file(path.string(), st);
+      entry.files.emplace_back(path.string(), st);
+      if (!detected.empty() &&
+          std::find(entry.licenses.begin(), entry.licenses.end(), detected) ==
+              entry.licenses.end())
+        entry.licenses.push_back(std::move(detected));
+    }
+
+    std::unique_lock lock(mutex_);
+    return dirs_.try_emplace(std::move(key), std::move(entry))
+        .first->second.licenses;
   }
-  if (content.find("GNU LESSER GENERAL PUBLIC LICENSE") != std::string::npos)
-    return "LGPL";
-  if (content.find("BOOST SOFTWARE LICENSE") != std::string::npos)
-    return "BSL-1.0";
-  if (content.find("BSD 3-CLAUSE") != std::string::npos)
-    return "BSD-3-Clause";
-  if (content.find("BSD 2-CLAUSE") != std::string::npos)
-    return "BSD-2-Clause";
-  if (content.find("MOZILLA PUBLIC LICENSE") != std::string::npos)
-    return "MPL-2.0";
-  if (content.find("ZLIB LICENSE") != std::string::npos)
-    return "Zlib";
 
-  // Fallback: If we found the file but don't recognize the text, return filename.
-  return "See file: " + path.filename().string();
-}
+  /**
+   * @brief Returns the cached directories and license files (the inputs the
+   * detected licenses depend on, e.g. for incremental scans).
+   */
+  std::vector<std::string> input_paths() const {
+    std::shared_lock lock(mutex_);
+    std::vector<std::string> out;
+    for (const auto &[dir, entry] : dirs_) {
+      out.push_back(dir);
+      for (const auto &file : entry.files)
+        out.push_back(file.first);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+  }
+
+  /**
+   * @brief Drops directories whose entries or license files changed
+   * (long-running server).
+   */
+  void refresh() {
+    std::unique_lock lock(mutex_);
+    for (auto it = dirs_.begin(); it != dirs_.end();) {
+      if (changed(it->first, it->second.stamp) ||
+          std::any_of(it->second.files.begin(), it->second.files.end(),
+                      [](const auto &f) { return changed(f.first, f.second); }))
+        it = dirs_.erase(it);
+      else
+        ++it;
+    }
+  }
+
+private:
+  struct Entry {
+    FileStamp stamp; ///< The directory when it was listed.
+    std::vector<std::pair<std::string, FileStamp>> files; ///< License files.
+    std::vector<std::string> licenses;                    ///< Detected.
+  };
+
+  static const std::vector<std::string> &candidate_names() {
+    static const std::vector<std::string> names = {
+        "LICENSE",     "LICENSE.txt", "LICENSE.md",   "COPYING",
+        "COPYING.txt", "NOTICE",      "Copyright.txt"};
+    return names;
+  }
+
+  /// Index of a license file name (candidate_names().size() if none).
+  static std::size_t candidate_index(const std::string &name) {
+    const auto &names = candidate_names();
+    for (std::size_t i = 0; i < names.size(); ++i) {
+#if defined(__APPLE__) || defined(_WIN32)
+      // Case-insensitive file systems: "license.txt" opens LICENSE.txt
+      if (name.size() == names[i].size() &&
+          std::equal(name.begin(), name.end(), names[i].begin(),
+                     [](char a, char b) {
+                       return std::tolower(static_cast<unsigned char>(a)) ==
+                              std::tolower(static_cast<unsigned char>(b));
+                     }))
+        return i;
+#else
+      if (name == names[i])
+        return i;
+#endif
+    }
+    return names.size();
+  }
+
+  static bool changed(const std::string &path, const FileStamp &old) {
+    FileStamp st;
+    stat_file(path, st);
+    return st.exists != old.exists || st.size != old.size ||
+           st.mtime != old.mtime;
+  }
+
+  LicenseDirCache() = default;
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, Entry> dirs_;
+};
 
 /**
  * @brief Resolves licenses for a package.
@@ -139,32 +259,13 @@ resolve_licenses(const std::string &package_name,
 
       // Check current directory and up to 2 levels above.
       for (int i = 0; i < 3; ++i) {
-        if (checked_dirs.contains(parent.string()))
+        if (!checked_dirs.insert(parent.string()).second)
           break;
-        checked_dirs.insert(parent.string());
-
-        // Common license filenames
-        std::vector<std::string> candidates = {
-            "LICENSE",     "LICENSE.txt", "LICENSE.md",   "COPYING",
-            "COPYING.txt", "NOTICE",      "Copyright.txt"};
-
-        for (const auto &filename : candidates) {
-          fs::path license_path = parent / filename;
-          std::error_code ec;
-          if (fs::exists(license_path, ec) &&
-              fs::is_regular_file(license_path, ec)) {
-            std::string detected = guess_license_from_content(license_path);
-            if (!detected.empty()) {
-              // Avoid duplicates
-              bool already_have = false;
-              for (const auto &l : licenses)
-                if (l == detected)
-                  already_have = true;
-              if (!already_have)
-                licenses.push_back(detected);
-            }
-          }
-        }
+
+        for (auto &detected : LicenseDirCache::instance().licenses_in(parent))
+          if (std::find(licenses.begin(), licenses.end(), detected) ==
+              licenses.end())
+            licenses.push_back(std::move(detected));
 
         if (parent.has_parent_path())
           parent = parent.parent_path();
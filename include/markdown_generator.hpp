@@ -7,8 +7,8 @@
  *
  * @file markdown_generator.hpp
  * @brief Generates a tabular Markdown security report.
- * @version 1.0.0
- * @date 2026-04-06
+ * @version 1.3.0
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -17,108 +17,84 @@
  */
 
 #pragma once
-#include "semver.hpp"
+#include "report_model.hpp"
+#include "types.hpp"
 #include <fstream>
-#include <iomanip>
-#include <nlohmann/json.hpp>
+#include <ostream>
 #include <string>
 #include <vector>
 
 namespace depdiscover {
 
-using json = nlohmann::json;
-
 /**
- * @brief Generates a tabular Markdown security report from internal JSON data.
+ * @brief Writes a tabular Markdown security report to a stream, row by row.
  *
- * @param root The root of the internal JSON data.
- * @param filepath The path where the report will be saved.
+ * @param out The output stream.
+ * @param header The report header.
+ * @param deps The dependencies.
+ * @param model The report model of `deps`.
  */
-inline void generate_markdown_report(const json &root,
-                                      const std::string &filepath) {
-  std::ofstream out(filepath);
-  if (!out) return;
-
+inline void write_markdown_report(std::ostream &out, const ReportHeader &header,
+                                  const std::vector<Dependency> &deps,
+                                  const ReportModel &model) {
   // Header Metadata
-  if (root.contains("header")) {
-    auto &h = root["header"];
-    std::string proj = h.contains("project")
-                           ? h["project"].value("name", "Unknown")
-                           : "Unknown";
-    std::string date = h.value("scan_date", "Unknown");
-    out << "# SBOM Security Report: " << proj << "\n\n";
-    out << "- **Scan Date:** " << date << "\n";
-    out << "- **Generator Tool:** "
-        << h["tool"]["name"].get<std::string>() << " v"
-        << h["tool"]["version"].get<std::string>() << "\n\n";
-  }
+  out << "# SBOM Security Report: " << header.project_name << "\n\n";
+  out << "- **Scan Date:** " << header.scan_date << "\n";
+  out << "- **Generator Tool:** " << header.tool_name << " v"
+      << header.tool_version << "\n";
+  if (model.any_vulnerability)
+    out << "- **Vulnerabilities:** " << model.vulnerabilities.size()
+        << " unique; findings: " << severity_summary(model.severities) << "\n";
+  out << "\n";
 
   // Table Header
   out << "| Package Name | Version | Fixed Version | Type | Licenses | Security Status |\n";
   out << "| :--- | :--- | :--- | :--- | :--- | :--- |\n";
 
   // Dependencies
-  if (root.contains("dependencies")) {
-    for (const auto &dep : root["dependencies"]) {
-      std::string name = dep.value("name", "Unknown");
-      std::string version = dep.value("version", "Unknown");
-      std::string type = dep.value("type", "Unknown");
-
-      // Format Licenses
-      std::string licenses = "";
-      if (dep.contains("licenses")) {
-        for (const auto &lic : dep["licenses"]) {
-          if (!licenses.empty()) licenses += ", ";
-          licenses += lic.get<std::string>();
-        }
-      }
-      if (licenses.empty()) licenses = "UNKNOWN";
-
-      // Security Status & Highest Fixed Version
-      int vuln_count = 0;
-      std::string highest_fixed = "";
-      std::string special_status = "";
-
-      if (dep.contains("cves") && !dep["cves"].empty()) {
-        for (const auto &cve : dep["cves"]) {
-          std::string id = cve.value("id", "");
-          if (id == "NOT-CHECKED") {
-              special_status = "❓ UNKNOWN";
-              continue;
-          }
-          if (id == "CHECK-ERROR") {
-              special_status = "⚠️ ERROR";
-              continue;
-          }
-          if (id == "SAFE") continue;
-
-          vuln_count++;
-          std::string fixed = cve.value("fixed_version", "");
-          if (!fixed.empty()) {
-            if (highest_fixed.empty() || compare_versions(fixed, highest_fixed) > 0) {
-              highest_fixed = fixed;
-            }
-          }
-        }
-      }
-
-      std::string status;
-      if (!special_status.empty() && vuln_count == 0) {
-        status = special_status;
-      } else if (vuln_count == 0) {
-        status = "✅ SAFE";
-      } else {
-        status = "❌ " + std::to_string(vuln_count) + " Vulnerabilities";
-      }
-
-      if (highest_fixed.empty()) highest_fixed = "-";
-
-      out << "| " << name << " | " << version << " | " << highest_fixed << " | " 
-          << type << " | " << licenses << " | " << status << " |\n";
+  for (std::size_t i = 0; i < deps.size(); ++i) {
+    const Dependency &dep = deps[i];
+    const DependencySummary &sum = model.deps[i];
+
+    out << "| " << dep.name << " | " << dep.version << " | "
+        << (sum.highest_fixed.empty() ? "-" : sum.highest_fixed) << " | "
+        << dep.type << " | ";
+
+    // Licenses
+    if (dep.licenses.empty()) {
+      out << "UNKNOWN";
+    } else {
+      for (std::size_t l = 0; l < dep.licenses.size(); ++l)
+        out << (l ? ", " : "") << dep.licenses[l];
     }
+
+    // Security Status
+    out << " | ";
+    if (!sum.special_status.empty() && sum.vuln_count == 0)
+      out << sum.special_status;
+    else if (sum.vuln_count == 0)
+      out << "✅ SAFE";
+    else
+      out << "❌ " << sum.vuln_count << " Vulnerabilities";
+    out << " |\n";
   }
 
   out << "\n---\n*Report generated by depdiscover*\n";
 }
 
+/**
+ * @brief Generates a tabular Markdown security report file.
+ *
+ * @param header The report header.
+ * @param deps The dependencies.
+ * @param filepath The path where the report will be saved.
+ */
+inline void generate_markdown_report(const ReportHeader &header,
+                                     const std::vector<Dependency> &deps,
+                                     const std::string &filepath) {
+  std::ofstream out(filepath);
+  if (!out) return;
+  write_markdown_report(out, header, deps, build_report_model(deps));
+}
+
 } // namespace depdiscover
@@ -0,0 +1,454 @@
+/**
+ * SPDX-FileComment: Native pkg-config (.pc) Resolver
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file pc_resolver.hpp
+ * @brief Indexes and parses .pc files in-process instead of running pkg-config.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "file_reader.hpp"
+#include "include_lexer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace depdiscover {
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief The fields of a parsed .pc file (variables already expanded).
+ */
+struct PcFile {
+  std::string name;                          ///< Package name (file stem).
+  std::string version;                       ///< `Version:` field.
+  std::vector<std::string> required;         ///< `Requires:` package names.
+  std::vector<std::string> required_private; ///< `Requires.private:` names.
+  std::string cflags;                        ///< `Cflags:` field.
+  std::string libs;                          ///< `Libs:` field.
+};
+
+/**
+ * @brief Flags of a package including everything it requires.
+ */
+struct PcResult {
+  std::string version;                    ///< Version of the package itself.
+  std::vector<std::string> include_paths; ///< -I values (system dirs removed).
+  std::vector<std::string> lib_names;     ///< -l values.
+};
+
+/**
+ * @brief Parses the content of a .pc file.
+ *
+ * Handles `name=value` variables with `${var}` expansion (`$$` is a literal
+ * dollar), the builtin `pcfiledir` variable and `Key: value` fields.
+ *
+ * @param content The file content.
+ * @param name The package name.
+ * @param pcfiledir The directory containing the file.
+ * @return PcFile The parsed fields.
+ */
+inline PcFile parse_pc_file(std::string_view content, const std::string &name,
+                            const std::string &pcfiledir) {
+  std::unordered_map<std::string, std::string> vars;
+  vars["pcfiledir"] = pcfiledir;
+  if (const char *sysroot = std::getenv("PKG_CONFIG_SYSROOT_DIR"))
+    vars["pc_sysrootdir"] = sysroot;
+
+  auto expand = [&vars](std::string_view in) {
+    std::string out;
+    out.reserve(in.size());
+    for (std::size_t i = 0; i < in.size(); ++i) {
+      if (in[i] == '$' && i + 1 < in.size() && in[i + 1] == '$') {
+        out += '$';
+        ++i;
+      } else if (in[i] == '$' && i + 1 < in.size() && in[i + 1] == '{') {
+        std::size_t close = in.find('}', i + 2);
+        if (close == std::string_view::npos) {
+          out += in.substr(i);
+          break;
+        }
+        auto it = vars.find(std::string(in.substr(i + 2, close - i - 2)));
+        if (it != vars.end())
+          out += it->second;
+        i = close;
+      } else {
+        out += in[i];
+      }
+    }
+    return out;
+  };
+
+  auto trim = [](std::string_view s) {
+    const char *ws = " \t\r";
+    auto b = s.find_first_not_of(ws);
+    if (b == std::string_view::npos)
+      return std::string_view{};
+    return s.substr(b, s.find_last_not_of(ws) - b + 1);
+  };
+
+  auto split_requires = [](const std::string &value) {
+    // "foo >= 1.0, bar baz" -> {foo, bar, baz}
+    std::vector<std::string> out;
+    std::string token;
+    bool skip_version = false;
+    auto flush = [&] {
+      if (token.empty())
+        return;
+      bool op = token.find_first_not_of("<>=!") == std::string::npos;
+      if (op)
+        skip_version = true;
+      else if (skip_version)
+        skip_version = false;
+      else
+        out.push_back(token);
+      token.clear();
+    };
+    for (char c : value) {
+      if (c == ',' || c == ' ' || c == '\t') {
+        flush();
+        if (c == ',')
+          skip_version = false;
+      } else if ((c == '<' || c == '>' || c == '=' || c == '!') &&
+                 !token.empty() &&
+                 token.find_first_not_of("<>=!") != std::string::npos) {
+        flush(); // "foo>=1.0"
+        token += c;
+      } else {
+        token += c;
+      }
+    }
+    flush();
+    return out;
+  };
+
+  PcFile pc;
+  pc.name = name;
+  std::string_view rest = content;
+  std::string joined; // logical line spanning backslash-newline
+  while (!rest.empty()) {
+    std::size_t nl = rest.find('\n');
+    std::string_view line = rest.substr(0, nl);
+    rest = (nl == std::string_view::npos) ? std::string_view{}
+                                          : rest.substr(nl + 1);
+    if (!line.empty() && line.back() == '\r')
+      line.remove_suffix(1);
+    if (!line.empty() && line.back() == '\\') {
+      joined += line.substr(0, line.size() - 1);
+      continue;
+    }
+    std::string logical;
+    if (!joined.empty()) {
+      logical = std::move(joined);
+      logical += line;
+      joined.clear();
+      line = logical;
+    }
+
+    if (auto hash = line.find('#'); hash != std::string_view::npos)
+      line = line.substr(0, hash);
+    line = trim(line);
+    if (line.empty())
+      continue;
+
+    std::size_t sep = line.find_first_of("=:");
+    if (sep == std::string_view::npos)
+      continue;
+    std::string key(trim(line.substr(0, sep)));
+    std::string value = expand(trim(line.substr(sep + 1)));
+
+    if (line[sep] == '=') {
+      vars[key] = value;
+    } else if (key == "Version") {
+      pc.version = value;
+    } else if (key == "Requires") {
+      pc.required = split_requires(value);
+    } else if (key == "Requires.private") {
+      pc.required_private = split_requires(value);
+    } else if (key == "Cflags" || key == "CFlags") {
+      pc.cflags = value;
+    } else if (key == "Libs") {
+      pc.libs = value;
+    }
+  }
+  return pc;
+}
+
+/**
+ * @brief In-memory index of all .pc files on the pkg-config search path.
+ *
+ * The search path (`PKG_CONFIG_PATH`, then `PKG_CONFIG_LIBDIR` or the
+ * default directories) is listed once; files are parsed on first use and
+ * memoized. Like pkg-config, the first file of a name on the path wins,
+ * `Requires` and `Requires.private` contribute include paths, only
+ * `Requires` contributes libraries, and system include directories are
+ * dropped. Thread-safe.
+ */
+class PcResolver {
+public:
+  /**
+   * @brief Returns the process-wide resolver (indexes on first use).
+   */
+  static PcResolver &instance() {
+    static PcResolver resolver;
+    return resolver;
+  }
+
+  /**
+   * @brief Resolves a package including its requirements.
+   *
+   * @param name The package name.
+   * @return std::optional<PcResult> The result, or nullopt if the package or
+   * one of its requirements is not installed.
+   */
+  std::optional<PcResult> query(const std::string &name) {
+    auto root = load(name);
+    if (!root)
+      return std::nullopt;
+
+    std::map<std::string, std::vector<std::shared_ptr<const PcFile>>> memo;
+    std::vector<std::shared_ptr<const PcFile>> all, pub;
+    std::set<std::string> active;
+    if (!flatten(root, true, memo, active, all))
+      return std::nullopt; // pkg-config fails on missing requirements
+    memo.clear();
+    flatten(root, false, memo, active, pub);
+
+    PcResult result;
+    result.version = root->version;
+
+    std::set<std::string> seen_inc;
+    for (const auto &pc : all) {
+      std::vector<std::string> incs;
+      collect_flag_values(split_command_line(pc->cflags), "-I", incs);
+      for (auto &inc : incs) {
+        if (is_system_include(inc))
+          continue;
+        if (!sysroot_.empty() && inc.rfind(sysroot_, 0) != 0)
+          inc = sysroot_ + inc;
+        if (seen_inc.insert(inc).second)
+          result.include_paths.push_back(std::move(inc));
+      }
+    }
+
+    std::vector<std::string> libs;
+    for (const auto &pc : pub)
+      collect_flag_values(split_command_line(pc->libs), "-l", libs);
+    result.lib_names = keep_last(libs, [](const auto &l) { return l; });
+    return result;
+  }
+
+  /**
+   * @brief Re-indexes the search directories and forgets parsed files
+   * (long-running server).
+   */
+  void refresh() {
+    std::lock_guard lock(mutex_);
+    parsed_.clear();
+    index_.clear();
+    build_index();
+  }
+
+  /**
+   * @brief Number of indexed .pc files.
+   */
+  std::size_t indexed_count() const { return index_.size(); }
+
+  /**
+   * @brief Returns the searched directories and the indexed .pc files (the
+   * inputs a query result depends on).
+   */
+  std::vector<std::string> input_paths() const {
+    std::vector<std::string> out = search_dirs_;
+    for (const auto &[name, path] : index_)
+      out.push_back(path.string());
+    return out;
+  }
+
+private:
+  PcResolver() {
+    if (const char *sysroot = std::getenv("PKG_CONFIG_SYSROOT_DIR"))
+      sysroot_ = sysroot;
+    build_index();
+
+    const char *sys = std::getenv("PKG_CONFIG_SYSTEM_INCLUDE_PATH");
+    for (const auto &dir : split_path_list(sys ? sys : "/usr/include"))
+      system_includes_.insert(fs::path(dir).lexically_normal().string());
+    allow_system_cflags_ = std::getenv("PKG_CONFIG_ALLOW_SYSTEM_CFLAGS");
+  }
+
+  static std::vector<std::string> split_path_list(const std::string &list) {
+#ifdef _WIN32
+    const char sep = ';';
+#else
+    const char sep = ':';
+#endif
+    std::vector<std::string> out;
+    std::size_t start = 0;
+    while (start <= list.size()) {
+      std::size_t end = list.find(sep, start);
+      if (end == std::string::npos)
+        end = list.size();
+      if (end > start)
+        out.push_back(list.substr(start, end - start));
+      start = end + 1;
+    }
+    return out;
+  }
+
+  static std::vector<std::string> default_search_dirs() {
+    std::vector<std::string> dirs;
+    // Multiarch directories (e.g., /usr/lib/x86_64-linux-gnu/pkgconfig)
+    auto multiarch = [&dirs](const fs::path &lib) {
+      std::error_code ec;
+      std::vector<std::string> found;
+      for (const auto &e : fs::directory_iterator(lib, ec))
+        if (e.is_directory(ec) && fs::is_directory(e.path() / "pkgconfig", ec))
+          found.push_back((e.path() / "pkgconfig").string());
+      std::sort(found.begin(), found.end());
+      dirs.insert(dirs.end(), found.begin(), found.end());
+    };
+    multiarch("/usr/local/lib");
+    dirs.push_back("/usr/local/lib/pkgconfig");
+    dirs.push_back("/usr/local/share/pkgconfig");
+    multiarch("/usr/lib");
+    dirs.push_back("/usr/lib64/pkgconfig");
+    dirs.push_back("/usr/lib/pkgconfig");
+    dirs.push_back("/usr/share/pkgconfig");
+#ifdef __APPLE__
+    dirs.push_back("/opt/homebrew/lib/pkgconfig");
+    dirs.push_back("/opt/homebrew/share/pkgconfig");
+#endif
+    return dirs;
+  }
+
+  void build_index() {
+    std::vector<std::string> dirs;
+    if (const char *p = std::getenv("PKG_CONFIG_PATH"))
+      dirs = split_path_list(p);
+    if (const char *libdir = std::getenv("PKG_CONFIG_LIBDIR")) {
+      auto more = split_path_list(libdir);
+      dirs.insert(dirs.end(), more.begin(), more.end());
+    } else {
+      auto more = default_search_dirs();
+      dirs.insert(dirs.end(), more.begin(), more.end());
+    }
+
+    search_dirs_ = dirs;
+    for (const auto &dir : dirs) {
+      std::error_code ec;
+      for (const auto &e : fs::directory_iterator(dir, ec)) {
+        const auto &p = e.path();
+        if (p.extension() == ".pc")
+          index_.try_emplace(p.stem().string(), p); // first on the path wins
+      }
+    }
+  }
+
+  std::shared_ptr<const PcFile> load(const std::string &name) {
+    std::lock_guard lock(mutex_);
+    if (auto it = parsed_.find(name); it != parsed_.end())
+      return it->second;
+
+    std::shared_ptr<const PcFile> pc;
+    if (auto it = index_.find(name); it != index_.end()) {
+      MappedFile file(it->second);
+      if (file.is_open())
+        pc = std::make_shared<PcFile>(parse_pc_file(
+            file.view(), name, it->second.parent_path().string()));
+    }
+    parsed_[name] = pc;
+    return pc;
+  }
+
+  /**
+   * @brief Removes duplicates, keeping the last occurrence of each key.
+   */
+  template <class T, class Key>
+  static std::vector<T> keep_last(const std::vector<T> &in, Key key) {
+    std::vector<T> out;
+    std::set<std::string> seen;
+    for (auto it = in.rbegin(); it != in.rend(); ++it)
+      if (seen.insert(key(*it)).second)
+        out.push_back(*it);
+    return {out.rbegin(), out.rend()};
+  }
+
+  /**
+   * @brief Orders a package and its requirements like pkg-config: each
+   * package followed by its requirements, keeping the last occurrence, so a
+   * package always precedes everything it depends on.
+   *
+   * @param pc The package.
+   * @param with_private Also follow `Requires.private`.
+   * @param memo Per-query memo of already flattened packages.
+   * @param active Packages on the current path (cycle guard).
+   * @param out Receives the ordered packages.
+   * @return false If a requirement is not installed.
+   */
+  bool flatten(const std::shared_ptr<const PcFile> &pc, bool with_private,
+               std::map<std::string,
+                        std::vector<std::shared_ptr<const PcFile>>> &memo,
+               std::set<std::string> &active,
+               std::vector<std::shared_ptr<const PcFile>> &out) {
+    if (auto it = memo.find(pc->name); it != memo.end()) {
+      out = it->second;
+      return true;
+    }
+    std::vector<std::shared_ptr<const PcFile>> seq{pc};
+    active.insert(pc->name);
+    std::vector<std::string> deps = pc->required;
+    if (with_private)
+      deps.insert(deps.end(), pc->required_private.begin(),
+                  pc->required_private.end());
+    for (const auto &dep_name : deps) {
+      if (active.count(dep_name))
+        continue;
+      auto dep = load(dep_name);
+      std::vector<std::shared_ptr<const PcFile>> sub;
+      if (!dep || !flatten(dep, with_private, memo, active, sub)) {
+        active.erase(pc->name);
+        return false;
+      }
+      seq.insert(seq.end(), sub.begin(), sub.end());
+    }
+    active.erase(pc->name);
+    out = keep_last(seq, [](const auto &p) { return p->name; });
+    memo[pc->name] = out;
+    return true;
+  }
+
+  bool is_system_include(const std::string &dir) const {
+    return !allow_system_cflags_ &&
+           system_includes_.count(fs::path(dir).lexically_normal().string());
+  }
+
+  std::vector<std::string> search_dirs_;
+  std::map<std::string, fs::path> index_;
+  std::set<std::string> system_includes_;
+  bool allow_system_cflags_ = false;
+  std::string sysroot_;
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<const PcFile>> parsed_;
+};
+
+} // namespace depdiscover
@@ -7,8 +7,8 @@
  *
  * @file pkg_config.hpp
  * @brief Wrapper class for querying pkg-config.
- * @version 1.0.0
- * @date 2026-02-18
+ * @version 1.1.0
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -16,6 +16,7 @@
  * @license MIT License
  */
 #pragma once
+#include "pc_resolver.hpp"
 #include <array>
 #include <cstdio>
 #include <iostream>
@@ -38,9 +39,24 @@ struct PkgInfo {
 
 /**
  * @brief Static class for querying pkg-config.
+ *
+ * By default packages are resolved by the in-process PcResolver; the
+ * `pkg-config` executable is only used when enabled via use_executable().
  */
 class PkgConfig {
 public:
+  /**
+   * @brief Switches between the native resolver and the executable.
+   *
+   * @param enable If true, every query spawns `pkg-config` (three times).
+   */
+  static void use_executable(bool enable) { use_exec_flag() = enable; }
+
+  /**
+   * @brief Checks whether the executable is used instead of the resolver.
+   */
+  static bool executable_mode() { return use_exec_flag(); }
+
   /**
    * @brief Queries pkg-config for a specific package.
    *
@@ -48,6 +64,26 @@ public:
    * @return PkgInfo The result of the query.
    */
   static PkgInfo query(const std::string &package_name) {
+    if (use_exec_flag())
+      return query_exec(package_name);
+
+    PkgInfo info;
+    if (auto pc = PcResolver::instance().query(package_name)) {
+      info.found = true;
+      info.version = std::move(pc->version);
+      info.include_paths = std::move(pc->include_paths);
+      info.lib_names = std::move(pc->lib_names);
+    }
+    return info;
+  }
+
+  /**
+   * @brief Queries the `pkg-config` executable for a specific package.
+   *
+   * @param package_name The name of the package.
+   * @return PkgInfo The result of the query.
+   */
+  static PkgInfo query_exec(const std::string &package_name) {
     PkgInfo info;
 
     // Retrieve version
@@ -74,6 +110,11 @@ public:
   }
 
 private:
+  static bool &use_exec_flag() {
+    static bool flag = false;
+    return flag;
+  }
+
   /**
    * @brief Executes a shell command and returns the output.
    *
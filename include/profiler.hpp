@@ -0,0 +1,468 @@
+/**
+ * SPDX-FileComment: Scan Profiler
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file profiler.hpp
+ * @brief Per-phase timing, counters and Chrome trace export (--profile).
+ * @version 1.1.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "json_writer.hpp"
+
+namespace depdiscover {
+
+/**
+ * @brief Read counters of the process (`/proc/self/io`, Linux only).
+ */
+struct IoCounters {
+  std::uint64_t syscalls = 0;   ///< Read syscalls (syscr).
+  std::uint64_t bytes_read = 0; ///< Bytes read, including the page cache (rchar).
+  bool available = false;       ///< False if the counters cannot be read.
+
+  /**
+   * @brief Takes a snapshot of the current counters.
+   */
+  static IoCounters read() {
+    IoCounters io;
+#ifdef __linux__
+    std::FILE *f = std::fopen("/proc/self/io", "r");
+    if (!f)
+      return io;
+    char name[32];
+    unsigned long long value = 0;
+    while (std::fscanf(f, "%31[^:]: %llu\n", name, &value) == 2) {
+      std::string_view n(name);
+      if (n == "syscr")
+        io.syscalls = value;
+      else if (n == "rchar")
+        io.bytes_read = value;
+    }
+    std::fclose(f);
+    io.available = true;
+#endif
+    return io;
+  }
+};
+
+/**
+ * @brief How a ProfileScope is recorded.
+ */
+enum class ProfileKind {
+  Phase,     ///< Top-level pipeline phase: traced, with I/O counters.
+  Stage,     ///< Phase on its own thread, overlapping others: traced.
+  Task,      ///< Unit of work inside a phase (may run on a worker): traced.
+  Accumulate ///< Hot inner step: only summed into the table, not traced.
+};
+
+/**
+ * @brief Process-wide collector of scan timings and counters.
+ *
+ * Disabled by default; every recording call returns immediately unless a
+ * profiled scan is running, so the instrumentation stays in release
+ * builds. start() clears the previous scan (server mode). Thread-safe.
+ */
+class Profiler {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /**
+   * @brief Returns the process-wide profiler instance.
+   */
+  static Profiler &instance() {
+    static Profiler profiler;
+    return profiler;
+  }
+
+  Profiler(const Profiler &) = delete;
+  Profiler &operator=(const Profiler &) = delete;
+
+  /**
+   * @brief Discards previous results and starts recording.
+   */
+  void start() {
+    std::lock_guard lock(mutex_);
+    phases_.clear();
+    phase_order_.clear();
+    events_.clear();
+    counters_.clear();
+    samples_.clear();
+    origin_ = clock::now();
+    main_tid_ = thread_index();
+    enabled_.store(true, std::memory_order_release);
+  }
+
+  /**
+   * @brief Stops recording (the results stay available).
+   */
+  void stop() {
+    std::lock_guard lock(mutex_);
+    enabled_.store(false, std::memory_order_release);
+    end_ = clock::now();
+  }
+
+  /**
+   * @brief True while a profiled scan is running.
+   */
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Records one finished scope.
+   *
+   * @param name The phase or task name.
+   * @param kind How to record it.
+   * @param detail Optional detail shown in the trace (e.g., the file).
+   * @param begin Start time.
+   * @param end End time.
+   * @param items Items processed (added to the phase total).
+   * @param io I/O counter delta (Phase only; may be null).
+   */
+  void record(std::string_view name, ProfileKind kind, std::string_view detail,
+              clock::time_point begin, clock::time_point end,
+              std::uint64_t items, const IoCounters *io) {
+    if (!enabled())
+      return;
+    auto dur = micros(end - begin);
+    unsigned tid = thread_index();
+    std::lock_guard lock(mutex_);
+    auto &phase = phase_of(name);
+    auto ts = micros(begin - origin_);
+    if (phase.calls == 0 || ts < phase.first_us)
+      phase.first_us = ts;
+    phase.calls++;
+    phase.total_us += dur;
+    phase.items += items;
+    phase.kind = kind;
+    if (io && io->available) {
+      phase.io = true;
+      phase.syscalls += io->syscalls;
+      phase.bytes_read += io->bytes_read;
+    }
+    if (kind != ProfileKind::Accumulate)
+      events_.push_back(
+          {std::string(name), std::string(detail), ts, dur, items, tid, kind});
+  }
+
+  /**
+   * @brief Adds to a named counter (e.g., `header_cache.hits`).
+   *
+   * Counter pairs `<name>.hits` / `<name>.misses` are shown as hit rate.
+   */
+  void count(std::string_view name, std::uint64_t n = 1) {
+    if (!enabled())
+      return;
+    std::lock_guard lock(mutex_);
+    counters_[std::string(name)] += n;
+  }
+
+  /**
+   * @brief Records one latency sample in milliseconds (e.g., an HTTP
+   * request), reported as percentiles.
+   */
+  void sample(std::string_view name, double ms) {
+    if (!enabled())
+      return;
+    std::lock_guard lock(mutex_);
+    samples_[std::string(name)].push_back(ms);
+  }
+
+  /**
+   * @brief Prints the summary table (one `[Profile]` line per row).
+   *
+   * @param out The stream (std::cerr).
+   */
+  void print_summary(std::ostream &out) const {
+    std::lock_guard lock(mutex_);
+    auto line = [&]() -> std::ostream & { return out << "[Profile] "; };
+    auto fixed = [](double v, int precision) {
+      std::ostringstream s;
+      s << std::fixed << std::setprecision(precision) << v;
+      return s.str();
+    };
+
+    out << "\n";
+    line() << std::left << std::setw(24) << "Phase" << std::right
+           << std::setw(8) << "Calls" << std::setw(12) << "Time ms"
+           << std::setw(10) << "Items" << std::setw(11) << "Syscalls"
+           << std::setw(12) << "Read KiB" << "\n";
+    // Phases in order of their first start, nested steps below their phase
+    std::vector<std::string> order = phase_order_;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](const std::string &a, const std::string &b) {
+                       return phases_.at(a).first_us < phases_.at(b).first_us;
+                     });
+    bool summed = false, concurrent = false;
+    for (const auto &name : order) {
+      const auto &p = phases_.at(name);
+      std::string label = name;
+      if (p.kind == ProfileKind::Stage) {
+        label += " ||";
+        concurrent = true;
+      } else if (p.kind != ProfileKind::Phase) {
+        label = "  " + label + "*";
+        summed = true;
+      }
+      line() << std::left << std::setw(24) << label << std::right
+             << std::setw(8) << p.calls << std::setw(12)
+             << fixed(double(p.total_us) / 1000.0, 2) << std::setw(10)
+             << (p.items ? std::to_string(p.items) : "-") << std::setw(11)
+             << (p.io ? std::to_string(p.syscalls) : "-") << std::setw(12)
+             << (p.io ? fixed(double(p.bytes_read) / 1024.0, 1) : "-")
+             << "\n";
+    }
+    line() << std::left << std::setw(24) << "total" << std::right
+           << std::setw(8) << "" << std::setw(12)
+           << fixed(double(micros(end_ - origin_)) / 1000.0, 2) << "\n";
+    if (summed)
+      line() << "* nested step, time summed over all threads\n";
+    if (concurrent)
+      line() << "|| stage overlapping the other phases (own thread)\n";
+
+    std::string shown_base;
+    for (const auto &[name, value] : counters_) {
+      std::string_view n = name;
+      std::string_view base;
+      if (n.ends_with(".hits"))
+        base = n.substr(0, n.size() - 5);
+      else if (n.ends_with(".misses"))
+        base = n.substr(0, n.size() - 7);
+      if (base.empty()) {
+        line() << name << ": " << value << "\n";
+        continue;
+      }
+      if (base == shown_base)
+        continue; // ".hits" sorts right after ".misses"
+      shown_base = base;
+      auto value_of = [&](const char *suffix) -> std::uint64_t {
+        auto it = counters_.find(std::string(base) + suffix);
+        return it == counters_.end() ? 0 : it->second;
+      };
+      std::uint64_t hits = value_of(".hits"), misses = value_of(".misses");
+      std::uint64_t total = hits + misses;
+      line() << base << ": " << hits << " hits, " << misses << " misses ("
+             << fixed(total ? 100.0 * double(hits) / double(total) : 0.0, 1)
+             << "% hit rate)\n";
+    }
+
+    for (const auto &[name, values] : samples_) {
+      if (values.empty())
+        continue;
+      std::vector<double> sorted = values;
+      std::sort(sorted.begin(), sorted.end());
+      // Nearest-rank percentiles
+      auto pct = [&](double p) {
+        auto rank = static_cast<std::size_t>(
+            std::ceil(p / 100.0 * double(sorted.size())));
+        return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+      };
+      line() << name << " latency: n=" << sorted.size()
+             << " p50=" << fixed(pct(50), 1) << " p90=" << fixed(pct(90), 1)
+             << " p99=" << fixed(pct(99), 1)
+             << " max=" << fixed(sorted.back(), 1) << " ms\n";
+    }
+  }
+
+  /**
+   * @brief Writes the recorded events as Chrome trace-event JSON (loadable
+   * in Perfetto or chrome://tracing).
+   *
+   * @param path The output file.
+   * @return true On success.
+   */
+  bool write_trace(const std::string &path) const {
+    std::ofstream out(path);
+    if (!out.is_open())
+      return false;
+    std::lock_guard lock(mutex_);
+    JsonWriter w(out, -1);
+    w.begin_object().key("traceEvents").begin_array();
+
+    std::vector<unsigned> tids;
+    for (const auto &e : events_)
+      if (std::find(tids.begin(), tids.end(), e.tid) == tids.end())
+        tids.push_back(e.tid);
+    for (unsigned tid : tids) {
+      std::string thread_name =
+          tid == main_tid_ ? "main" : "worker " + std::to_string(tid);
+      w.begin_object()
+          .key("name").value("thread_name")
+          .key("ph").value("M")
+          .key("pid").value(1)
+          .key("tid").value(std::int64_t(tid))
+          .key("args").begin_object().key("name").value(thread_name).end_object()
+          .end_object();
+    }
+
+    for (const auto &e : events_) {
+      w.begin_object()
+          .key("name").value(e.name)
+          .key("cat").value(e.kind == ProfileKind::Task ? "task" : "phase")
+          .key("ph").value("X")
+          .key("ts").value(e.ts_us)
+          .key("dur").value(e.dur_us)
+          .key("pid").value(1)
+          .key("tid").value(std::int64_t(e.tid));
+      if (!e.detail.empty() || e.items) {
+        w.key("args").begin_object();
+        if (!e.detail.empty())
+          w.key("detail").value(e.detail);
+        if (e.items)
+          w.key("items").value(std::int64_t(e.items));
+        w.end_object();
+      }
+      w.end_object();
+    }
+
+    // Counters as one sample at the end of the scan
+    if (!counters_.empty()) {
+      w.begin_object()
+          .key("name").value("counters")
+          .key("ph").value("C")
+          .key("ts").value(micros(end_ - origin_))
+          .key("pid").value(1)
+          .key("args").begin_object();
+      for (const auto &[name, value] : counters_)
+        w.key(name).value(std::int64_t(value));
+      w.end_object().end_object();
+    }
+
+    w.end_array().key("displayTimeUnit").value("ms").end_object();
+    out << "\n";
+    return !out.fail();
+  }
+
+private:
+  struct PhaseStats {
+    std::size_t calls = 0;
+    std::int64_t total_us = 0;
+    std::uint64_t items = 0;
+    std::uint64_t syscalls = 0;
+    std::uint64_t bytes_read = 0;
+    std::int64_t first_us = 0; ///< Earliest start (table order).
+    bool io = false;
+    ProfileKind kind = ProfileKind::Phase;
+  };
+
+  struct Event {
+    std::string name;
+    std::string detail;
+    std::int64_t ts_us;
+    std::int64_t dur_us;
+    std::uint64_t items;
+    unsigned tid;
+    ProfileKind kind;
+  };
+
+  Profiler() = default;
+
+  static std::int64_t micros(clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+  }
+
+  /// Small, stable per-thread number for the trace.
+  static unsigned thread_index() {
+    static std::atomic<unsigned> next{0};
+    thread_local unsigned index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+
+  /// Returns the stats of a phase (in order of first appearance).
+  PhaseStats &phase_of(std::string_view name) {
+    auto it = phases_.find(std::string(name));
+    if (it != phases_.end())
+      return it->second;
+    phase_order_.emplace_back(name);
+    return phases_[std::string(name)];
+  }
+
+  mutable std::mutex mutex_;
+  std::atomic<bool> enabled_{false};
+  clock::time_point origin_{};
+  clock::time_point end_{};
+  unsigned main_tid_ = 0;
+  std::unordered_map<std::string, PhaseStats> phases_;
+  std::vector<std::string> phase_order_;
+  std::vector<Event> events_;
+  std::map<std::string, std::uint64_t> counters_;
+  std::map<std::string, std::vector<double>> samples_;
+};
+
+/**
+ * @brief Times the enclosing block while a profiled scan is running.
+ *
+ * `name` and `detail` must outlive the scope (string literals or strings
+ * of the caller).
+ */
+class ProfileScope {
+public:
+  explicit ProfileScope(std::string_view name,
+                        ProfileKind kind = ProfileKind::Phase,
+                        std::string_view detail = {})
+      : active_(Profiler::instance().enabled()), name_(name), detail_(detail),
+        kind_(kind) {
+    if (!active_)
+      return;
+    if (kind_ == ProfileKind::Phase)
+      io_ = IoCounters::read();
+    begin_ = Profiler::clock::now();
+  }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+  ~ProfileScope() {
+    if (!active_)
+      return;
+    auto end = Profiler::clock::now();
+    IoCounters delta;
+    if (kind_ == ProfileKind::Phase && io_.available) {
+      IoCounters now = IoCounters::read();
+      delta.available = now.available;
+      delta.syscalls = now.syscalls - io_.syscalls;
+      delta.bytes_read = now.bytes_read - io_.bytes_read;
+    }
+    Profiler::instance().record(name_, kind_, detail_, begin_, end, items_,
+                                &delta);
+  }
+
+  /**
+   * @brief Sets the number of items processed in this scope.
+   */
+  void items(std::uint64_t n) { items_ = n; }
+
+private:
+  bool active_;
+  std::string_view name_;
+  std::string_view detail_;
+  ProfileKind kind_;
+  std::uint64_t items_ = 0;
+  IoCounters io_;
+  Profiler::clock::time_point begin_{};
+};
+
+} // namespace depdiscover
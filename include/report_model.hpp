@@ -0,0 +1,240 @@
+/**
+ * SPDX-FileComment: Shared Report Model
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file report_model.hpp
+ * @brief Summaries, vulnerability index and bom-refs computed once for all
+ * report emitters.
+ * @version 1.1.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "semver.hpp"
+#include "types.hpp"
+#include <array>
+#include <cstddef>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace depdiscover {
+
+/**
+ * @brief True for the internal status markers that are no vulnerabilities.
+ */
+inline bool is_cve_marker(const std::string &id) {
+  return id == "SAFE" || id == "NOT-CHECKED" || id == "CHECK-ERROR";
+}
+
+/**
+ * @brief Returns the advisory link for a vulnerability ID.
+ */
+inline std::string advisory_url(const std::string &id) {
+  if (id.find("CVE-") == 0)
+    return "https://nvd.nist.gov/vuln/detail/" + id;
+  if (id.find("GHSA-") == 0)
+    return "https://github.com/advisories/" + id;
+  return "https://osv.dev/vulnerability/" + id;
+}
+
+/**
+ * @brief Severity levels of the report (CycloneDX rating severities).
+ */
+enum class SeverityLevel { Critical, High, Medium, Low, Unknown };
+
+/// Lower-case names of the levels, indexed by SeverityLevel.
+inline constexpr std::array<const char *, 5> SEVERITY_LEVEL_NAMES = {
+    "critical", "high", "medium", "low", "unknown"};
+
+/**
+ * @brief Maps a numeric score (or, without score, the severity word) to a
+ * severity level.
+ */
+inline SeverityLevel severity_level(double score,
+                                    const std::string &severity_str) {
+  if (score >= 9.0) return SeverityLevel::Critical;
+  if (score >= 7.0) return SeverityLevel::High;
+  if (score >= 4.0) return SeverityLevel::Medium;
+  if (score >= 0.1) return SeverityLevel::Low;
+  if (severity_str == "CRITICAL" || severity_str == "critical") return SeverityLevel::Critical;
+  if (severity_str == "HIGH" || severity_str == "high") return SeverityLevel::High;
+  if (severity_str == "MEDIUM" || severity_str == "medium") return SeverityLevel::Medium;
+  if (severity_str == "LOW" || severity_str == "low") return SeverityLevel::Low;
+  return SeverityLevel::Unknown;
+}
+
+/**
+ * @brief Everything the emitters derive from one dependency.
+ */
+struct DependencySummary {
+  std::string purl;                      ///< Package URL.
+  std::string bom_ref;                   ///< Unique CycloneDX reference.
+  std::vector<std::string> advisory_urls; ///< Link per entry of `cves`.
+
+  /// The CVE list is a real finding list (first entry is no marker).
+  bool listed = false;
+  int active_vulns = 0;     ///< Unsuppressed entries (if `listed`).
+  int suppressed_vulns = 0; ///< Suppressed entries (if `listed`).
+  double max_score = 0.0;   ///< Highest unsuppressed score (if `listed`).
+  std::set<std::string> unique_fixes; ///< Unsuppressed fixed versions.
+
+  int vuln_count = 0;         ///< Entries other than markers.
+  std::string special_status; ///< Status text of the last non-SAFE marker.
+  std::string highest_fixed;  ///< Highest fixed version over all findings.
+};
+
+/**
+ * @brief One vulnerability ID and every dependency it was reported for.
+ */
+struct VulnerabilityEntry {
+  std::size_t dep = 0; ///< Dependency of the first finding (its details).
+  std::size_t cve = 0; ///< Index of the first finding in `cves`.
+  std::vector<std::size_t> affected; ///< Dependency indices, in list order.
+};
+
+/**
+ * @brief Number of findings per severity level.
+ */
+struct SeverityHistogram {
+  std::array<int, 5> active{}; ///< Unsuppressed findings, by SeverityLevel.
+  int suppressed = 0;          ///< Suppressed findings (any level).
+
+  int total_active() const {
+    int n = 0;
+    for (int c : active)
+      n += c;
+    return n;
+  }
+};
+
+/**
+ * @brief One-line summary of a histogram, e.g. "1 critical, 2 high
+ * (1 suppressed)".
+ */
+inline std::string severity_summary(const SeverityHistogram &h) {
+  std::string out;
+  for (std::size_t l = 0; l < h.active.size(); ++l) {
+    if (h.active[l] == 0)
+      continue;
+    if (!out.empty())
+      out += ", ";
+    out += std::to_string(h.active[l]) + " " + SEVERITY_LEVEL_NAMES[l];
+  }
+  if (out.empty())
+    out = "none active";
+  if (h.suppressed > 0)
+    out += " (" + std::to_string(h.suppressed) + " suppressed)";
+  return out;
+}
+
+/**
+ * @brief The precomputed model shared by all report emitters.
+ */
+struct ReportModel {
+  std::vector<DependencySummary> deps; ///< One summary per dependency.
+  bool any_vulnerability = false;      ///< Some entry is no marker.
+  /// Vulnerability IDs in order of first appearance (markers excluded).
+  std::vector<VulnerabilityEntry> vulnerabilities;
+  SeverityHistogram severities; ///< Over all non-marker findings.
+};
+
+/**
+ * @brief Summarizes one dependency.
+ */
+inline DependencySummary summarize_dependency(const Dependency &dep) {
+  DependencySummary s;
+  s.purl = "pkg:generic/" + dep.name + "@" + dep.version;
+  s.advisory_urls.reserve(dep.cves.size());
+  for (const auto &cve : dep.cves)
+    s.advisory_urls.push_back(advisory_url(cve.id));
+
+  s.listed = !dep.cves.empty() && !is_cve_marker(dep.cves.front().id);
+  if (s.listed) {
+    for (const auto &cve : dep.cves) {
+      if (cve.suppressed) {
+        s.suppressed_vulns++;
+        continue;
+      }
+      s.active_vulns++;
+      if (cve.score > s.max_score)
+        s.max_score = cve.score;
+      if (!cve.fixed_version.empty())
+        s.unique_fixes.insert(cve.fixed_version);
+    }
+  }
+
+  for (const auto &cve : dep.cves) {
+    if (cve.id == "NOT-CHECKED") {
+      s.special_status = "❓ UNKNOWN";
+      continue;
+    }
+    if (cve.id == "CHECK-ERROR") {
+      s.special_status = "⚠️ ERROR";
+      continue;
+    }
+    if (cve.id == "SAFE")
+      continue;
+
+    s.vuln_count++;
+    const std::string &fixed = cve.fixed_version;
+    if (!fixed.empty() && (s.highest_fixed.empty() ||
+                           compare_versions(fixed, s.highest_fixed) > 0))
+      s.highest_fixed = fixed;
+  }
+  return s;
+}
+
+/**
+ * @brief Builds the report model for a dependency list.
+ *
+ * @param deps The dependencies.
+ * @return ReportModel The model (summaries in the order of `deps`).
+ */
+inline ReportModel build_report_model(const std::vector<Dependency> &deps) {
+  ReportModel model;
+  model.deps.reserve(deps.size());
+  std::unordered_map<std::string, std::size_t> bom_refs;
+  std::unordered_map<std::string, std::size_t> vuln_index;
+  for (std::size_t i = 0; i < deps.size(); ++i) {
+    model.deps.push_back(summarize_dependency(deps[i]));
+    DependencySummary &sum = model.deps.back();
+    if (sum.vuln_count > 0)
+      model.any_vulnerability = true;
+
+    // Components with the same name and version still need distinct refs
+    std::size_t seen = bom_refs[sum.purl]++;
+    sum.bom_ref = seen == 0 ? sum.purl
+                            : sum.purl + "#" + std::to_string(seen + 1);
+
+    for (std::size_t c = 0; c < deps[i].cves.size(); ++c) {
+      const CVE &cve = deps[i].cves[c];
+      if (is_cve_marker(cve.id))
+        continue;
+      if (cve.suppressed)
+        model.severities.suppressed++;
+      else
+        model.severities
+            .active[std::size_t(severity_level(cve.score, cve.severity))]++;
+
+      auto [it, inserted] =
+          vuln_index.try_emplace(cve.id, model.vulnerabilities.size());
+      if (inserted)
+        model.vulnerabilities.push_back({i, c, {}});
+      auto &affected = model.vulnerabilities[it->second].affected;
+      if (affected.empty() || affected.back() != i)
+        affected.push_back(i);
+    }
+  }
+  return model;
+}
+
+} // namespace depdiscover
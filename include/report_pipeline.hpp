@@ -0,0 +1,160 @@
+/**
+ * SPDX-FileComment: Report Pipeline
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file report_pipeline.hpp
+ * @brief Writes all requested report formats concurrently.
+ * @version 1.1.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "binary_sbom.hpp"
+#include "cyclonedx_generator.hpp"
+#include "html_generator.hpp"
+#include "json_generator.hpp"
+#include "markdown_generator.hpp"
+#include "profiler.hpp"
+#include "report_model.hpp"
+#include "thread_pool.hpp"
+#include "types.hpp"
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace depdiscover {
+
+/**
+ * @brief The report files to write (empty path: format not requested).
+ */
+struct ReportTargets {
+  std::string json_path;
+  std::string html_path;
+  std::string markdown_path;
+  std::string cyclonedx_path;
+  std::string binary_path;             ///< Binary SBOM (`--save`).
+  std::string *compact_json = nullptr; ///< Receives the compact JSON report.
+};
+
+/**
+ * @brief Outcome of one report file.
+ */
+struct ReportResult {
+  std::string format; ///< "json", "html", "markdown", "cyclonedx", "binary".
+  std::string path;   ///< The target path.
+  bool ok = false;    ///< Opened and written without stream errors.
+};
+
+namespace report_detail {
+
+/// Stream buffer per report file; the emitters issue many small writes.
+constexpr std::size_t BUFFER_SIZE = 1 << 20;
+
+/**
+ * @brief An output file with a large user-supplied stream buffer.
+ */
+struct BufferedFile {
+  std::unique_ptr<char[]> buffer{new char[BUFFER_SIZE]};
+  std::ofstream stream;
+
+  bool open(const std::string &path, std::ios::openmode mode) {
+    // The buffer has to be installed before opening to take effect
+    stream.rdbuf()->pubsetbuf(buffer.get(), BUFFER_SIZE);
+    stream.open(path, mode);
+    return stream.is_open();
+  }
+};
+
+} // namespace report_detail
+
+/**
+ * @brief Writes all requested reports, one emitter per pool task.
+ *
+ * The report model is computed once and shared by the HTML, Markdown and
+ * CycloneDX emitters; each emitter writes its own file through a 1 MiB
+ * buffer, so the stage takes about as long as the slowest format. The
+ * files are opened up front on the calling thread: if the JSON report
+ * cannot be created, nothing else is written.
+ *
+ * @param header The report header.
+ * @param deps The dependencies.
+ * @param targets The requested outputs.
+ * @param pool The pool to run the emitters on.
+ * @return std::vector<ReportResult> One result per requested file, in the
+ * order json, html, markdown, cyclonedx, binary (empty if the JSON failed
+ * to open).
+ */
+inline std::vector<ReportResult>
+write_reports(const ReportHeader &header, const std::vector<Dependency> &deps,
+              const ReportTargets &targets, ThreadPool &pool) {
+  std::vector<ReportResult> results;
+  std::vector<std::unique_ptr<report_detail::BufferedFile>> files;
+  std::vector<std::function<void(std::ostream &)>> emitters;
+  const ReportModel model = build_report_model(deps);
+
+  auto add = [&](const char *format, const std::string &path,
+                 std::function<void(std::ostream &)> emit,
+                 std::ios::openmode mode = std::ios::out) {
+    if (path.empty())
+      return true;
+    auto file = std::make_unique<report_detail::BufferedFile>();
+    bool opened = file->open(path, mode);
+    results.push_back({format, path, opened});
+    files.push_back(opened ? std::move(file) : nullptr);
+    emitters.push_back(std::move(emit));
+    return opened;
+  };
+
+  if (!add("json", targets.json_path, [&](std::ostream &out) {
+        write_json_report(out, header, deps);
+      }))
+    return {};
+  add("html", targets.html_path, [&](std::ostream &out) {
+    write_html_report(out, header, deps, model);
+  });
+  add("markdown", targets.markdown_path, [&](std::ostream &out) {
+    write_markdown_report(out, header, deps, model);
+  });
+  add("cyclonedx", targets.cyclonedx_path, [&](std::ostream &out) {
+    write_cyclonedx_report(out, header, deps, model);
+  });
+  add(
+      "binary", targets.binary_path,
+      [&](std::ostream &out) { write_binary_sbom(out, header, deps); },
+      std::ios::out | std::ios::binary);
+
+  // The compact report (scan server) is one more task without a file
+  std::size_t tasks = emitters.size() + (targets.compact_json ? 1 : 0);
+  pool.parallel_chunks<bool>(tasks, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      if (i == emitters.size()) {
+        ProfileScope task("report", ProfileKind::Task, "compact json");
+        std::ostringstream compact;
+        write_json_report(compact, header, deps, -1);
+        *targets.compact_json = std::move(compact).str();
+        continue;
+      }
+      auto &file = files[i];
+      if (!file)
+        continue;
+      ProfileScope task("report", ProfileKind::Task, results[i].format);
+      emitters[i](file->stream);
+      file->stream.close();
+      results[i].ok = !file->stream.fail();
+    }
+    return true;
+  });
+  return results;
+}
+
+} // namespace depdiscover
@@ -0,0 +1,403 @@
+/**
+ * SPDX-FileComment: SBOM Diff
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file sbom_diff.hpp
+ * @brief Compares two scan results (JSON or binary SBOM).
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "binary_sbom.hpp"
+#include "json_writer.hpp"
+#include "report_model.hpp"
+#include "semver.hpp"
+#include "types.hpp"
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace depdiscover {
+
+/**
+ * @brief Loads a scan result from a JSON report or a binary SBOM.
+ *
+ * The format is detected from the content (binary SBOM magic).
+ *
+ * @param path The report file.
+ * @param header Receives the report header.
+ * @param deps Receives the dependencies.
+ * @param error Receives a description on failure.
+ * @param with_paths False leaves the header and library lists empty.
+ * @return true On success.
+ */
+inline bool load_scan_result(const std::string &path, ReportHeader &header,
+                             std::vector<Dependency> &deps,
+                             std::string &error, bool with_paths = true) {
+  {
+    std::ifstream probe(path, std::ios::binary);
+    if (!probe) {
+      error = "cannot read file";
+      return false;
+    }
+    char magic[sizeof(sbom_detail::MAGIC)] = {};
+    probe.read(magic, sizeof(magic));
+    if (probe.gcount() == sizeof(magic) &&
+        std::memcmp(magic, sbom_detail::MAGIC, sizeof(magic)) == 0) {
+      BinarySbom sbom;
+      if (!sbom.open(path, &error))
+        return false;
+      header = sbom.report_header();
+      deps = sbom.dependencies(with_paths);
+      return true;
+    }
+  }
+
+  std::ifstream f(path);
+  nlohmann::json root = nlohmann::json::parse(f, nullptr, false);
+  if (root.is_discarded() || !root.is_object() ||
+      !root.contains("dependencies") || !root["dependencies"].is_array()) {
+    error = "neither a depdiscover JSON report nor a binary SBOM";
+    return false;
+  }
+  try {
+    deps = root["dependencies"].get<std::vector<Dependency>>();
+    if (!with_paths)
+      for (auto &d : deps) {
+        d.headers.clear();
+        d.libraries.clear();
+      }
+    const auto h = root.value("header", nlohmann::json::object());
+    const auto tool = h.value("tool", nlohmann::json::object());
+    const auto project = h.value("project", nlohmann::json::object());
+    header.schema_version = h.value("schema_version", "");
+    header.scan_date = h.value("scan_date", "");
+    header.tool_name = tool.value("name", "");
+    header.tool_version = tool.value("version", "");
+    header.tool_description = tool.value("description", "");
+    header.tool_homepage = tool.value("homepage", "");
+    header.tool_author = tool.value("author", "");
+    header.project_name = project.value("name", "");
+    header.workspace_root = project.value("workspace_root", "");
+  } catch (const std::exception &e) {
+    error = e.what();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief A dependency present in both scans with a different version.
+ */
+struct VersionChange {
+  std::size_t old_index = 0;
+  std::size_t new_index = 0;
+  std::string kind; ///< "upgrade", "downgrade" or "changed" (same release).
+};
+
+/**
+ * @brief A vulnerability that appeared or disappeared.
+ */
+struct CveChange {
+  std::size_t dep_index = 0; ///< In the new scan (new) or old scan (fixed).
+  std::size_t cve_index = 0;
+};
+
+/**
+ * @brief Result of comparing two scans.
+ */
+struct SbomDiff {
+  std::vector<std::size_t> added;   ///< Indexes into the new scan.
+  std::vector<std::size_t> removed; ///< Indexes into the old scan.
+  std::vector<VersionChange> changed;
+  std::vector<CveChange> new_cves;   ///< Active in new, not active before.
+  std::vector<CveChange> fixed_cves; ///< Active before, not active in new.
+  std::size_t upgraded = 0;
+  std::size_t downgraded = 0;
+};
+
+namespace diff_detail {
+
+/// Active (unsuppressed, no marker) vulnerability.
+inline bool is_active(const CVE &c) {
+  return !c.suppressed && !is_cve_marker(c.id);
+}
+
+/**
+ * @brief Package identities: type and name, plus an occurrence number so
+ * duplicate entries pair up in report order.
+ */
+inline std::vector<std::string> identities(const std::vector<Dependency> &deps) {
+  std::unordered_map<std::string, std::size_t> seen;
+  std::vector<std::string> out;
+  out.reserve(deps.size());
+  for (const auto &d : deps) {
+    std::string key = d.type;
+    key.append(1, '\0').append(d.name);
+    std::size_t n = seen[key]++;
+    key.append(1, '\0').append(std::to_string(n));
+    out.push_back(std::move(key));
+  }
+  return out;
+}
+
+/// Active CVEs of `from` whose IDs are not active in `other` (may be null).
+inline void cves_not_in(const Dependency &from, std::size_t from_index,
+                        const Dependency *other, std::vector<CveChange> &out) {
+  std::unordered_set<std::string_view> ids;
+  if (other)
+    for (const auto &c : other->cves)
+      if (is_active(c))
+        ids.insert(c.id);
+  for (std::size_t k = 0; k < from.cves.size(); ++k)
+    if (is_active(from.cves[k]) && !ids.count(from.cves[k].id))
+      out.push_back({from_index, k});
+}
+
+} // namespace diff_detail
+
+/**
+ * @brief Compares two dependency lists.
+ *
+ * Dependencies are matched through a hash index over their identity (type
+ * and name), so the comparison is linear in the size of both scans.
+ *
+ * @param old_deps The baseline scan.
+ * @param new_deps The scan to compare.
+ * @return SbomDiff The differences (in report order).
+ */
+inline SbomDiff diff_sboms(const std::vector<Dependency> &old_deps,
+                           const std::vector<Dependency> &new_deps) {
+  SbomDiff diff;
+  const auto old_ids = diff_detail::identities(old_deps);
+  const auto new_ids = diff_detail::identities(new_deps);
+
+  std::unordered_map<std::string_view, std::size_t> old_index;
+  old_index.reserve(old_ids.size());
+  for (std::size_t i = 0; i < old_ids.size(); ++i)
+    old_index.emplace(old_ids[i], i);
+
+  std::vector<bool> matched(old_deps.size(), false);
+  for (std::size_t n = 0; n < new_deps.size(); ++n) {
+    const Dependency &nd = new_deps[n];
+    auto it = old_index.find(new_ids[n]);
+    if (it == old_index.end()) {
+      diff.added.push_back(n);
+      diff_detail::cves_not_in(nd, n, nullptr, diff.new_cves);
+      continue;
+    }
+    const std::size_t o = it->second;
+    const Dependency &od = old_deps[o];
+    matched[o] = true;
+
+    if (od.version != nd.version) {
+      VersionChange change{o, n, "changed"};
+      if (clean_version(od.version) != clean_version(nd.version)) {
+        int cmp = compare_versions(nd.version, od.version);
+        if (cmp > 0) {
+          change.kind = "upgrade";
+          diff.upgraded++;
+        } else if (cmp < 0) {
+          change.kind = "downgrade";
+          diff.downgraded++;
+        }
+      }
+      diff.changed.push_back(std::move(change));
+    }
+    diff_detail::cves_not_in(nd, n, &od, diff.new_cves);
+  }
+
+  for (std::size_t o = 0; o < old_deps.size(); ++o)
+    if (!matched[o])
+      diff.removed.push_back(o);
+
+  // Fixed: active before and gone (or suppressed) now; removed packages
+  // take their vulnerabilities with them
+  std::unordered_map<std::string_view, std::size_t> new_index;
+  new_index.reserve(new_ids.size());
+  for (std::size_t i = 0; i < new_ids.size(); ++i)
+    new_index.emplace(new_ids[i], i);
+  for (std::size_t o = 0; o < old_deps.size(); ++o) {
+    auto it = new_index.find(old_ids[o]);
+    diff_detail::cves_not_in(old_deps[o], o,
+                             it == new_index.end() ? nullptr
+                                                   : &new_deps[it->second],
+                             diff.fixed_cves);
+  }
+  return diff;
+}
+
+/**
+ * @brief Writes a diff as JSON (members sorted like the other reports).
+ *
+ * @param out The output stream.
+ * @param old_header Header of the baseline scan.
+ * @param old_deps The baseline scan.
+ * @param new_header Header of the compared scan.
+ * @param new_deps The compared scan.
+ * @param diff The differences.
+ */
+inline void write_diff_json(std::ostream &out, const ReportHeader &old_header,
+                            const std::vector<Dependency> &old_deps,
+                            const ReportHeader &new_header,
+                            const std::vector<Dependency> &new_deps,
+                            const SbomDiff &diff) {
+  JsonWriter w(out, 2);
+  auto package = [&](const Dependency &d) {
+    w.begin_object()
+        .key("name").value(d.name)
+        .key("type").value(d.type)
+        .key("version").value(d.version)
+        .end_object();
+  };
+  auto cves = [&](const char *key, const std::vector<CveChange> &list,
+                  const std::vector<Dependency> &deps) {
+    w.key(key).begin_array();
+    for (const auto &c : list) {
+      const Dependency &d = deps[c.dep_index];
+      const CVE &cve = d.cves[c.cve_index];
+      w.begin_object()
+          .key("dependency").value(d.name)
+          .key("fixed_version").value(cve.fixed_version)
+          .key("id").value(cve.id)
+          .key("score").value(cve.score)
+          .key("severity").value(cve.severity)
+          .key("summary").value(cve.summary)
+          .key("version").value(d.version)
+          .end_object();
+    }
+    w.end_array();
+  };
+  auto scan = [&](const char *key, const ReportHeader &h) {
+    w.key(key).begin_object()
+        .key("project").value(h.project_name)
+        .key("scan_date").value(h.scan_date)
+        .key("tool_version").value(h.tool_version)
+        .end_object();
+  };
+
+  w.begin_object().key("added").begin_array();
+  for (auto n : diff.added)
+    package(new_deps[n]);
+  w.end_array().key("changed").begin_array();
+  for (const auto &c : diff.changed)
+    w.begin_object()
+        .key("change").value(c.kind)
+        .key("name").value(new_deps[c.new_index].name)
+        .key("new_version").value(new_deps[c.new_index].version)
+        .key("old_version").value(old_deps[c.old_index].version)
+        .key("type").value(new_deps[c.new_index].type)
+        .end_object();
+  w.end_array();
+  cves("fixed_cves", diff.fixed_cves, old_deps);
+  w.key("header").begin_object();
+  scan("new", new_header);
+  scan("old", old_header);
+  w.end_object();
+  cves("new_cves", diff.new_cves, new_deps);
+  w.key("removed").begin_array();
+  for (auto o : diff.removed)
+    package(old_deps[o]);
+  w.end_array()
+      .key("summary").begin_object()
+      .key("added").value(std::int64_t(diff.added.size()))
+      .key("changed").value(std::int64_t(diff.changed.size()))
+      .key("downgraded").value(std::int64_t(diff.downgraded))
+      .key("fixed_cves").value(std::int64_t(diff.fixed_cves.size()))
+      .key("new_cves").value(std::int64_t(diff.new_cves.size()))
+      .key("removed").value(std::int64_t(diff.removed.size()))
+      .key("upgraded").value(std::int64_t(diff.upgraded))
+      .end_object()
+      .end_object();
+}
+
+/**
+ * @brief Writes a diff as Markdown (e.g. for PR comments).
+ *
+ * Parameters as for write_diff_json().
+ */
+inline void write_diff_markdown(std::ostream &out,
+                                const ReportHeader &old_header,
+                                const std::vector<Dependency> &old_deps,
+                                const ReportHeader &new_header,
+                                const std::vector<Dependency> &new_deps,
+                                const SbomDiff &diff) {
+  auto score = [](double s) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1) << s;
+    return ss.str();
+  };
+  auto or_dash = [](const std::string &s) { return s.empty() ? "-" : s; };
+
+  out << "# SBOM Diff: " << new_header.project_name << "\n\n";
+  out << "- **Old Scan:** " << old_header.scan_date << " ("
+      << old_header.project_name << ")\n";
+  out << "- **New Scan:** " << new_header.scan_date << " ("
+      << new_header.project_name << ")\n\n";
+
+  out << "| Added | Removed | Upgraded | Downgraded | Changed | New CVEs | "
+         "Fixed CVEs |\n";
+  out << "| ---: | ---: | ---: | ---: | ---: | ---: | ---: |\n";
+  out << "| " << diff.added.size() << " | " << diff.removed.size() << " | "
+      << diff.upgraded << " | " << diff.downgraded << " | "
+      << diff.changed.size() - diff.upgraded - diff.downgraded << " | "
+      << diff.new_cves.size() << " | " << diff.fixed_cves.size() << " |\n";
+
+  if (!diff.added.empty() || !diff.removed.empty() || !diff.changed.empty()) {
+    out << "\n## Dependency Changes\n\n";
+    out << "| Change | Package | Type | Old Version | New Version |\n";
+    out << "| :--- | :--- | :--- | :--- | :--- |\n";
+    for (auto n : diff.added)
+      out << "| ➕ added | " << new_deps[n].name << " | " << new_deps[n].type
+          << " | - | " << or_dash(new_deps[n].version) << " |\n";
+    for (auto o : diff.removed)
+      out << "| ➖ removed | " << old_deps[o].name << " | " << old_deps[o].type
+          << " | " << or_dash(old_deps[o].version) << " | - |\n";
+    for (const auto &c : diff.changed) {
+      const char *label = c.kind == "upgrade"     ? "⬆️ upgrade"
+                          : c.kind == "downgrade" ? "⬇️ downgrade"
+                                                  : "🔄 changed";
+      out << "| " << label << " | " << new_deps[c.new_index].name << " | "
+          << new_deps[c.new_index].type << " | "
+          << or_dash(old_deps[c.old_index].version) << " | "
+          << or_dash(new_deps[c.new_index].version) << " |\n";
+    }
+  }
+
+  auto cve_table = [&](const char *title, const std::vector<CveChange> &list,
+                       const std::vector<Dependency> &deps) {
+    if (list.empty())
+      return;
+    out << "\n## " << title << "\n\n";
+    out << "| Package | Version | ID | Score | Fixed Version |\n";
+    out << "| :--- | :--- | :--- | ---: | :--- |\n";
+    for (const auto &c : list) {
+      const Dependency &d = deps[c.dep_index];
+      const CVE &cve = d.cves[c.cve_index];
+      out << "| " << d.name << " | " << or_dash(d.version) << " | [" << cve.id
+          << "](" << advisory_url(cve.id) << ") | "
+          << (cve.score > 0.0 ? score(cve.score) : "-") << " | "
+          << or_dash(cve.fixed_version) << " |\n";
+    }
+  };
+  cve_table("❌ New Vulnerabilities", diff.new_cves, new_deps);
+  cve_table("✅ Fixed Vulnerabilities", diff.fixed_cves, old_deps);
+
+  out << "\n---\n*Report generated by depdiscover*\n";
+}
+
+} // namespace depdiscover
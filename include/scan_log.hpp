@@ -0,0 +1,78 @@
+/**
+ * SPDX-FileComment: Scan Progress Log
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file scan_log.hpp
+ * @brief Progress output that pipeline stages can buffer per thread.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace depdiscover {
+
+namespace scan_log_detail {
+/// The calling thread's log target (nullptr: std::cerr).
+inline std::ostream *&thread_target() {
+  thread_local std::ostream *target = nullptr;
+  return target;
+}
+} // namespace scan_log_detail
+
+/**
+ * @brief Returns the progress stream of the calling thread.
+ *
+ * This is std::cerr unless the thread runs a pipeline stage that buffers
+ * its output (ScanLogCapture).
+ */
+inline std::ostream &scan_log() {
+  std::ostream *target = scan_log_detail::thread_target();
+  return target ? *target : std::cerr;
+}
+
+/**
+ * @brief Buffers the scan_log() output of the current thread.
+ *
+ * A stage running concurrently with the main thread collects its lines
+ * here; the main thread prints them when it joins the stage, so the log
+ * keeps the order of the serial scan and std::cerr (which the scan server
+ * redirects to a plain string buffer) is only written by one thread.
+ */
+class ScanLogCapture {
+public:
+  /**
+   * @brief Starts buffering.
+   *
+   * @param out Receives the buffered text when the capture ends.
+   */
+  explicit ScanLogCapture(std::string &out)
+      : out_(out), previous_(scan_log_detail::thread_target()) {
+    scan_log_detail::thread_target() = &buffer_;
+  }
+
+  ScanLogCapture(const ScanLogCapture &) = delete;
+  ScanLogCapture &operator=(const ScanLogCapture &) = delete;
+
+  ~ScanLogCapture() {
+    scan_log_detail::thread_target() = previous_;
+    out_ += std::move(buffer_).str();
+  }
+
+private:
+  std::string &out_;
+  std::ostream *previous_;
+  std::ostringstream buffer_;
+};
+
+} // namespace depdiscover
@@ -0,0 +1,1460 @@
+/**
+ * SPDX-FileComment: Scan Pipeline
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file scan_runner.hpp
+ * @brief Command-line options and the complete scan of one project.
+ * @version 1.6.6
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// External Libraries
+#include <nlohmann/json.hpp>
+
+// Project Configuration
+#include "rz_config.hpp"
+
+// Core Components
+#include "binary_sbom.hpp"
+#include "compile_commands.hpp"
+#include "dependency_mapper.hpp"
+#include "dependency_registry.hpp"
+#include "elf_scanner.hpp"
+#include "header_resolver.hpp"
+#include "http_client.hpp"
+#include "include_graph.hpp"
+#include "include_scanner.hpp"
+#include "pc_resolver.hpp"
+#include "pkg_config.hpp"
+#include "profiler.hpp"
+#include "sbom_diff.hpp"
+#include "scan_log.hpp"
+#include "scan_state.hpp"
+#include "string_pool.hpp"
+#include "thread_pool.hpp"
+#include "types.hpp"
+
+// Parsers
+#include "cmake_fetch_parser.hpp"
+#include "cmake_libs_parser.hpp"
+#include "conan_parser.hpp"
+#include "vcpkg_parser.hpp"
+
+// Metadata & Output Resolvers
+#include "cve_cache.hpp"
+#include "cve_resolver.hpp"
+#include "report_pipeline.hpp"
+#include "license_resolver.hpp"
+
+namespace depdiscover {
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+/**
+ * @brief Current schema version for the generated JSON report.
+ */
+inline constexpr auto SCHEMA_VERSION = "1.2";
+
+/**
+ * @brief Identifies the current OS platform.
+ *
+ * @return std::string "Windows", "macOS", "Linux" or "Unknown".
+ */
+inline std::string get_platform_name() {
+#if defined(_WIN32) || defined(_WIN64)
+  return "Windows";
+#elif defined(__APPLE__) || defined(__MACH__)
+  return "macOS";
+#elif defined(__linux__)
+  return "Linux";
+#else
+  return "Unknown";
+#endif
+}
+
+/**
+ * @brief Returns the default path of a report in `data/reports`.
+ *
+ * @param suffix The file name after the date and platform prefix.
+ * @return std::string The relative path.
+ */
+inline std::string default_report_path(const std::string &suffix) {
+  return "data/reports/" + get_current_date() + "_" + get_platform_name() +
+         suffix;
+}
+
+/**
+ * @brief All command-line options of a scan.
+ */
+struct ScanOptions {
+  bool show_help = false;    ///< -h: print usage and exit.
+  bool only_version = false; ///< --version.
+  bool only_check = false;   ///< --check-version.
+
+  std::string cc_path = "compile_commands.json";
+  std::string libs_txt_path = "libs.txt";
+  std::vector<std::string> binary_paths;
+  bool elf_closure = false;
+  std::string vcpkg_path = "vcpkg.json";
+  std::string conan_path = "conanfile.txt";
+  std::string cmake_lists_path = "CMakeLists.txt";
+
+  std::string output_path = ""; ///< Empty: data/reports default.
+  std::string project_name = "Unknown Project";
+  std::string ecosystem = "Debian";
+  std::string html_path = "";
+  std::string markdown_path = "";
+  std::string cyclonedx_path = "";
+
+  std::string suppressions_path = "";
+
+  double fail_on_cvss = 11.0; ///< > 10: build breaker disabled.
+
+  HttpOptions http_options;
+
+  unsigned jobs = 0; ///< 0: number of CPU cores.
+
+  bool transitive_includes = false;
+  IncludeGraphOptions include_graph_options;
+
+  std::string cve_cache_dir = "";
+  double cve_cache_ttl_hours = 24.0;
+  bool offline = false;
+  bool incremental = false;
+  std::string state_path = "data/depdiscover_state.json";
+  bool pkg_config_exec = false;
+
+  std::string save_path; ///< --save: also write a binary SBOM.
+  std::string load_path; ///< --load: re-emit a binary SBOM, no scan.
+  std::string diff_old;  ///< --diff: baseline report (JSON or binary).
+  std::string diff_new;  ///< --diff: report to compare.
+
+  bool profile = false;      ///< --profile: print phase timings.
+  std::string profile_trace; ///< --profile-trace: Chrome trace file.
+
+  std::string serve_socket;   ///< --serve: run as scan server.
+  std::string connect_socket; ///< --connect: forward the scan to a server.
+  std::string batch_path;     ///< --batch: scan the projects of a list.
+
+  /// Without a CVE cache directory, keep OSV results in memory for later
+  /// scans of the same process (set by --batch).
+  bool share_cve_results = false;
+};
+
+/**
+ * @brief Parses command-line arguments (without the program name).
+ *
+ * Errors are reported on std::cerr. `-h` stops parsing and sets
+ * `show_help`.
+ *
+ * @param args The arguments.
+ * @param o Receives the options.
+ * @return int 0 on success, 1 on invalid arguments.
+ */
+inline int parse_scan_args(const std::vector<std::string> &args,
+                           ScanOptions &o) {
+  const int argc = static_cast<int>(args.size());
+  for (int i = 0; i < argc; ++i) {
+    const std::string &arg = args[i];
+    if (arg == "-h" || arg == "--help") {
+      o.show_help = true;
+      return 0;
+    } else if (arg == "--version") {
+      o.only_version = true;
+    } else if (arg == "--check-version") {
+      o.only_check = true;
+    } else if (arg == "-c" || arg == "--compile-commands") {
+      if (i + 1 < argc)
+        o.cc_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-l" || arg == "--libs") {
+      if (i + 1 < argc)
+        o.libs_txt_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-b" || arg == "--binary") {
+      if (i + 1 < argc)
+        o.binary_paths.push_back(args[++i]);
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-v" || arg == "--vcpkg") {
+      if (i + 1 < argc)
+        o.vcpkg_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-C" || arg == "--conan") {
+      if (i + 1 < argc)
+        o.conan_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-m" || arg == "--cmake") {
+      if (i + 1 < argc)
+        o.cmake_lists_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-o" || arg == "--output") {
+      if (i + 1 < argc)
+        o.output_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-n" || arg == "--name") {
+      if (i + 1 < argc)
+        o.project_name = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-e" || arg == "--ecosystem") {
+      if (i + 1 < argc)
+        o.ecosystem = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires an ecosystem name.\n";
+        return 1;
+      }
+    } else if (arg == "-H" || arg == "--html") {
+      if (i + 1 < argc)
+        o.html_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-M" || arg == "--markdown") {
+      if (i + 1 < argc)
+        o.markdown_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-x" || arg == "--cyclonedx") {
+      if (i + 1 < argc)
+        o.cyclonedx_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-f" || arg == "--fail-on-cvss") {
+      if (i + 1 < argc) {
+        try {
+          o.fail_on_cvss = std::stod(args[++i]);
+        } catch (...) {
+          std::cerr
+              << "Error: --fail-on-cvss requires a valid number (e.g., 7.0).\n";
+          return 1;
+        }
+      } else {
+        std::cerr << "Error: " << arg << " requires a score.\n";
+        return 1;
+      }
+    } else if (arg == "-s" || arg == "--suppressions") {
+      if (i + 1 < argc)
+        o.suppressions_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "-j" || arg == "--jobs") {
+      if (i + 1 < argc) {
+        try {
+          o.jobs = static_cast<unsigned>(std::stoul(args[++i]));
+        } catch (...) {
+          std::cerr << "Error: --jobs requires a valid number.\n";
+          return 1;
+        }
+      } else {
+        std::cerr << "Error: " << arg << " requires a number.\n";
+        return 1;
+      }
+    } else if (arg == "--transitive-includes") {
+      o.transitive_includes = true;
+    } else if (arg == "--include-depth") {
+      if (i + 1 < argc) {
+        try {
+          o.include_graph_options.max_depth = std::stoi(args[++i]);
+        } catch (...) {
+          std::cerr << "Error: --include-depth requires a valid number.\n";
+          return 1;
+        }
+      } else {
+        std::cerr << "Error: " << arg << " requires a number.\n";
+        return 1;
+      }
+    } else if (arg == "--include-preamble-only") {
+      o.include_graph_options.preamble_only = true;
+    } else if (arg == "--elf-closure") {
+      o.elf_closure = true;
+    } else if (arg == "--include-max-size") {
+      if (i + 1 < argc) {
+        try {
+          o.include_graph_options.max_file_size =
+              static_cast<std::uintmax_t>(std::stoull(args[++i])) * 1024;
+        } catch (...) {
+          std::cerr << "Error: --include-max-size requires a valid number.\n";
+          return 1;
+        }
+      } else {
+        std::cerr << "Error: " << arg << " requires a size in KB.\n";
+        return 1;
+      }
+    } else if (arg == "--cve-cache-dir") {
+      if (i + 1 < argc)
+        o.cve_cache_dir = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "--cve-cache-ttl") {
+      if (i + 1 < argc) {
+        try {
+          o.cve_cache_ttl_hours = std::stod(args[++i]);
+        } catch (...) {
+          std::cerr << "Error: --cve-cache-ttl requires a valid number.\n";
+          return 1;
+        }
+      } else {
+        std::cerr << "Error: " << arg << " requires a number of hours.\n";
+        return 1;
+      }
+    } else if (arg == "--offline") {
+      o.offline = true;
+    } else if (arg == "--incremental") {
+      o.incremental = true;
+    } else if (arg == "--state-file") {
+      if (i + 1 < argc) {
+        o.state_path = args[++i];
+        o.incremental = true;
+      } else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "--save") {
+      if (i + 1 < argc)
+        o.save_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "--load") {
+      if (i + 1 < argc)
+        o.load_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a path.\n";
+        return 1;
+      }
+    } else if (arg == "--diff") {
+      if (i + 2 < argc) {
+        o.diff_old = args[++i];
+        o.diff_new = args[++i];
+      } else {
+        std::cerr << "Error: " << arg << " requires two report paths.\n";
+        return 1;
+      }
+    } else if (arg == "--serve") {
+      if (i + 1 < argc)
+        o.serve_socket = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a socket path.\n";
+        return 1;
+      }
+    } else if (arg == "--connect") {
+      if (i + 1 < argc)
+        o.connect_socket = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a socket path.\n";
+        return 1;
+      }
+    } else if (arg == "--batch") {
+      if (i + 1 < argc)
+        o.batch_path = args[++i];
+      else {
+        std::cerr << "Error: " << arg << " requires a file path.\n";
+        return 1;
+      }
+    } else if (arg == "--profile") {
+      o.profile = true;
+    } else if (arg == "--profile-trace") {
+      if (i + 1 < argc) {
+        o.profile_trace = args[++i];
+        o.profile = true;
+      } else {
+        std::cerr << "Error: " << arg << " requires a file path.\n";
+        return 1;
+      }
+    } else if (arg == "--pkg-config-exec") {
+      o.pkg_config_exec = true;
+    } else if (arg == "--net-jobs") {
+      if (i + 1 < argc) {
+        try {
+          o.http_options.max_concurrency = std::stoi(args[++i]);
+        } catch (...) {
+          std::cerr << "Error: --net-jobs requires a valid number.\n";
+          return 1;
+        }
+      } else {
+        std::cerr << "Error: " << arg << " requires a number.\n";
+        return 1;
+      }
+    } else if (arg == "--net-timeout") {
+      if (i + 1 < argc) {
+        try {
+          o.http_options.timeout_ms =
+              static_cast<long>(std::stod(args[++i]) * 1000.0);
+        } catch (...) {
+          std::cerr << "Error: --net-timeout requires a valid number.\n";
+          return 1;
+        }
+      } else {
+        std::cerr << "Error: " << arg << " requires a number of seconds.\n";
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Long-lived state shared by consecutive scans of one process.
+ *
+ * Owns the worker pool, the ELF parse memo and the opened CVE caches. The
+ * process-wide caches (header resolution, include graph, pkg-config index)
+ * are revalidated by begin_scan() before every scan but the first, so a
+ * server answers later requests from warm caches without serving stale
+ * results.
+ */
+class ScanContext {
+public:
+  /**
+   * @brief Creates the context.
+   *
+   * @param jobs Number of pool workers (0: number of CPU cores).
+   */
+  explicit ScanContext(unsigned jobs = 0) : pool_(jobs) {}
+
+  /**
+   * @brief Returns the worker pool.
+   */
+  ThreadPool &pool() { return pool_; }
+
+  /**
+   * @brief Returns the ELF scanner of the given mode (created once).
+   */
+  ElfScanner &elf_scanner(bool closure) {
+    auto &scanner = elf_[closure ? 1 : 0];
+    if (!scanner)
+      scanner = std::make_unique<ElfScanner>(closure);
+    return *scanner;
+  }
+
+  /**
+   * @brief Returns the CVE cache of a directory (opened once per TTL).
+   */
+  CveCache &cve_cache(const fs::path &dir, std::chrono::seconds ttl) {
+    auto &cache = cve_caches_[dir.string() + '\0' + std::to_string(ttl.count())];
+    if (!cache)
+      cache = std::make_unique<CveCache>(dir, ttl);
+    return *cache;
+  }
+
+  /**
+   * @brief Prepares the caches for the next scan.
+   */
+  void begin_scan() {
+    if (scans_++ == 0)
+      return;
+    HeaderResolveCache::instance().refresh();
+    IncludeGraph::instance().refresh();
+    PcResolver::instance().refresh();
+    LicenseDirCache::instance().refresh();
+    for (auto &scanner : elf_)
+      if (scanner)
+        scanner->begin_run();
+  }
+
+  /**
+   * @brief Releases the interned strings of a finished scan.
+   *
+   * The StringPool only grows, so a server or batch run would keep the
+   * paths of every scan it served. Call once the results are written and
+   * no scan is running. The header memos are dropped with the pool; the
+   * parsed include lists are carried over as strings, so the new pool only
+   * holds what a cache still refers to.
+   */
+  void end_scan() {
+    auto parsed = IncludeGraph::instance().release_interned();
+    HeaderResolveCache::instance().forget_interned();
+    StringPool::instance().reset();
+    IncludeGraph::instance().restore_interned(std::move(parsed));
+  }
+
+private:
+  ThreadPool pool_;
+  std::unique_ptr<ElfScanner> elf_[2];
+  std::map<std::string, std::unique_ptr<CveCache>> cve_caches_;
+  std::size_t scans_ = 0;
+};
+
+/**
+ * @brief Checks one unsuppressed vulnerability against the build breaker.
+ *
+ * A severity that cannot be scored fails the build as well: its real score
+ * is unknown, so it must not pass the gate unnoticed.
+ *
+ * @param dep The affected dependency.
+ * @param cve The vulnerability.
+ * @param threshold The `--fail-on-cvss` threshold.
+ * @param verb "has" or "introduces" for the messages.
+ * @return true If the vulnerability breaks the build.
+ */
+inline bool breaks_build(const Dependency &dep, const CVE &cve,
+                         double threshold, std::string_view verb) {
+  if (score_severity(cve.severity).kind == CvssScoreKind::Unscored) {
+    std::cerr << "  ❌ ERROR: " << dep.name << " v" << dep.version << " "
+              << verb << " vulnerability " << cve.id
+              << " with a severity that cannot be scored: " << cve.severity
+              << "\n";
+    return true;
+  }
+  if (cve.score < threshold)
+    return false;
+  std::cerr << "  ❌ ERROR: " << dep.name << " v" << dep.version << " " << verb
+            << " vulnerability " << cve.id << " (Score: ~" << cve.score
+            << ")\n";
+  return true;
+}
+
+/**
+ * @brief Writes all reports, saves the incremental state and applies the
+ * build breaker.
+ *
+ * @param o The scan options (with the default paths filled in).
+ * @param header The report header.
+ * @param deps The final dependency list.
+ * @param pool The pool for the report emitters.
+ * @param report_out Receives the JSON report in compact form (optional).
+ * @param state The incremental state to save (optional).
+ * @return int The exit code.
+ */
+inline int write_scan_results(const ScanOptions &o, const ReportHeader &header,
+                              const std::vector<Dependency> &deps,
+                              ThreadPool &pool, std::string *report_out,
+                              ScanState *state) {
+  ReportTargets targets;
+  targets.json_path = o.output_path;
+  targets.html_path = o.html_path;
+  targets.markdown_path = o.markdown_path;
+  targets.cyclonedx_path = o.cyclonedx_path;
+  targets.binary_path = o.save_path;
+  targets.compact_json = report_out;
+  std::vector<ReportResult> reports;
+  {
+    ProfileScope phase("reports");
+    reports = write_reports(header, deps, targets, pool);
+    phase.items(deps.size());
+  }
+  if (reports.empty() || !reports.front().ok) {
+    std::cerr << "Error: Could not write output file: " << o.output_path
+              << "\n";
+    return 1;
+  }
+  for (const auto &r : reports) {
+    if (!r.ok)
+      std::cerr << "[Warning] Could not write " << r.format
+                << " report: " << r.path << "\n";
+    else if (r.format == "json")
+      std::cerr << "[Success] SBOM report written to: " << r.path << "\n";
+    else if (r.format == "html")
+      std::cerr << "[Success] HTML report written to: " << r.path << "\n";
+    else if (r.format == "markdown")
+      std::cerr << "[Success] Markdown report written to: " << r.path
+                << "\n";
+    else if (r.format == "cyclonedx")
+      std::cerr << "[Success] CycloneDX SBOM written to: " << r.path << "\n";
+    else
+      std::cerr << "[Success] Binary SBOM written to: " << r.path << "\n";
+  }
+
+  if (state) {
+    ProfileScope phase("state_save");
+    if (state->save(pool))
+      std::cerr << "[Info] Incremental state written to: " << o.state_path
+                << "\n";
+    else
+      std::cerr << "[Warning] Could not write state file: " << o.state_path
+                << "\n";
+  }
+
+  // --- 6. Check Build Breaker Logic ---
+  if (o.fail_on_cvss <= 10.0) {
+    bool critical_vuln_found = false;
+    std::cerr << "\n[Audit] Checking for vulnerabilities with CVSS >= "
+              << o.fail_on_cvss << " ...\n";
+
+    for (const auto &dep : deps) {
+      for (const auto &cve : dep.cves) {
+        // Suppressed CVEs are ignored in build breaker
+        if (!cve.suppressed && cve.id != "SAFE" && cve.id != "NOT-CHECKED" &&
+            cve.id != "CHECK-ERROR" &&
+            breaks_build(dep, cve, o.fail_on_cvss, "has"))
+          critical_vuln_found = true;
+      }
+    }
+
+    if (critical_vuln_found) {
+      std::cerr << "\n[Audit] BUILD FAILED: Critical vulnerabilities found "
+                   "exceeding threshold!\n";
+      return 1; // Exit with error code
+    } else {
+      std::cerr << "[Audit] BUILD SUCCESS: No critical unresolved "
+                   "vulnerabilities found above threshold.\n";
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Compares two reports (`--diff`) instead of scanning.
+ *
+ * Writes the diff as JSON to `output_path` (stdout if neither `-o` nor
+ * `-M` is given) and as Markdown to `markdown_path`. The build breaker
+ * only considers vulnerabilities that are new in the second report.
+ *
+ * @param o The options.
+ * @return int The exit code.
+ */
+inline int run_diff(const ScanOptions &o) {
+  try {
+    // The diff does not look at header and library paths
+    ReportHeader old_header, new_header;
+    std::vector<Dependency> old_deps, new_deps;
+    std::string error;
+    if (!load_scan_result(o.diff_old, old_header, old_deps, error,
+                          false)) {
+      std::cerr << "Error: Could not load " << o.diff_old << ": " << error
+                << "\n";
+      return 1;
+    }
+    if (!load_scan_result(o.diff_new, new_header, new_deps, error,
+                          false)) {
+      std::cerr << "Error: Could not load " << o.diff_new << ": " << error
+                << "\n";
+      return 1;
+    }
+
+    SbomDiff diff = diff_sboms(old_deps, new_deps);
+    std::cerr << "[Info] Diff: " << diff.added.size() << " added, "
+              << diff.removed.size() << " removed, " << diff.upgraded
+              << " upgraded, " << diff.downgraded << " downgraded, "
+              << diff.new_cves.size() << " new CVEs, "
+              << diff.fixed_cves.size() << " fixed CVEs\n";
+
+    if (!o.output_path.empty()) {
+      std::ofstream out(o.output_path);
+      if (!out) {
+        std::cerr << "Error: Could not write output file: " << o.output_path
+                  << "\n";
+        return 1;
+      }
+      write_diff_json(out, old_header, old_deps, new_header, new_deps, diff);
+      std::cerr << "[Success] Diff report written to: " << o.output_path
+                << "\n";
+    } else if (o.markdown_path.empty()) {
+      write_diff_json(std::cout, old_header, old_deps, new_header, new_deps,
+                      diff);
+      std::cout << "\n";
+    }
+    if (!o.markdown_path.empty()) {
+      std::ofstream out(o.markdown_path);
+      if (!out) {
+        std::cerr << "Error: Could not write output file: " << o.markdown_path
+                  << "\n";
+        return 1;
+      }
+      write_diff_markdown(out, old_header, old_deps, new_header, new_deps,
+                          diff);
+      std::cerr << "[Success] Markdown diff written to: " << o.markdown_path
+                << "\n";
+    }
+
+    // Only vulnerabilities introduced by the new report break the build
+    if (o.fail_on_cvss <= 10.0) {
+      bool critical_vuln_found = false;
+      std::cerr << "\n[Audit] Checking new vulnerabilities with CVSS >= "
+                << o.fail_on_cvss << " ...\n";
+      for (const auto &c : diff.new_cves) {
+        const Dependency &dep = new_deps[c.dep_index];
+        const CVE &cve = dep.cves[c.cve_index];
+        if (breaks_build(dep, cve, o.fail_on_cvss, "introduces"))
+          critical_vuln_found = true;
+      }
+      if (critical_vuln_found) {
+        std::cerr << "\n[Audit] BUILD FAILED: New critical vulnerabilities "
+                     "exceeding threshold!\n";
+        return 1;
+      }
+      std::cerr << "[Audit] BUILD SUCCESS: No new vulnerabilities found "
+                   "above threshold.\n";
+    }
+  } catch (const std::exception &ex) {
+    std::cerr << "Error: " << ex.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * @brief Runs a complete scan and writes all reports.
+ *
+ * Relative paths are resolved against the current working directory.
+ *
+ * @param opt The scan options (`jobs` is taken from the context's pool).
+ * @param ctx The long-lived scan context.
+ * @param report_out Receives the JSON report in compact form (optional).
+ * @param deps_out Receives the final dependency list of a scan (optional).
+ * @return int The exit code (1 on errors or if the build breaker fails).
+ */
+inline int scan_project(const ScanOptions &opt, ScanContext &ctx,
+                        std::string *report_out = nullptr,
+                        std::vector<Dependency> *deps_out = nullptr) {
+  if (!opt.diff_old.empty())
+    return run_diff(opt);
+
+  ScanOptions o = opt;
+  std::map<std::string, std::string> suppressions;
+  ctx.begin_scan();
+  PkgConfig::use_executable(o.pkg_config_exec);
+
+  // --- Handle Defaults and Data Directory ---
+  bool use_data_dir = false;
+
+  if (o.output_path.empty()) {
+    o.output_path = default_report_path("_depdiscover.json");
+    use_data_dir = true;
+  }
+  if (o.html_path.empty()) {
+    // If user wants HTML (by default or via flag? User says "all file-outputs")
+    // I assume standard paths should be set for all possible outputs if not
+    // specified.
+    o.html_path = default_report_path("_depdiscover.html");
+    use_data_dir = true;
+  }
+  if (o.markdown_path.empty()) {
+    o.markdown_path = default_report_path("_depdiscover.md");
+    use_data_dir = true;
+  }
+  if (o.cyclonedx_path.empty()) {
+    o.cyclonedx_path = default_report_path("_CycloneDx.json");
+    use_data_dir = true;
+  }
+
+  if (use_data_dir) {
+    std::error_code ec;
+    if (!fs::exists("data/reports", ec)) {
+      fs::create_directories("data/reports", ec);
+    }
+  }
+
+  try {
+    // --- Re-emit a saved scan (--load) ---
+    if (!o.load_path.empty()) {
+      BinarySbom saved;
+      std::string error;
+      if (!saved.open(o.load_path, &error)) {
+        std::cerr << "Error: Could not load " << o.load_path << ": " << error
+                  << "\n";
+        return 1;
+      }
+      std::cerr << "[Info] Loaded " << saved.size()
+                << " dependencies from: " << o.load_path << "\n";
+      return write_scan_results(o, saved.report_header(),
+                                saved.dependencies(), ctx.pool(), report_out,
+                                nullptr);
+    }
+
+    // --- 0. Load Suppressions ---
+    if (!o.suppressions_path.empty() && fs::exists(o.suppressions_path)) {
+      std::cerr << "[Info] Loading suppressions from: " << o.suppressions_path
+                << "\n";
+      try {
+        std::ifstream f(o.suppressions_path);
+        json j;
+        f >> j;
+        for (auto &[key, value] : j.items()) {
+          suppressions[key] = value.get<std::string>();
+        }
+      } catch (const std::exception &e) {
+        std::cerr << "[Warning] Error reading suppressions file: " << e.what()
+                  << "\n";
+      }
+    }
+
+    ThreadPool &pool = ctx.pool();
+
+    // --- Incremental State ---
+    std::unique_ptr<ScanState> state;
+    if (o.incremental) {
+      std::string config = "v=" + std::string(rz::config::VERSION) +
+                           ";t=" + (o.transitive_includes ? "1" : "0") +
+                           ";d=" +
+                           std::to_string(o.include_graph_options.max_depth) +
+                           ";s=" +
+                           std::to_string(o.include_graph_options.max_file_size) +
+                           ";p=" + (o.include_graph_options.preamble_only ? "1" : "0") +
+                           ";e=" + (o.elf_closure ? "1" : "0");
+      state = std::make_unique<ScanState>(o.state_path, config);
+      if (state->load()) {
+        state->validate(pool);
+        std::cerr << "[Info] Incremental state: " << state->known_paths()
+                  << " inputs checked, " << state->changed_paths()
+                  << " changed (" << o.state_path << ")\n";
+      } else {
+        std::cerr << "[Info] Incremental state: no usable state in "
+                  << o.state_path << ", full scan.\n";
+      }
+    }
+
+    // --- 1. Load Dependencies ---
+    std::vector<Dependency> deps;
+    std::optional<ProfileScope> manifest_phase(std::in_place, "manifests");
+
+    if (fs::exists(o.vcpkg_path)) {
+      std::cerr << "[Info] Loading Vcpkg manifest: " << o.vcpkg_path << "\n";
+      auto v = parse_vcpkg_manifest(o.vcpkg_path);
+      deps.insert(deps.end(), v.begin(), v.end());
+    }
+    if (fs::exists(o.conan_path)) {
+      std::cerr << "[Info] Loading Conan file: " << o.conan_path << "\n";
+      auto c = parse_conan_dependencies(o.conan_path);
+      deps.insert(deps.end(), c.begin(), c.end());
+    }
+    // Merges libs.txt and FetchContent entries by normalized name
+    DependencyRegistry registry(deps);
+    if (fs::exists(o.libs_txt_path)) {
+      std::cerr << "[Info] Loading CMake libs.txt: " << o.libs_txt_path << "\n";
+      auto cmake_deps = parse_cmake_libs(o.libs_txt_path);
+      for (const auto &cd : cmake_deps) {
+        Dependency *existing =
+            registry.find(cd.name, DependencyRegistry::Match::CaseSensitive);
+        if (!existing) {
+          registry.add(cd);
+          continue;
+        }
+        if (existing->version == "latest" || existing->version == "unknown") {
+          if (cd.version != "unknown")
+            existing->version = cd.version;
+        }
+      }
+    }
+
+    if (fs::exists(o.cmake_lists_path)) {
+      std::cerr << "[Info] Checking for FetchContent in: " << o.cmake_lists_path
+                << "\n";
+      auto fetch_deps = parse_cmake_fetch_content(o.cmake_lists_path);
+      for (const auto &info : fetch_deps) {
+        Dependency *existing =
+            registry.find(info.name, DependencyRegistry::Match::CaseInsensitive);
+        if (!existing) {
+          Dependency d;
+          d.name = info.name;
+          d.version = info.version;
+          d.type = "cmake_fetch";
+          d.source = "cmake_fetchcontent";
+          registry.add(std::move(d));
+          continue;
+        }
+        if (existing->version == "latest" || existing->version == "unknown") {
+          existing->version = info.version;
+          if (existing->source.empty() || existing->source == "manifest") {
+            existing->source = "cmake_fetchcontent";
+          }
+        }
+      }
+      // Additional Export as requested
+      if (!fetch_deps.empty()) {
+        std::string csv_path = default_report_path("_gh-libs.csv");
+        std::string json_path = default_report_path("_gh-libs.json");
+
+        // Ensure data directory exists (just in case it was only for this
+        // output)
+        std::error_code ec;
+        if (!fs::exists("data/reports", ec))
+          fs::create_directories("data/reports", ec);
+
+        export_fetch_to_csv(fetch_deps, csv_path);
+        export_fetch_to_json(fetch_deps, json_path);
+        std::cerr << "[Success] Exported FetchContent to " << csv_path
+                  << " and " << json_path << "\n";
+      }
+    }
+
+    manifest_phase->items(deps.size());
+    manifest_phase.reset();
+
+    // --- 1b. Versions ---
+    // pkg-config only fills in unknown versions and does not depend on the
+    // scanned headers, so every version is final here. The enrichment key
+    // is taken from the manifest result as before.
+    std::vector<Dependency> manifest_deps;
+    if (state)
+      manifest_deps = deps;
+    std::vector<PkgInfo> pkg_infos(deps.size());
+    {
+      ProfileScope phase("pkg_config");
+      for (std::size_t i = 0; i < deps.size(); ++i) {
+        auto &dep = deps[i];
+        pkg_infos[i] = PkgConfig::query(dep.name);
+        // PRIORITIZATION: Only overwrite version if it's not already known from a local source
+        if (pkg_infos[i].found &&
+            (dep.version == "unknown" || dep.version == "latest" ||
+             dep.version.empty())) {
+          dep.version = pkg_infos[i].version;
+          dep.source = "pkgconfig";
+        }
+      }
+      phase.items(deps.size());
+    }
+
+    // --- 1c. CVE Stage ---
+    // The OSV lookup runs on its own thread while the local analysis below
+    // keeps the pool busy; it is joined after the mapping. Its progress
+    // lines are buffered and printed at the join.
+    auto make_cve_query = [](const Dependency &dep) {
+      std::string clean_ver = dep.version;
+      if (!clean_ver.empty() && clean_ver[0] == 'v')
+        clean_ver.erase(0, 1);
+      return CveQuery{dep.name, clean_ver};
+    };
+    std::vector<CveQuery> cve_queries;
+    cve_queries.reserve(deps.size());
+    for (const auto &dep : deps)
+      cve_queries.push_back(make_cve_query(dep));
+
+    CveCache *cve_cache = nullptr;
+    const std::chrono::seconds cve_ttl(
+        static_cast<long long>(o.cve_cache_ttl_hours * 3600.0));
+    if (!o.cve_cache_dir.empty() || o.offline) {
+      fs::path dir = o.cve_cache_dir.empty() ? default_cve_cache_dir()
+                                           : fs::path(o.cve_cache_dir);
+      cve_cache = &ctx.cve_cache(dir, cve_ttl);
+    } else if (o.share_cve_results) {
+      cve_cache = &ctx.cve_cache({}, cve_ttl);
+    }
+
+    std::string cve_log;
+    auto cve_stage = std::async(std::launch::async, [&] {
+      ScanLogCapture capture(cve_log);
+      ProfileScope stage("cve_resolution", ProfileKind::Stage);
+      stage.items(cve_queries.size());
+      return query_cves_cached(cve_queries, o.ecosystem, cve_cache, o.offline);
+    });
+
+    // --- 2. Scan Build Artifacts ---
+    std::vector<std::string_view> all_resolved_headers; ///< Sorted, pooled.
+    std::set<std::string> all_elf_libs;
+
+    // The ELF scan shares the pool with the compile_commands analysis and
+    // is joined after it (the state is only touched on this thread)
+    std::vector<std::string> elf_inputs;
+    std::set<std::string> elf_libs;
+    bool elf_reused = false;
+    std::string elf_log;
+    // Declared after everything the stage captures: if the analysis below
+    // throws, ~future waits for the stage before those are destroyed
+    std::future<void> elf_stage;
+    if (!o.binary_paths.empty()) {
+      ElfScanner &elf = ctx.elf_scanner(o.elf_closure);
+      elf_inputs = elf.expand_inputs(o.binary_paths);
+      elf_reused = state && state->reuse_elf(elf_inputs, elf_libs);
+      if (!elf_reused)
+        elf_stage = std::async(std::launch::async, [&, scanner = &elf] {
+          ScanLogCapture capture(elf_log);
+          ProfileScope stage("elf_scan", ProfileKind::Stage);
+          elf_libs = scanner->scan(elf_inputs, pool);
+          Profiler::instance().count("elf.parsed", scanner->parsed_count());
+          scan_log() << "   -> " << elf_libs.size() << " libraries, "
+                     << scanner->parsed_count() << " ELF files parsed ("
+                     << scanner->unresolved_count() << " unresolved)\n";
+          stage.items(elf_inputs.size());
+        });
+    }
+
+    if (fs::exists(o.cc_path)) {
+      std::cerr << "[Info] Analyzing Compile Commands: " << o.cc_path << "\n";
+      // Entries are parsed on their own thread and scanned in batches, so
+      // only a few batches are in memory for databases of any size
+      const std::size_t batch_size = std::size_t(pool.size()) * 64;
+      CompileCommandStream stream(o.cc_path, batch_size);
+      std::vector<CompileCommand> cc;
+      auto &header_cache = HeaderResolveCache::instance();
+      IncludeGraph::instance().configure(o.include_graph_options);
+
+      auto &strings = StringPool::instance();
+
+      // Each chunk collects interned header IDs into its own set; the sets
+      // are merged afterwards and sorted by path (independent of the worker
+      // schedule). Dependency records get std::string copies only when the
+      // mapper hands the headers out.
+      struct TuResult {
+        std::string key;
+        std::vector<std::string> inputs;
+        std::vector<std::string> headers;
+      };
+      struct Chunk {
+        std::unordered_set<StringId> headers;
+        std::vector<TuResult> tus; ///< Only filled in incremental mode.
+        std::size_t reused = 0;
+      };
+      std::optional<ProfileScope> scan_phase(std::in_place, "include_scan");
+      std::size_t reused_tus = 0;
+      std::unordered_set<StringId> header_ids;
+      // Plan: a source file compiled with the same include-path list (by
+      // another configuration or test variant) yields the same headers, so
+      // only its first entry is scanned. Headers are resolved once per
+      // (name, list) by the header cache.
+      std::unordered_set<std::uint64_t> planned_tus;
+      std::unordered_set<std::uint64_t> planned_files;
+      std::size_t duplicate_tus = 0;
+      std::vector<std::uint32_t> list_ids;
+      std::vector<std::size_t> unique;
+      while (stream.next_batch(cc, batch_size)) {
+        {
+          ProfileScope step("tu_planning", ProfileKind::Accumulate);
+          list_ids.assign(cc.size(), 0);
+          pool.parallel_chunks<std::size_t>(
+              cc.size(), [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                  const auto &entry = cc[i];
+                  auto incs = entry.arguments.empty()
+                                  ? extract_include_paths(entry.command)
+                                  : extract_include_paths(entry.arguments);
+                  list_ids[i] = header_cache.intern(incs, entry.directory);
+                }
+                return end - begin;
+              });
+          unique.clear();
+          for (std::size_t i = 0; i < cc.size(); ++i) {
+            fs::path file(cc[i].file);
+            if (file.is_relative() && !cc[i].directory.empty())
+              file = fs::path(cc[i].directory) / file;
+            std::uint64_t file_hash =
+                content_hash(file.lexically_normal().string());
+            planned_files.insert(file_hash);
+            if (planned_tus.insert(content_hash(std::to_string(list_ids[i]),
+                                                file_hash))
+                    .second)
+              unique.push_back(i);
+            else
+              ++duplicate_tus;
+          }
+          step.items(cc.size());
+        }
+
+        auto partial = pool.parallel_chunks<Chunk>(
+            unique.size(), [&](std::size_t begin, std::size_t end) {
+              Chunk chunk;
+              auto &local = chunk.headers;
+              std::vector<StringId> reachable;
+              for (std::size_t k = begin; k < end; ++k) {
+                const auto &entry = cc[unique[k]];
+                const auto list_id = list_ids[unique[k]];
+                ProfileScope task("tu", ProfileKind::Task, entry.file);
+
+                TuResult tu;
+                std::vector<fs::path> search_dirs;
+                if (state) {
+                  tu.key = ScanState::tu_key(entry.file, entry.directory,
+                                             entry.command, entry.arguments);
+                  tu.inputs.push_back(entry.file);
+                  search_dirs = header_cache.directories(list_id);
+                  for (const auto &dir : search_dirs)
+                    tu.inputs.push_back(dir.string());
+                  if (state->reuse_tu(tu.key, tu.headers)) {
+                    ++chunk.reused;
+                    for (const auto &h : tu.headers)
+                      local.insert(strings.intern(h));
+                    chunk.tus.push_back(std::move(tu));
+                    continue;
+                  }
+                }
+
+                auto raw =
+                    scan_includes(entry.file, o.include_graph_options.preamble_only);
+                std::vector<StringId> direct;
+                {
+                  ProfileScope step("header_resolution", ProfileKind::Accumulate);
+                  for (const auto &r : raw) {
+                    StringId path =
+                        header_cache.resolve_id(list_id, strings.intern(r));
+                    if (path != NO_STRING_ID)
+                      direct.push_back(path);
+                  }
+                  step.items(raw.size());
+                }
+
+                reachable.clear();
+                if (o.transitive_includes) {
+                  ProfileScope step("include_graph", ProfileKind::Accumulate);
+                  IncludeGraph::instance().collect(direct, list_id, reachable);
+                  step.items(reachable.size());
+                } else {
+                  reachable = direct;
+                }
+                local.insert(reachable.begin(), reachable.end());
+                if (!state)
+                  continue;
+
+                // Every directory a lookup looked into is an input: a header
+                // added there (or below it) can change what an include
+                // resolves to
+                std::unordered_set<StringId> probed;
+                auto probe_list = [&](StringId name) {
+                  for (StringId d : header_cache.probed_directories(list_id, name))
+                    probed.insert(d);
+                };
+                for (const auto &r : raw)
+                  probe_list(strings.intern(r));
+                if (o.transitive_includes)
+                  for (StringId h : reachable)
+                    for (StringId d :
+                         IncludeGraph::instance().probed_directories(h, list_id))
+                      probed.insert(d);
+                for (StringId d : probed)
+                  tu.inputs.emplace_back(strings.view(d));
+                std::set<std::string> tu_headers;
+                for (StringId h : reachable)
+                  tu_headers.emplace(strings.view(h));
+                tu.headers.assign(tu_headers.begin(), tu_headers.end());
+                chunk.tus.push_back(std::move(tu));
+              }
+              return chunk;
+            });
+        for (auto &chunk : partial) {
+          reused_tus += chunk.reused;
+          for (const auto &tu : chunk.tus) // empty unless incremental
+            state->record_tu(tu.key, tu.inputs, tu.headers);
+          header_ids.merge(chunk.headers);
+        }
+      }
+      const std::size_t tu_count = stream.count();
+      for (StringId h : header_ids)
+        all_resolved_headers.push_back(strings.view(h));
+      std::sort(all_resolved_headers.begin(), all_resolved_headers.end());
+      scan_phase->items(tu_count);
+      scan_phase.reset();
+      std::cerr << "[Info] Loaded " << tu_count << " compile commands.\n";
+      if (duplicate_tus > 0)
+        std::cerr << "   -> Planning: " << duplicate_tus
+                  << " duplicate translation units skipped ("
+                  << tu_count - duplicate_tus << " scanned, "
+                  << planned_files.size() << " unique source files).\n";
+      std::cerr << "   -> " << all_resolved_headers.size()
+                << " header files identified.\n";
+      if (state)
+        std::cerr << "   -> Incremental: " << reused_tus << " of "
+                  << tu_count - duplicate_tus
+                  << " translation units reused.\n";
+      if (o.transitive_includes)
+        std::cerr << "   -> Transitive mode: "
+                  << IncludeGraph::instance().parsed_count()
+                  << " headers parsed.\n";
+      auto hc = header_cache.stats();
+      auto &profiler = Profiler::instance();
+      profiler.count("header_cache.hits", hc.hits);
+      profiler.count("header_cache.misses", hc.misses);
+      profiler.count("headers.resolved", all_resolved_headers.size());
+      profiler.count("tus.duplicate", duplicate_tus);
+      if (o.transitive_includes)
+        profiler.count("include_graph.parsed",
+                       IncludeGraph::instance().parsed_count());
+      if (state)
+        profiler.count("incremental.tus_reused", reused_tus);
+      std::cerr << "   -> Header cache: " << hc.hits << " hits, " << hc.misses
+                << " misses (" << hc.negative << " unresolved), "
+                << hc.path_lists << " include-path lists, " << hc.dir_listings
+                << " directories listed.\n";
+    } else {
+      std::cerr << "[Info] Skip Compile Commands analysis (file not found: "
+                << o.cc_path << ")\n";
+    }
+
+    if (!o.binary_paths.empty()) {
+      std::cerr << "[Info] Scanning " << elf_inputs.size() << " binaries (ELF"
+                << (o.elf_closure ? ", closure" : "") << ")...\n";
+      if (elf_reused) {
+        std::cerr << "   -> " << elf_libs.size()
+                  << " libraries (unchanged binaries, reused)\n";
+      } else {
+        elf_stage.get();
+        std::cerr << elf_log;
+      }
+      if (state)
+        state->record_elf(elf_inputs, elf_libs);
+      all_elf_libs.insert(elf_libs.begin(), elf_libs.end());
+    }
+
+    // --- 3. Mapping & Enrichment ---
+    // Reused as a whole when the scanned dependencies, headers, libraries
+    // and pkg-config inputs are unchanged
+    std::optional<ProfileScope> mapping_phase(std::in_place, "mapping");
+    std::string enrichment_key;
+    std::vector<Dependency> system_deps;
+    std::vector<std::string> enrichment_inputs;
+    bool enrichment_reused = false;
+    if (state) {
+      std::string env = PkgConfig::executable_mode() ? "exec" : "native";
+      for (const char *var : {"PKG_CONFIG_PATH", "PKG_CONFIG_LIBDIR",
+                              "PKG_CONFIG_SYSROOT_DIR",
+                              "PKG_CONFIG_SYSTEM_INCLUDE_PATH"}) {
+        const char *v = std::getenv(var);
+        env += std::string(";") + (v ? v : "");
+      }
+      enrichment_key = ScanState::enrichment_key(
+          manifest_deps, all_resolved_headers, all_elf_libs, env);
+      enrichment_reused = state->reuse_enrichment(enrichment_key, deps,
+                                                  system_deps, &enrichment_inputs);
+    }
+
+    std::vector<std::string> unclaimed_libs;
+    if (enrichment_reused) {
+      std::cerr << "[Info] Mapping & enrichment unchanged, reusing previous "
+                   "results.\n";
+    } else {
+      std::cerr << "[Info] Starting mapping & metadata enrichment...\n";
+
+      // Headers/libraries go to the first dependency that matches them
+      DependencyMapper mapper(all_resolved_headers, all_elf_libs);
+      auto append = [](std::vector<std::string> &to,
+                       std::vector<std::string> &&from) {
+        to.insert(to.end(), std::make_move_iterator(from.begin()),
+                  std::make_move_iterator(from.end()));
+      };
+
+      for (std::size_t i = 0; i < deps.size(); ++i) {
+        auto &dep = deps[i];
+        const PkgInfo &pkg = pkg_infos[i];
+        if (pkg.found) {
+          // Only use headers/libraries from pkg-config if it's NOT a local dependency
+          // or if the versions match (indicating pkg-config might point to our local install)
+          bool is_local = (dep.type == "vcpkg" || dep.type == "conan" ||
+                           dep.type == "cmake_fetch" || dep.type == "cmake_target");
+
+          if (!is_local || dep.version == pkg.version) {
+            for (const auto &dir : pkg.include_paths)
+              append(dep.headers, mapper.claim_headers_with_prefix(dir));
+            for (const auto &l_name : pkg.lib_names)
+              append(dep.libraries, mapper.claim_libs_containing("lib" + l_name));
+          }
+        }
+
+        if (dep.headers.empty())
+          append(dep.headers, mapper.claim_headers_fuzzy(dep.name));
+        if (dep.headers.empty())
+          append(dep.headers, mapper.claim_headers_containing(dep.name));
+        if (dep.libraries.empty())
+          append(dep.libraries, mapper.claim_libs_fuzzy(dep.name));
+
+        ProfileScope step("license_resolution", ProfileKind::Accumulate);
+        dep.licenses = resolve_licenses(dep.name, dep.headers);
+      }
+      unclaimed_libs = mapper.unclaimed_libs();
+    }
+    mapping_phase->items(deps.size());
+    mapping_phase.reset();
+
+    // --- 3b. Join the CVE Stage ---
+    auto cve_results = cve_stage.get();
+    std::cerr << cve_log;
+
+    // A reused enrichment result replaces `deps`; anything that no longer
+    // matches its query (not expected) is looked up again
+    std::vector<CveQuery> late_queries;
+    std::vector<std::size_t> late_index;
+    for (std::size_t i = 0; i < deps.size(); ++i) {
+      CveQuery q = make_cve_query(deps[i]);
+      if (i >= cve_queries.size() || q.name != cve_queries[i].name ||
+          q.version != cve_queries[i].version) {
+        late_queries.push_back(std::move(q));
+        late_index.push_back(i);
+      }
+    }
+    cve_results.resize(deps.size());
+    if (!late_queries.empty()) {
+      auto late =
+          query_cves_cached(late_queries, o.ecosystem, cve_cache, o.offline);
+      for (std::size_t k = 0; k < late.size(); ++k)
+        cve_results[late_index[k]] = std::move(late[k]);
+    }
+
+    for (std::size_t i = 0; i < deps.size(); ++i) {
+      auto &dep = deps[i];
+      dep.cves = std::move(cve_results[i]);
+
+      // Apply suppressions
+      if (!suppressions.empty()) {
+        for (auto &cve : dep.cves) {
+          if (suppressions.contains(cve.id)) {
+            cve.suppressed = true;
+            cve.suppression_reason = suppressions[cve.id];
+          }
+        }
+      }
+    }
+
+    // --- 4. System Libs ---
+    // Earlier system entries count as "present" as well
+    LibraryIndex local_libs, system_libs;
+    if (!enrichment_reused)
+      for (const auto &dep : deps)
+        local_libs.add(dep);
+
+    if (!enrichment_reused) {
+      ProfileScope phase("system_libs");
+      for (const auto &lib : unclaimed_libs) {
+        // Check if this library is already accounted for in any local
+        // dependency
+        if (local_libs.accounts_for(lib) || system_libs.accounts_for(lib))
+          continue;
+
+        Dependency sys;
+        sys.name = lib;
+        sys.type = "system";
+        sys.source = "elf_scan";
+        sys.libraries.push_back(lib);
+        {
+          ProfileScope step("license_resolution", ProfileKind::Accumulate);
+          sys.licenses = resolve_licenses(lib);
+        }
+        system_libs.add(sys);
+        system_deps.push_back(std::move(sys));
+      }
+      phase.items(system_deps.size());
+    }
+    if (state) {
+      // Edited .pc or license files invalidate the recorded result
+      if (!enrichment_reused) {
+        enrichment_inputs = PcResolver::instance().input_paths();
+        auto license_inputs = LicenseDirCache::instance().input_paths();
+        enrichment_inputs.insert(enrichment_inputs.end(),
+                                 license_inputs.begin(), license_inputs.end());
+      }
+      state->record_enrichment(enrichment_key, enrichment_inputs, deps,
+                               system_deps);
+    }
+    deps.insert(deps.end(), system_deps.begin(), system_deps.end());
+
+    // --- 5. Generate Output ---
+    // All reports are streamed from `deps` in parallel; no JSON document
+    // is built.
+    ReportHeader header;
+    header.schema_version = SCHEMA_VERSION;
+    header.scan_date = get_current_date();
+    header.tool_name = rz::config::PROJECT_NAME;
+    header.tool_version = rz::config::VERSION;
+    header.tool_description = rz::config::PROG_LONGNAME;
+    header.tool_homepage = rz::config::PROJECT_HOMEPAGE_URL;
+    header.tool_author = rz::config::AUTHOR;
+    header.project_name = o.project_name;
+    header.workspace_root = fs::current_path().string();
+
+    if (deps_out)
+      *deps_out = deps;
+    return write_scan_results(o, header, deps, pool, report_out,
+                              state.get());
+
+  } catch (const std::exception &ex) {
+    std::cerr << "Error: " << ex.what() << "\n";
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Runs `run` under the profiler if the options ask for it.
+ *
+ * With `--profile` the phases are timed and the summary is printed to
+ * std::cerr afterwards; `--profile-trace` also writes the Chrome
+ * trace-event file.
+ *
+ * @param opt The options.
+ * @param run Callable `int()` doing the work.
+ * @return int The exit code of `run`.
+ */
+template <class Fn> int run_profiled(const ScanOptions &opt, Fn &&run) {
+  if (!opt.profile)
+    return run();
+
+  auto &profiler = Profiler::instance();
+  profiler.start();
+  int exit_code = run();
+  profiler.stop();
+  profiler.print_summary(std::cerr);
+  if (!opt.profile_trace.empty()) {
+    if (profiler.write_trace(opt.profile_trace))
+      std::cerr << "[Info] Profile trace written to: " << opt.profile_trace
+                << "\n";
+    else
+      std::cerr << "[Warning] Could not write profile trace: "
+                << opt.profile_trace << "\n";
+  }
+  return exit_code;
+}
+
+/**
+ * @brief Runs one scan (or `--load` / `--diff`) as given by the options.
+ *
+ * The scan is profiled as requested (see run_profiled()).
+ *
+ * @param opt The scan options.
+ * @param ctx The long-lived scan context.
+ * @param report_out Receives the JSON report in compact form (optional).
+ * @param deps_out Receives the final dependency list of a scan (optional).
+ * @return int The exit code.
+ */
+inline int run_scan(const ScanOptions &opt, ScanContext &ctx,
+                    std::string *report_out = nullptr,
+                    std::vector<Dependency> *deps_out = nullptr) {
+  return run_profiled(
+      opt, [&] { return scan_project(opt, ctx, report_out, deps_out); });
+}
+
+} // namespace depdiscover
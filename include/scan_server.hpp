@@ -0,0 +1,390 @@
+/**
+ * SPDX-FileComment: Scan Server (Unix Socket)
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file scan_server.hpp
+ * @brief Long-running scan server with warm caches and its thin client.
+ * @version 1.2.2
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "json_writer.hpp"
+#include "scan_runner.hpp"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace depdiscover {
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+/*
+ * Protocol: one request per connection, both directions a single line of
+ * JSON terminated by '\n'.
+ *
+ *   request:  {"cwd": "/path/to/project", "args": ["-c", "build/cc.json"]}
+ *   response: {"exit_code": 0, "log": "...", "report": {...}}
+ *
+ * `args` are the usual command-line options; relative paths are resolved
+ * against `cwd` and the reports are written by the server. `report` is the
+ * JSON root of the SBOM (null if the scan failed before producing one).
+ */
+
+namespace server_detail {
+
+/// Largest accepted request line.
+constexpr std::size_t MAX_REQUEST = 1 << 20;
+
+/// Time a client has to send its request line (and to take each write).
+constexpr int CLIENT_TIMEOUT_MS = 10000;
+
+inline std::atomic<bool> &stop_flag() {
+  static std::atomic<bool> flag{false};
+  return flag;
+}
+
+/**
+ * @brief Redirects std::cerr into a buffer for the lifetime of the object.
+ */
+class CerrCapture {
+public:
+  CerrCapture() : old_(std::cerr.rdbuf(buffer_.rdbuf())) {}
+  ~CerrCapture() { std::cerr.rdbuf(old_); }
+  CerrCapture(const CerrCapture &) = delete;
+  CerrCapture &operator=(const CerrCapture &) = delete;
+  std::string str() const { return buffer_.str(); }
+
+private:
+  std::ostringstream buffer_;
+  std::streambuf *old_;
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+inline bool make_address(const std::string &path, sockaddr_un &addr) {
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(addr.sun_path))
+    return false;
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+inline bool write_all(int fd, const std::string &data) {
+  std::size_t done = 0;
+  while (done < data.size()) {
+    ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    done += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+/**
+ * @brief Reads up to the first '\n' (or EOF).
+ *
+ * @param timeout_ms Deadline for the whole line (negative: none). A client
+ * trickling bytes cannot extend it.
+ * @return false On errors, oversize input or timeout (errno ETIMEDOUT).
+ */
+inline bool read_line(int fd, std::string &out, std::size_t limit,
+                      int timeout_ms = -1) {
+  using clock = std::chrono::steady_clock;
+  const auto deadline = clock::now() + std::chrono::milliseconds(timeout_ms);
+  char buf[65536];
+  errno = 0;
+  while (true) {
+    if (timeout_ms >= 0) {
+      auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      deadline - clock::now())
+                      .count();
+      pollfd p{fd, POLLIN, 0};
+      int ready = left > 0 ? ::poll(&p, 1, static_cast<int>(left)) : 0;
+      if (ready < 0 && errno == EINTR)
+        continue;
+      if (ready == 0)
+        errno = ETIMEDOUT;
+      if (ready <= 0)
+        return false;
+    }
+    ssize_t n = ::read(fd, buf, sizeof(buf));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return false;
+    if (n == 0)
+      return !out.empty();
+    out.append(buf, static_cast<std::size_t>(n));
+    if (auto nl = out.find('\n'); nl != std::string::npos) {
+      out.resize(nl);
+      return true;
+    }
+    if (out.size() > limit)
+      return false;
+  }
+}
+#endif
+
+/**
+ * @brief Serializes a response; `report` is compact JSON text (empty: null).
+ */
+inline std::string response_line(int exit_code, const std::string &log,
+                                  const std::string &report) {
+  std::ostringstream out;
+  JsonWriter w(out, -1);
+  w.begin_object().key("exit_code").value(exit_code).key("log").value(log);
+  w.key("report");
+  if (report.empty())
+    w.null();
+  else
+    w.raw(report);
+  w.end_object();
+  out << '\n';
+  return std::move(out).str();
+}
+
+} // namespace server_detail
+
+/**
+ * @brief Handles one scan request.
+ *
+ * The report is passed through as the text run_scan() streamed, so the
+ * server never holds it as a JSON document.
+ *
+ * @param request The parsed request.
+ * @param ctx The server's scan context.
+ * @param exit_code Receives the exit code of the scan.
+ * @return std::string The response line.
+ */
+inline std::string handle_scan_request(const json &request, ScanContext &ctx,
+                                       int &exit_code) {
+  exit_code = 1;
+  std::string log;
+  std::string report;
+  {
+    server_detail::CerrCapture capture;
+    try {
+      auto args = request.at("args").get<std::vector<std::string>>();
+      fs::path cwd = request.at("cwd").get<std::string>();
+
+      ScanOptions o;
+      if (parse_scan_args(args, o) != 0) {
+        // parse_scan_args() reported the error
+      } else if (o.show_help || o.only_version || o.only_check ||
+                 !o.serve_socket.empty() || !o.connect_socket.empty() ||
+                 !o.batch_path.empty()) {
+        std::cerr << "Error: option not supported in scan requests.\n";
+      } else {
+        fs::path previous = fs::current_path();
+        fs::current_path(cwd); // requests are served one at a time
+        try {
+          exit_code = run_scan(o, ctx, &report);
+        } catch (...) {
+          fs::current_path(previous);
+          throw;
+        }
+        fs::current_path(previous);
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "Error: invalid request: " << e.what() << "\n";
+      exit_code = 1;
+    }
+    log = capture.str();
+  }
+  return server_detail::response_line(exit_code, log, report);
+}
+
+/**
+ * @brief Serves scan requests on a Unix domain socket until SIGINT/SIGTERM.
+ *
+ * The socket is created with mode 0600 (only the owner can submit scans);
+ * a stale socket file at the path is replaced. Requests are handled one at
+ * a time (each scan runs on the context's pool), so the current directory
+ * and the process-wide caches are never shared by two scans at once.
+ *
+ * @param socket_path The socket path.
+ * @param ctx The scan context whose caches stay warm across requests.
+ * @return int The exit code.
+ */
+inline int serve_scans(const std::string &socket_path, ScanContext &ctx) {
+#if defined(__unix__) || defined(__APPLE__)
+  sockaddr_un addr;
+  if (!server_detail::make_address(socket_path, addr)) {
+    std::cerr << "Error: invalid socket path: " << socket_path << "\n";
+    return 1;
+  }
+
+  struct stat st {};
+  if (::lstat(socket_path.c_str(), &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      std::cerr << "Error: " << socket_path << " exists and is no socket.\n";
+      return 1;
+    }
+    ::unlink(socket_path.c_str());
+  }
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    std::cerr << "Error: socket(): " << std::strerror(errno) << "\n";
+    return 1;
+  }
+  mode_t old_mask = ::umask(0177);
+  int bound = ::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+  ::umask(old_mask);
+  if (bound != 0 || ::listen(fd, 64) != 0) {
+    std::cerr << "Error: cannot listen on " << socket_path << ": "
+              << std::strerror(errno) << "\n";
+    ::close(fd);
+    return 1;
+  }
+
+  // No SA_RESTART: a signal interrupts accept() and ends the loop
+  struct sigaction sa {};
+  sa.sa_handler = [](int) { server_detail::stop_flag() = true; };
+  sigemptyset(&sa.sa_mask);
+  ::sigaction(SIGINT, &sa, nullptr);
+  ::sigaction(SIGTERM, &sa, nullptr);
+  std::signal(SIGPIPE, SIG_IGN);
+
+  std::cerr << "[Info] Serving scans on " << socket_path << " ("
+            << ctx.pool().size() << " workers)\n";
+  std::size_t served = 0;
+  while (!server_detail::stop_flag()) {
+    int client = ::accept(fd, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR)
+        continue;
+      std::cerr << "[Warning] accept(): " << std::strerror(errno) << "\n";
+      continue;
+    }
+
+    // A client that stops reading must not block the server either
+    timeval send_timeout{server_detail::CLIENT_TIMEOUT_MS / 1000, 0};
+    ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &send_timeout,
+                 sizeof(send_timeout));
+
+    std::string line;
+    std::string response;
+    if (!server_detail::read_line(client, line, server_detail::MAX_REQUEST,
+                                  server_detail::CLIENT_TIMEOUT_MS)) {
+      if (errno == ETIMEDOUT) {
+        std::cerr << "[Warning] Dropped a client that sent no request within "
+                  << server_detail::CLIENT_TIMEOUT_MS / 1000 << " s.\n";
+        ::close(client);
+        continue;
+      }
+      response = server_detail::response_line(
+          1, "Error: request missing or too large.\n", "");
+    } else {
+      auto start = std::chrono::steady_clock::now();
+      int exit_code = 1;
+      json request = json::parse(line, nullptr, false);
+      response = request.is_discarded()
+                     ? server_detail::response_line(
+                           1, "Error: request is no valid JSON.\n", "")
+                     : handle_scan_request(request, ctx, exit_code);
+      auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+      std::cerr << "[Info] Request " << ++served << ": exit " << exit_code
+                << " in " << ms << " ms\n";
+    }
+    server_detail::write_all(client, response);
+    ::close(client);
+    ctx.end_scan();
+  }
+
+  ::close(fd);
+  ::unlink(socket_path.c_str());
+  std::cerr << "[Info] Scan server stopped after " << served << " requests.\n";
+  return 0;
+#else
+  (void)ctx;
+  std::cerr << "Error: --serve is only supported on POSIX systems ("
+            << socket_path << ").\n";
+  return 1;
+#endif
+}
+
+/**
+ * @brief Sends a scan to a running server and prints its log.
+ *
+ * @param socket_path The server socket.
+ * @param args The scan options (without `--connect`).
+ * @return int The exit code of the remote scan (1 if unreachable).
+ */
+inline int request_scan(const std::string &socket_path,
+                        const std::vector<std::string> &args) {
+#if defined(__unix__) || defined(__APPLE__)
+  sockaddr_un addr;
+  if (!server_detail::make_address(socket_path, addr)) {
+    std::cerr << "Error: invalid socket path: " << socket_path << "\n";
+    return 1;
+  }
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 ||
+      ::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    std::cerr << "Error: cannot connect to scan server at " << socket_path
+              << ": " << std::strerror(errno) << "\n";
+    if (fd >= 0)
+      ::close(fd);
+    return 1;
+  }
+  std::signal(SIGPIPE, SIG_IGN);
+
+  json request = {{"cwd", fs::current_path().string()}, {"args", args}};
+  std::string line;
+  bool ok = server_detail::write_all(fd, request.dump() + "\n") &&
+            server_detail::read_line(fd, line, std::string::npos);
+  ::close(fd);
+  // The client only prints the log; the report is skipped while parsing
+  json::parser_callback_t skip_report = [](int depth, json::parse_event_t event,
+                                           json &parsed) {
+    return !(depth == 1 && event == json::parse_event_t::key &&
+             parsed == "report");
+  };
+  json response = ok ? json::parse(line, skip_report, false) : json();
+  if (!ok || response.is_discarded() || !response.is_object()) {
+    std::cerr << "Error: no valid response from scan server at "
+              << socket_path << "\n";
+    return 1;
+  }
+  std::cerr << response.value("log", "");
+  return response.value("exit_code", 1);
+#else
+  (void)args;
+  std::cerr << "Error: --connect is only supported on POSIX systems ("
+            << socket_path << ").\n";
+  return 1;
+#endif
+}
+
+} // namespace depdiscover
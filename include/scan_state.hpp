@@ -0,0 +1,512 @@
+/**
+ * SPDX-FileComment: Incremental Scan State
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file scan_state.hpp
+ * @brief Content-hash manifest of scan inputs and cached intermediate results.
+ * @version 1.1.1
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include "file_reader.hpp"
+#include "thread_pool.hpp"
+#include "types.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace depdiscover {
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+/**
+ * @brief 64-bit FNV-1a style hash over 8-byte words (not cryptographic).
+ *
+ * @param data The bytes to hash.
+ * @param seed Previous hash value to continue from.
+ * @return std::uint64_t The hash.
+ */
+inline std::uint64_t content_hash(std::string_view data,
+                                  std::uint64_t seed = 0xcbf29ce484222325ULL) {
+  constexpr std::uint64_t prime = 0x100000001b3ULL;
+  std::uint64_t h = seed;
+  std::size_t i = 0;
+  for (; i + 8 <= data.size(); i += 8) {
+    std::uint64_t w;
+    std::memcpy(&w, data.data() + i, 8);
+    h = (h ^ w) * prime;
+    h ^= h >> 29;
+  }
+  for (; i < data.size(); ++i)
+    h = (h ^ static_cast<unsigned char>(data[i])) * prime;
+  return (h ^ data.size()) * prime;
+}
+
+namespace state_detail {
+
+inline std::uint64_t hash_contents(const std::string &path, bool dir) {
+  if (dir) {
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (const auto &e : fs::directory_iterator(path, ec))
+      names.push_back(e.path().filename().string());
+    std::sort(names.begin(), names.end());
+    std::uint64_t h = content_hash("dir");
+    for (const auto &n : names)
+      h = content_hash(n, h);
+    return h;
+  }
+  MappedFile file(path);
+  return file.is_open() ? content_hash(file.view()) : 0;
+}
+
+/// Full stamp (stat + hash).
+inline FileStamp make_stamp(const std::string &path) {
+  FileStamp st;
+  if (stat_file(path, st))
+    st.hash = hash_contents(path, st.dir);
+  return st;
+}
+
+/**
+ * @brief Re-stamps a path known from the previous run.
+ *
+ * @param path The path.
+ * @param old The previous stamp.
+ * @param now Receives the current stamp.
+ * @return true If the content is unchanged.
+ */
+inline bool restamp(const std::string &path, const FileStamp &old,
+                    FileStamp &now) {
+  if (!stat_file(path, now))
+    return !old.exists;
+  if (!old.exists || now.dir != old.dir || now.size != old.size)
+    return false;
+  if (now.mtime == old.mtime) {
+    now.hash = old.hash;
+    return true;
+  }
+  now.hash = hash_contents(path, now.dir);
+  return now.hash == old.hash;
+}
+
+} // namespace state_detail
+
+/**
+ * @brief Persistent state of the previous scan for incremental runs.
+ *
+ * The state file records a stamp for every input path (translation units,
+ * their include directories and headers, binaries, .pc files) and the
+ * intermediate results derived from them: the header set of each
+ * translation unit, the ELF library set and the mapped/enriched
+ * dependencies. After validate() a cached result is reused only if every
+ * path it depends on is unchanged; everything else is recomputed and
+ * recorded into the next state, which save() writes atomically.
+ *
+ * Paths are stored once in a table and referenced by index. The `config`
+ * string captures all options that influence the results; a state written
+ * with a different configuration (or tool version) is ignored.
+ */
+class ScanState {
+public:
+  /// Bump when the file layout changes.
+  static constexpr int FORMAT_VERSION = 1;
+
+  /**
+   * @brief Creates an empty state bound to a state file.
+   *
+   * @param file The state file.
+   * @param config Fingerprint of all result-relevant options.
+   */
+  ScanState(fs::path file, std::string config)
+      : file_(std::move(file)), config_(std::move(config)) {}
+
+  /**
+   * @brief Loads the previous state.
+   *
+   * @return true If a compatible state was found.
+   */
+  bool load() {
+    std::ifstream in(file_, std::ios::binary);
+    if (!in)
+      return false;
+    try {
+      json j = json::parse(in);
+      if (j.value("format", 0) != FORMAT_VERSION ||
+          j.value("config", "") != config_)
+        return false;
+
+      for (const auto &f : j.at("files")) {
+        paths_.push_back(f.at(0).get<std::string>());
+        FileStamp st;
+        st.exists = f.at(1).get<int>() != 0;
+        st.dir = f.at(1).get<int>() == 2;
+        st.size = f.at(2).get<std::uint64_t>();
+        st.mtime = f.at(3).get<std::int64_t>();
+        st.hash = f.at(4).get<std::uint64_t>();
+        stamps_.push_back(st);
+      }
+      for (const auto &s : j.at("sets"))
+        sets_.push_back(s.get<std::vector<std::uint32_t>>());
+      for (const auto &[key, t] : j.at("tus").items())
+        tus_.emplace(key, Record{t.at(0).get<std::vector<std::uint32_t>>(),
+                                 t.at(1).get<std::uint32_t>()});
+      if (j.contains("elf"))
+        elf_ = ElfRecord{j["elf"].at(0).get<std::vector<std::uint32_t>>(),
+                         j["elf"].at(1).get<std::vector<std::string>>()};
+      if (j.contains("enrichment")) {
+        const auto &e = j["enrichment"];
+        enrichment_ = EnrichmentRecord{
+            e.at("key").get<std::string>(),
+            e.at("inputs").get<std::vector<std::uint32_t>>(), e.at("deps"),
+            e.at("system")};
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "[Warning] Ignoring unreadable state file " << file_
+                << ": " << e.what() << "\n";
+      *this = ScanState(file_, config_);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Re-stamps every path of the previous state (in parallel).
+   *
+   * @param pool The worker pool.
+   */
+  void validate(ThreadPool &pool) {
+    unchanged_.assign(paths_.size(), 0);
+    current_.assign(paths_.size(), FileStamp{});
+    pool.parallel_chunks<int>(paths_.size(), [&](std::size_t b, std::size_t e) {
+      for (std::size_t i = b; i < e; ++i)
+        unchanged_[i] = state_detail::restamp(paths_[i], stamps_[i], current_[i]);
+      return 0;
+    });
+    for (std::size_t i = 0; i < paths_.size(); ++i)
+      index_.emplace(paths_[i], static_cast<std::uint32_t>(i));
+  }
+
+  /**
+   * @brief Returns the cached header set of a translation unit.
+   *
+   * Thread-safe after validate().
+   *
+   * @param key The translation unit key (see tu_key()).
+   * @param out Receives the headers if the entry is still valid.
+   * @return true If the cached entry was reused.
+   */
+  bool reuse_tu(const std::string &key, std::vector<std::string> &out) const {
+    auto it = tus_.find(key);
+    if (it == tus_.end() || it->second.set >= sets_.size() ||
+        !all_unchanged(it->second.inputs) ||
+        !all_unchanged(sets_[it->second.set]))
+      return false;
+    for (auto id : sets_[it->second.set])
+      out.push_back(paths_[id]);
+    return true;
+  }
+
+  /**
+   * @brief Records the header set of a translation unit for the next run.
+   *
+   * @param key The translation unit key.
+   * @param inputs The paths the result depends on besides the headers (the
+   * source file, include directories and every directory a header lookup
+   * probed, existing or not).
+   * @param headers The resolved headers.
+   */
+  void record_tu(const std::string &key, const std::vector<std::string> &inputs,
+                 const std::vector<std::string> &headers) {
+    auto &rec = next_tus_[key];
+    rec.inputs = intern_all(inputs);
+    auto ids = intern_all(headers);
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    auto [it, inserted] = next_set_ids_.try_emplace(
+        ids, static_cast<std::uint32_t>(next_sets_.size()));
+    if (inserted)
+      next_sets_.push_back(ids);
+    rec.set = it->second;
+  }
+
+  /**
+   * @brief Returns the cached ELF library set if all binaries are unchanged.
+   *
+   * @param binaries The (expanded) binary paths.
+   * @param libs Receives the libraries.
+   * @return true If the cached result was reused.
+   */
+  bool reuse_elf(const std::vector<std::string> &binaries,
+                 std::set<std::string> &libs) const {
+    if (!elf_ || elf_->inputs.size() != binaries.size() ||
+        !all_unchanged(elf_->inputs))
+      return false;
+    for (std::size_t i = 0; i < binaries.size(); ++i)
+      if (paths_[elf_->inputs[i]] != binaries[i])
+        return false;
+    libs.insert(elf_->libs.begin(), elf_->libs.end());
+    return true;
+  }
+
+  /**
+   * @brief Records the ELF library set for the next run.
+   */
+  void record_elf(const std::vector<std::string> &binaries,
+                  const std::set<std::string> &libs) {
+    next_elf_ = ElfRecord{intern_all(binaries), {libs.begin(), libs.end()}};
+  }
+
+  /**
+   * @brief Returns the cached mapping/enrichment result.
+   *
+   * @param key Hash of everything the mapping was computed from (see
+   * enrichment_key()).
+   * @param deps Receives the mapped dependencies (without CVEs).
+   * @param system Receives the system library dependencies.
+   * @param inputs Receives the recorded input paths (optional), to record
+   * them again for the next run.
+   * @return true If the cached result was reused.
+   */
+  bool reuse_enrichment(const std::string &key, std::vector<Dependency> &deps,
+                        std::vector<Dependency> &system,
+                        std::vector<std::string> *inputs = nullptr) const {
+    if (!enrichment_ || enrichment_->key != key ||
+        !all_unchanged(enrichment_->inputs))
+      return false;
+    try {
+      deps = enrichment_->deps.get<std::vector<Dependency>>();
+      system = enrichment_->system.get<std::vector<Dependency>>();
+    } catch (const std::exception &) {
+      return false;
+    }
+    if (inputs)
+      for (auto id : enrichment_->inputs)
+        inputs->push_back(paths_[id]);
+    return true;
+  }
+
+  /**
+   * @brief Records the mapping/enrichment result for the next run.
+   *
+   * @param key The enrichment key.
+   * @param inputs Further paths the result depends on (e.g. .pc files).
+   * @param deps The mapped dependencies (CVEs are not stored).
+   * @param system The system library dependencies.
+   */
+  void record_enrichment(const std::string &key,
+                         const std::vector<std::string> &inputs,
+                         const std::vector<Dependency> &deps,
+                         const std::vector<Dependency> &system) {
+    json jd = deps, js = system;
+    for (auto *arr : {&jd, &js})
+      for (auto &d : *arr)
+        d.erase("cves");
+    next_enrichment_ =
+        EnrichmentRecord{key, intern_all(inputs), std::move(jd), std::move(js)};
+  }
+
+  /**
+   * @brief Writes the recorded state (temporary file + rename).
+   *
+   * Paths that were re-stamped by validate() keep their stamp; new paths
+   * are stamped (and hashed) in parallel.
+   *
+   * @param pool The worker pool.
+   * @return true On success.
+   */
+  bool save(ThreadPool &pool) {
+    std::vector<FileStamp> stamps(next_paths_.size());
+    pool.parallel_chunks<int>(next_paths_.size(), [&](std::size_t b,
+                                                      std::size_t e) {
+      for (std::size_t i = b; i < e; ++i) {
+        auto it = index_.find(next_paths_[i]);
+        stamps[i] = it != index_.end() && unchanged_[it->second]
+                        ? current_[it->second]
+                        : state_detail::make_stamp(next_paths_[i]);
+      }
+      return 0;
+    });
+
+    json files = json::array();
+    for (std::size_t i = 0; i < next_paths_.size(); ++i) {
+      const auto &st = stamps[i];
+      files.push_back(json::array({next_paths_[i],
+                                   st.exists ? (st.dir ? 2 : 1) : 0, st.size,
+                                   st.mtime, st.hash}));
+    }
+    json tus = json::object();
+    for (const auto &[key, rec] : next_tus_)
+      tus[key] = json::array({rec.inputs, rec.set});
+
+    json j;
+    j["format"] = FORMAT_VERSION;
+    j["config"] = config_;
+    j["files"] = std::move(files);
+    j["sets"] = next_sets_;
+    j["tus"] = std::move(tus);
+    if (next_elf_)
+      j["elf"] = json::array({next_elf_->inputs, next_elf_->libs});
+    if (next_enrichment_)
+      j["enrichment"] = {{"key", next_enrichment_->key},
+                         {"inputs", next_enrichment_->inputs},
+                         {"deps", next_enrichment_->deps},
+                         {"system", next_enrichment_->system}};
+
+    std::error_code ec;
+    if (file_.has_parent_path())
+      fs::create_directories(file_.parent_path(), ec);
+    fs::path tmp = file_;
+    tmp += ".tmp";
+    {
+      std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+      if (!out)
+        return false;
+      out << j.dump();
+      if (!out)
+        return false;
+    }
+    fs::rename(tmp, file_, ec);
+    return !ec;
+  }
+
+  /**
+   * @brief Builds the key of a compile command (file, directory, command or
+   * argument list).
+   */
+  static std::string tu_key(const std::string &file, const std::string &dir,
+                            const std::string &command,
+                            const std::vector<std::string> &arguments = {}) {
+    std::uint64_t h = content_hash(file);
+    h = content_hash(dir, h);
+    h = content_hash(command, h);
+    for (const auto &arg : arguments)
+      h = content_hash(arg, content_hash("\n", h));
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx",
+                  static_cast<unsigned long long>(h));
+    return hex;
+  }
+
+  /**
+   * @brief Builds the enrichment key from the scanned dependencies, headers,
+   * libraries and an extra fingerprint (e.g. environment).
+   */
+  static std::string enrichment_key(const std::vector<Dependency> &deps,
+                                    const std::vector<std::string_view> &headers,
+                                    const std::set<std::string> &libs,
+                                    const std::string &extra) {
+    std::uint64_t h = content_hash(json(deps).dump());
+    for (const auto &s : headers)
+      h = content_hash(s, h);
+    h = content_hash("\n", h);
+    for (const auto &s : libs)
+      h = content_hash(s, h);
+    h = content_hash(extra, h);
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx",
+                  static_cast<unsigned long long>(h));
+    return hex;
+  }
+
+  /// Number of paths checked by validate().
+  std::size_t known_paths() const { return paths_.size(); }
+
+  /// Number of paths validate() found changed.
+  std::size_t changed_paths() const {
+    return static_cast<std::size_t>(
+        std::count(unchanged_.begin(), unchanged_.end(), 0));
+  }
+
+private:
+  struct Record {
+    std::vector<std::uint32_t> inputs;
+    std::uint32_t set = 0;
+  };
+  struct ElfRecord {
+    std::vector<std::uint32_t> inputs;
+    std::vector<std::string> libs;
+  };
+  struct EnrichmentRecord {
+    std::string key;
+    std::vector<std::uint32_t> inputs;
+    json deps;
+    json system;
+  };
+
+  bool all_unchanged(const std::vector<std::uint32_t> &ids) const {
+    for (auto id : ids)
+      if (id >= unchanged_.size() || !unchanged_[id])
+        return false;
+    return true;
+  }
+
+  std::vector<std::uint32_t> intern_all(const std::vector<std::string> &paths) {
+    std::vector<std::uint32_t> ids;
+    ids.reserve(paths.size());
+    for (const auto &p : paths) {
+      auto [it, inserted] = next_index_.try_emplace(
+          p, static_cast<std::uint32_t>(next_paths_.size()));
+      if (inserted)
+        next_paths_.push_back(p);
+      ids.push_back(it->second);
+    }
+    return ids;
+  }
+
+  struct IdsHash {
+    std::size_t operator()(const std::vector<std::uint32_t> &v) const {
+      return static_cast<std::size_t>(content_hash(std::string_view(
+          reinterpret_cast<const char *>(v.data()), v.size() * sizeof(v[0]))));
+    }
+  };
+
+  fs::path file_;
+  std::string config_;
+
+  // Previous run
+  std::vector<std::string> paths_;
+  std::vector<FileStamp> stamps_;
+  std::vector<std::vector<std::uint32_t>> sets_;
+  std::unordered_map<std::string, Record> tus_;
+  std::optional<ElfRecord> elf_;
+  std::optional<EnrichmentRecord> enrichment_;
+
+  // validate()
+  std::unordered_map<std::string, std::uint32_t> index_;
+  std::vector<char> unchanged_;
+  std::vector<FileStamp> current_;
+
+  // Next run
+  std::vector<std::string> next_paths_;
+  std::unordered_map<std::string, std::uint32_t> next_index_;
+  std::vector<std::vector<std::uint32_t>> next_sets_;
+  std::unordered_map<std::vector<std::uint32_t>, std::uint32_t, IdsHash>
+      next_set_ids_;
+  std::unordered_map<std::string, Record> next_tus_;
+  std::optional<ElfRecord> next_elf_;
+  std::optional<EnrichmentRecord> next_enrichment_;
+};
+
+} // namespace depdiscover
@@ -0,0 +1,187 @@
+/**
+ * SPDX-FileComment: Interned String Pool
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file string_pool.hpp
+ * @brief Arena-backed string interning with stable numeric IDs.
+ * @version 1.1.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace depdiscover {
+
+/// Handle of an interned string.
+using StringId = std::uint32_t;
+
+/// The "no string" handle (e.g., an unresolved header).
+inline constexpr StringId NO_STRING_ID = 0xffffffffu;
+
+/**
+ * @brief Monotonic allocator for string data.
+ *
+ * Bytes are bump-allocated from 64 KiB blocks and only released with the
+ * arena, so every returned view stays valid for the arena's lifetime. Not
+ * thread-safe on its own.
+ */
+class StringArena {
+public:
+  /**
+   * @brief Copies a string into the arena.
+   *
+   * @param s The string to copy.
+   * @return std::string_view The stable copy.
+   */
+  std::string_view store(std::string_view s) {
+    if (s.empty())
+      return {};
+    if (s.size() > BLOCK_SIZE / 4) {
+      // Large strings get a block of their own and keep the current one
+      blocks_.emplace_back(new char[s.size()]);
+      std::memcpy(blocks_.back().get(), s.data(), s.size());
+      bytes_ += s.size();
+      return {blocks_.back().get(), s.size()};
+    }
+    if (s.size() > free_) {
+      blocks_.emplace_back(new char[BLOCK_SIZE]);
+      current_ = blocks_.back().get();
+      free_ = BLOCK_SIZE;
+      bytes_ += BLOCK_SIZE;
+    }
+    char *p = current_;
+    std::memcpy(p, s.data(), s.size());
+    current_ += s.size();
+    free_ -= s.size();
+    return {p, s.size()};
+  }
+
+  /**
+   * @brief Number of bytes allocated for string data.
+   */
+  std::size_t bytes() const { return bytes_; }
+
+private:
+  static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char *current_ = nullptr;
+  std::size_t free_ = 0;
+  std::size_t bytes_ = 0;
+};
+
+/**
+ * @brief Process-wide pool of interned strings (paths, include names).
+ *
+ * Each distinct string is stored once in a StringArena and identified by a
+ * dense 32-bit ID; IDs and views stay valid until reset(), so caches can
+ * key on IDs instead of repeating full paths. Strings are only materialized
+ * where a std::string is needed (the dependency records and reports).
+ * Thread-safe.
+ */
+class StringPool {
+public:
+  /**
+   * @brief Returns the process-wide pool instance.
+   */
+  static StringPool &instance() {
+    static StringPool pool;
+    return pool;
+  }
+
+  /**
+   * @brief Interns a string.
+   *
+   * @param s The string.
+   * @return StringId The ID shared by all equal strings.
+   */
+  StringId intern(std::string_view s) {
+    {
+      std::shared_lock lock(mutex_);
+      auto it = ids_.find(s);
+      if (it != ids_.end())
+        return it->second;
+    }
+    std::unique_lock lock(mutex_);
+    auto it = ids_.find(s);
+    if (it != ids_.end())
+      return it->second;
+    std::string_view stored = arena_.store(s);
+    auto id = static_cast<StringId>(views_.size());
+    views_.push_back(stored);
+    ids_.emplace(stored, id);
+    return id;
+  }
+
+  /**
+   * @brief Returns the interned string of an ID.
+   *
+   * @param id A valid ID returned by intern().
+   * @return std::string_view The string (valid until reset()).
+   */
+  std::string_view view(StringId id) const {
+    std::shared_lock lock(mutex_);
+    return views_[id];
+  }
+
+  /**
+   * @brief Returns a copy of the interned string of an ID.
+   */
+  std::string str(StringId id) const { return std::string(view(id)); }
+
+  /**
+   * @brief Number of distinct strings.
+   */
+  std::size_t size() const {
+    std::shared_lock lock(mutex_);
+    return views_.size();
+  }
+
+  /**
+   * @brief Bytes allocated for string data.
+   */
+  std::size_t bytes() const {
+    std::shared_lock lock(mutex_);
+    return arena_.bytes();
+  }
+
+  /**
+   * @brief Releases all strings (long-running server and batch mode).
+   *
+   * Invalidates every ID and view handed out so far: only call it between
+   * scans, after the caches keyed on IDs forgot them (see
+   * ScanContext::end_scan()).
+   */
+  void reset() {
+    std::unique_lock lock(mutex_);
+    ids_ = {};
+    views_ = {};
+    arena_ = StringArena();
+  }
+
+private:
+  StringPool() = default;
+
+  mutable std::shared_mutex mutex_;
+  StringArena arena_;
+  std::vector<std::string_view> views_;
+  std::unordered_map<std::string_view, StringId> ids_;
+};
+
+} // namespace depdiscover
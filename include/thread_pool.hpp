@@ -0,0 +1,225 @@
+/**
+ * SPDX-FileComment: Work-Stealing Thread Pool
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file thread_pool.hpp
+ * @brief Small work-stealing thread pool for parallel scan stages.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace depdiscover {
+
+/**
+ * @brief Thread pool with one task deque per worker.
+ *
+ * Workers pop from the back of their own deque and steal from the front of
+ * the others when idle. A thread waiting for a batch of tasks helps
+ * executing queued tasks, so nested parallel calls cannot deadlock.
+ */
+class ThreadPool {
+public:
+  /**
+   * @brief Returns the default number of jobs (hardware concurrency).
+   */
+  static unsigned default_jobs() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+  }
+
+  /**
+   * @brief Starts the worker threads.
+   *
+   * @param jobs Number of workers (0 = default_jobs()). With 1 job all work
+   * runs inline on the calling thread.
+   */
+  explicit ThreadPool(unsigned jobs = 0) {
+    jobs_ = jobs == 0 ? default_jobs() : jobs;
+    if (jobs_ <= 1)
+      return;
+    queues_.reserve(jobs_);
+    for (unsigned i = 0; i < jobs_; ++i)
+      queues_.push_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < jobs_; ++i)
+      workers_.emplace_back([this, i] { worker_loop(i); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(wake_mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &t : workers_)
+      t.join();
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * @brief Number of jobs this pool runs in parallel.
+   */
+  unsigned size() const { return jobs_; }
+
+  /**
+   * @brief Runs fn(begin, end) over chunks of [0, count) and collects the
+   * per-chunk results in chunk order.
+   *
+   * Each chunk owns its result object, so callers can accumulate into
+   * chunk-local containers without locking and merge afterwards.
+   * Exceptions thrown by a chunk are rethrown in the caller.
+   *
+   * @tparam T The per-chunk result type.
+   * @param count Number of items.
+   * @param fn Callable `T(std::size_t begin, std::size_t end)`.
+   * @return std::vector<T> The chunk results.
+   */
+  template <class T, class F>
+  std::vector<T> parallel_chunks(std::size_t count, F &&fn) {
+    if (count == 0)
+      return {};
+    if (workers_.empty()) {
+      std::vector<T> out;
+      out.push_back(fn(std::size_t{0}, count));
+      return out;
+    }
+
+    // Several chunks per worker keep the load balanced on skewed inputs
+    std::size_t chunks = std::min<std::size_t>(count, std::size_t(jobs_) * 8);
+    std::size_t step = (count + chunks - 1) / chunks;
+    chunks = (count + step - 1) / step;
+
+    std::vector<T> results(chunks);
+    std::atomic<std::size_t> remaining{chunks};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    for (std::size_t c = 0; c < chunks; ++c) {
+      std::size_t begin = c * step;
+      std::size_t end = std::min(count, begin + step);
+      submit(c, [&, c, begin, end] {
+        try {
+          results[c] = fn(begin, end);
+        } catch (...) {
+          std::lock_guard lock(error_mutex);
+          if (!error)
+            error = std::current_exception();
+        }
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+      });
+    }
+
+    wait_until([&] { return remaining.load(std::memory_order_acquire) == 0; });
+    if (error)
+      std::rethrow_exception(error);
+    return results;
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  void submit(std::size_t hint, std::function<void()> task) {
+    auto &q = *queues_[hint % queues_.size()];
+    {
+      // Count first (under the wake mutex, so no worker misses the signal);
+      // a worker seeing the count before the push just retries.
+      std::lock_guard lock(wake_mutex_);
+      pending_.fetch_add(1, std::memory_order_release);
+    }
+    {
+      std::lock_guard lock(q.mutex);
+      q.tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+  }
+
+  /**
+   * @brief Pops a task: own queue from the back, others from the front.
+   */
+  bool try_pop(std::size_t self, std::function<void()> &task) {
+    const std::size_t n = queues_.size();
+    for (std::size_t k = 0; k < n; ++k) {
+      auto &q = *queues_[(self + k) % n];
+      std::lock_guard lock(q.mutex);
+      if (q.tasks.empty())
+        continue;
+      if (k == 0) {
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+      } else {
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+      }
+      pending_.fetch_sub(1, std::memory_order_acq_rel);
+      return true;
+    }
+    return false;
+  }
+
+  void worker_loop(std::size_t self) {
+    std::function<void()> task;
+    while (true) {
+      if (try_pop(self, task)) {
+        task();
+        task = nullptr;
+        done_.notify_all();
+        continue;
+      }
+      std::unique_lock lock(wake_mutex_);
+      wake_.wait(lock, [&] {
+        return stop_ || pending_.load(std::memory_order_acquire) > 0;
+      });
+      if (stop_ && pending_.load(std::memory_order_acquire) == 0)
+        return;
+    }
+  }
+
+  template <class Pred> void wait_until(Pred done) {
+    std::function<void()> task;
+    while (!done()) {
+      if (try_pop(0, task)) {
+        task();
+        task = nullptr;
+        continue;
+      }
+      std::unique_lock lock(wake_mutex_);
+      done_.wait_for(lock, std::chrono::milliseconds(5));
+    }
+  }
+
+  unsigned jobs_ = 1;
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<std::size_t> pending_{0};
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  bool stop_ = false;
+};
+
+} // namespace depdiscover
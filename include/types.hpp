@@ -7,8 +7,8 @@
  *
  * @file types.hpp
  * @brief definitions of common data structures like Dependency and CVE.
- * @version 1.1.0
- * @date 2026-02-22
+ * @version 1.4.0
+ * @date 2026-10-14
  *
  * @author ZHENG Robert (robert@hase-zheng.net)
  * @copyright Copyright (c) 2026 ZHENG Robert
@@ -21,41 +21,9 @@
 #include <vector>
 #include <algorithm>
 
-namespace depdiscover {
-
-/**
- * @brief Extracts a CVSS score from a severity string.
- *
- * @param severity_str The severity string (e.g., "7.5" or
- * "CVSS:3.1/AV:N/AC:L/PR:N/UI:N/S:U/C:H/I:H/A:H").
- * @return double The extracted CVSS score.
- */
-inline double extract_cvss_score(const std::string &severity_str) {
-  if (severity_str == "UNKNOWN" || severity_str == "NONE" ||
-      severity_str.empty())
-    return 0.0;
-
-  try {
-    return std::stod(severity_str);
-  } catch (...) {
-    if (severity_str.find("CVSS:") == 0) {
-      int high_count = 0;
-      if (severity_str.find("C:H") != std::string::npos)
-        high_count++;
-      if (severity_str.find("I:H") != std::string::npos)
-        high_count++;
-      if (severity_str.find("A:H") != std::string::npos)
-        high_count++;
+#include "cvss.hpp"
 
-      if (high_count == 3)
-        return 9.0; // Critical
-      if (high_count > 0)
-        return 7.0; // High
-      return 5.0;   // Medium Fallback
-    }
-  }
-  return 0.0;
-}
+namespace depdiscover {
 
 /**
  * @brief Represents a Common Vulnerability and Exposure (CVE).
@@ -86,6 +54,22 @@ inline void to_json(nlohmann::json &j, const CVE &c) {
                      {"suppression_reason", c.suppression_reason}};
 }
 
+/**
+ * @brief Deserializes a CVE object from JSON.
+ *
+ * @param j The JSON object to read from.
+ * @param c The CVE object.
+ */
+inline void from_json(const nlohmann::json &j, CVE &c) {
+  c.id = j.value("id", "");
+  c.summary = j.value("summary", "");
+  c.severity = j.value("severity", "");
+  c.score = j.value("score", 0.0);
+  c.fixed_version = j.value("fixed_version", "");
+  c.suppressed = j.value("suppressed", false);
+  c.suppression_reason = j.value("suppression_reason", "");
+}
+
 /**
  * @brief Represents a software dependency.
  */
@@ -120,4 +104,36 @@ inline void to_json(nlohmann::json &j, const Dependency &d) {
       {"cves", d.cves}};
 }
 
+/**
+ * @brief Deserializes a Dependency object from JSON.
+ *
+ * @param j The JSON object to read from.
+ * @param d The Dependency object.
+ */
+inline void from_json(const nlohmann::json &j, Dependency &d) {
+  d.name = j.value("name", "");
+  d.version = j.value("version", "");
+  d.type = j.value("type", "");
+  d.source = j.value("source", "");
+  d.headers = j.value("headers", std::vector<std::string>{});
+  d.libraries = j.value("libraries", std::vector<std::string>{});
+  d.licenses = j.value("licenses", std::vector<std::string>{});
+  d.cves = j.value("cves", std::vector<CVE>{});
+}
+
+/**
+ * @brief The report header shared by all output formats.
+ */
+struct ReportHeader {
+  std::string schema_version;   ///< Version of the JSON report schema.
+  std::string scan_date;        ///< Date of the scan.
+  std::string tool_name;        ///< Name of the generating tool.
+  std::string tool_version;     ///< Version of the generating tool.
+  std::string tool_description; ///< Description of the generating tool.
+  std::string tool_homepage;    ///< Homepage of the generating tool.
+  std::string tool_author;      ///< Author of the generating tool.
+  std::string project_name;     ///< Name of the scanned project.
+  std::string workspace_root;   ///< Directory the scan ran in.
+};
+
 } // namespace depdiscover
@@ -0,0 +1,444 @@
+/**
+ * SPDX-FileComment: Header Version Sniffer
+ * SPDX-FileType: SOURCE
+ * SPDX-FileContributor: ZHENG Robert
+ * SPDX-FileCopyrightText: 2026 ZHENG Robert
+ * SPDX-License-Identifier: MIT
+ *
+ * @file version_sniffer.hpp
+ * @brief Reads library versions from the version macros at the top of headers.
+ * @version 1.0.0
+ * @date 2026-10-14
+ *
+ * @author ZHENG Robert (robert@hase-zheng.net)
+ * @copyright Copyright (c) 2026 ZHENG Robert
+ *
+ * @license MIT License
+ */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "dependency_registry.hpp"
+#include "file_reader.hpp"
+
+namespace depdiscover {
+
+namespace fs = std::filesystem;
+
+/// Only this much of a header is inspected; version macros live at the top.
+inline constexpr std::size_t VERSION_SNIFF_PREFIX_BYTES = 64 * 1024;
+
+/**
+ * @brief Calls `fn(name, value)` for every object-like `#define` in the text.
+ *
+ * Only preprocessor lines are looked at; the value is the rest of the line
+ * without comments and surrounding blanks. Function-like macros are
+ * skipped. `fn` returns false to stop early.
+ *
+ * @param text The header text (usually a prefix of the file).
+ * @param fn Callback `bool(std::string_view, std::string_view)`.
+ */
+template <typename Fn> void for_each_define(std::string_view text, Fn &&fn) {
+  auto is_blank = [](char c) { return c == ' ' || c == '\t'; };
+  auto is_ident = [](char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           (c >= '0' && c <= '9') || c == '_';
+  };
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    std::size_t eol = text.find('\n', pos);
+    if (eol == std::string_view::npos)
+      eol = text.size();
+    std::string_view line = text.substr(pos, eol - pos);
+    pos = eol + 1;
+
+    std::size_t i = 0;
+    while (i < line.size() && is_blank(line[i]))
+      ++i;
+    if (i >= line.size() || line[i] != '#')
+      continue;
+    ++i;
+    while (i < line.size() && is_blank(line[i]))
+      ++i;
+    if (line.substr(i, 6) != "define" || i + 6 >= line.size() ||
+        !is_blank(line[i + 6]))
+      continue;
+    i += 6;
+    while (i < line.size() && is_blank(line[i]))
+      ++i;
+    std::size_t name_start = i;
+    while (i < line.size() && is_ident(line[i]))
+      ++i;
+    if (i == name_start || (i < line.size() && line[i] == '('))
+      continue;
+    std::string_view name = line.substr(name_start, i - name_start);
+
+    std::string_view value = line.substr(i);
+    for (std::string_view comment : {"//", "/*"})
+      if (auto c = value.find(comment); c != std::string_view::npos)
+        value = value.substr(0, c);
+    while (!value.empty() && is_blank(value.front()))
+      value.remove_prefix(1);
+    while (!value.empty() && (is_blank(value.back()) || value.back() == '\r'))
+      value.remove_suffix(1);
+    if (!fn(name, value))
+      return;
+  }
+}
+
+/**
+ * @brief How a library encodes its version in macros.
+ */
+enum class VersionEncoding {
+  Components, ///< One macro each for major, minor and (optionally) patch.
+  Packed,     ///< One integer, e.g. FMT_VERSION 100201 -> 10.2.1.
+  Text        ///< A string literal, e.g. ZLIB_VERSION "1.3.1".
+};
+
+/**
+ * @brief One way to read a version from macros.
+ *
+ * Packed values are split as `major = v / divisors[0]`,
+ * `minor = v / divisors[1] % divisors[2]` and `patch = v % divisors[1]`.
+ */
+struct VersionMacroRule {
+  VersionEncoding encoding;
+  std::array<std::string_view, 3> macros; ///< Packed/Text use macros[0].
+  std::array<std::uint64_t, 3> divisors{};
+};
+
+/**
+ * @brief A library whose headers carry a version macro.
+ *
+ * To support another library add an entry to known_version_libraries().
+ */
+struct KnownVersionLibrary {
+  /// normalize_dependency_name() keys of targets and `_deps/<dir>-src` stems.
+  std::vector<std::string_view> names;
+  /// Header paths relative to the source or install root, tried in order.
+  std::vector<std::string_view> headers;
+  /// Rules tried in order on each header.
+  std::vector<VersionMacroRule> rules;
+  std::string_view license;
+};
+
+/**
+ * @brief The table of libraries with known version macros.
+ */
+inline const std::vector<KnownVersionLibrary> &known_version_libraries() {
+  using enum VersionEncoding;
+  static const std::vector<KnownVersionLibrary> table = {
+      {{"nlohmann-json"},
+       {"include/nlohmann/detail/abi_macros.hpp", "include/nlohmann/json.hpp",
+        "single_include/nlohmann/json.hpp"},
+       {{Components,
+         {"NLOHMANN_JSON_VERSION_MAJOR", "NLOHMANN_JSON_VERSION_MINOR",
+          "NLOHMANN_JSON_VERSION_PATCH"}}},
+       "MIT"},
+      {{"fmt"},
+       {"include/fmt/base.h", "include/fmt/core.h"},
+       {{Packed, {"FMT_VERSION"}, {10000, 100, 100}}},
+       "MIT"},
+      {{"spdlog"},
+       {"include/spdlog/version.h"},
+       {{Components,
+         {"SPDLOG_VER_MAJOR", "SPDLOG_VER_MINOR", "SPDLOG_VER_PATCH"}}},
+       "MIT"},
+      {{"boost"},
+       {"boost/version.hpp", "libs/config/include/boost/version.hpp"},
+       {{Packed, {"BOOST_VERSION"}, {100000, 100, 1000}}},
+       "BSL-1.0"},
+      {{"openssl"},
+       {"include/openssl/opensslv.h"},
+       {{Components,
+         {"OPENSSL_VERSION_MAJOR", "OPENSSL_VERSION_MINOR",
+          "OPENSSL_VERSION_PATCH"}},
+        {Text, {"OPENSSL_VERSION_TEXT"}}},
+       "Apache-2.0"},
+      {{"zlib"}, {"zlib.h"}, {{Text, {"ZLIB_VERSION"}}}, "Zlib"},
+      {{"qt6", "qt5", "qt", "qtbase"},
+       {"include/QtCore/qtcore-config.h", "src/corelib/global/qtversion.h",
+        "src/corelib/global/qglobal.h"},
+       {{Components, {"QT_VERSION_MAJOR", "QT_VERSION_MINOR", "QT_VERSION_PATCH"}},
+        {Text, {"QT_VERSION_STR"}}},
+       "LGPL-3.0"},
+      {{"catch2"},
+       {"src/catch2/catch_version_macros.hpp",
+        "single_include/catch2/catch.hpp"},
+       {{Components,
+         {"CATCH_VERSION_MAJOR", "CATCH_VERSION_MINOR", "CATCH_VERSION_PATCH"}}},
+       "BSL-1.0"},
+      {{"cli11"},
+       {"include/CLI/Version.hpp"},
+       {{Text, {"CLI11_VERSION"}}},
+       "BSD-3-Clause"},
+      {{"curl"},
+       {"include/curl/curlver.h"},
+       {{Text, {"LIBCURL_VERSION"}}},
+       "curl"},
+      {{"sqlite3", "sqlite"}, {"sqlite3.h"}, {{Text, {"SQLITE_VERSION"}}}, "blessing"},
+      {{"png"}, {"png.h"}, {{Text, {"PNG_LIBPNG_VER_STRING"}}}, "Libpng"},
+  };
+  return table;
+}
+
+namespace version_sniffer_detail {
+
+/// Parses a decimal or hexadecimal integer macro value (suffixes ignored).
+inline bool parse_macro_integer(std::string_view v, std::uint64_t &out) {
+  while (!v.empty() && v.front() == '(')
+    v.remove_prefix(1);
+  int base = 10;
+  if (v.size() > 2 && v[0] == '0' && (v[1] == 'x' || v[1] == 'X')) {
+    base = 16;
+    v.remove_prefix(2);
+  }
+  std::uint64_t value = 0;
+  std::size_t digits = 0;
+  for (char c : v) {
+    int d;
+    if (c >= '0' && c <= '9')
+      d = c - '0';
+    else if (base == 16 && c >= 'a' && c <= 'f')
+      d = c - 'a' + 10;
+    else if (base == 16 && c >= 'A' && c <= 'F')
+      d = c - 'A' + 10;
+    else
+      break;
+    value = value * std::uint64_t(base) + std::uint64_t(d);
+    ++digits;
+  }
+  out = value;
+  return digits > 0;
+}
+
+/// Extracts the first `1.2.3`-like token of a string literal macro value.
+inline std::string version_from_text(std::string_view v) {
+  auto open = v.find('"');
+  if (open == std::string_view::npos)
+    return {};
+  auto close = v.find('"', open + 1);
+  v = v.substr(open + 1, close == std::string_view::npos
+                              ? std::string_view::npos
+                              : close - open - 1);
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    if (v[i] < '0' || v[i] > '9' || (i > 0 && v[i - 1] != ' ' && v[i - 1] != 'v'))
+      continue;
+    std::size_t end = i;
+    bool dotted = false;
+    while (end < v.size() &&
+           ((v[end] >= '0' && v[end] <= '9') || v[end] == '.' ||
+            (v[end] >= 'a' && v[end] <= 'z'))) {
+      dotted |= v[end] == '.';
+      ++end;
+    }
+    if (dotted)
+      return std::string(v.substr(i, end - i));
+  }
+  return {};
+}
+
+/// Applies a rule to the collected macro values.
+inline std::string
+apply_rule(const VersionMacroRule &rule,
+           const std::map<std::string_view, std::string_view> &defines) {
+  auto get = [&](std::string_view name) -> const std::string_view * {
+    auto it = defines.find(name);
+    return it == defines.end() ? nullptr : &it->second;
+  };
+  switch (rule.encoding) {
+  case VersionEncoding::Components: {
+    std::string version;
+    for (std::size_t i = 0; i < rule.macros.size(); ++i) {
+      if (rule.macros[i].empty())
+        break;
+      const std::string_view *v = get(rule.macros[i]);
+      std::uint64_t n;
+      if (!v || !parse_macro_integer(*v, n)) {
+        if (i < 2)
+          return {}; // major and minor are required
+        break;
+      }
+      if (!version.empty())
+        version += '.';
+      version += std::to_string(n);
+    }
+    return version;
+  }
+  case VersionEncoding::Packed: {
+    const std::string_view *v = get(rule.macros[0]);
+    std::uint64_t n;
+    if (!v || !parse_macro_integer(*v, n) || rule.divisors[0] == 0 ||
+        rule.divisors[1] == 0 || rule.divisors[2] == 0)
+      return {};
+    return std::to_string(n / rule.divisors[0]) + "." +
+           std::to_string(n / rule.divisors[1] % rule.divisors[2]) + "." +
+           std::to_string(n % rule.divisors[1]);
+  }
+  case VersionEncoding::Text: {
+    const std::string_view *v = get(rule.macros[0]);
+    return v ? version_from_text(*v) : std::string{};
+  }
+  }
+  return {};
+}
+
+/// Finds `<P>_VERSION_MAJOR`/`_MINOR`[/`_PATCH`] (or `_VER_`) for any prefix.
+inline std::string
+generic_components(const std::map<std::string_view, std::string_view> &defines) {
+  for (std::string_view infix : {"_VERSION_", "_VER_"}) {
+    for (const auto &[name, value] : defines) {
+      if (!name.ends_with("MAJOR") || name.size() < infix.size() + 5 ||
+          name.substr(name.size() - 5 - infix.size(), infix.size()) != infix)
+        continue;
+      std::string base(name.substr(0, name.size() - 5));
+      VersionMacroRule rule{VersionEncoding::Components, {}};
+      std::array<std::string, 3> names = {base + "MAJOR", base + "MINOR",
+                                          base + "PATCH"};
+      rule.macros = {names[0], names[1], names[2]};
+      if (std::string v = apply_rule(rule, defines); !v.empty())
+        return v;
+    }
+  }
+  return {};
+}
+
+/// Reads the bounded prefix of a header and collects its defines.
+inline bool collect_defines(const fs::path &header, std::string &text,
+                            std::map<std::string_view, std::string_view> &out) {
+  if (!read_file_prefix(header, VERSION_SNIFF_PREFIX_BYTES, text))
+    return false;
+  for_each_define(text, [&](std::string_view name, std::string_view value) {
+    out.try_emplace(name, value);
+    return true;
+  });
+  return true;
+}
+
+} // namespace version_sniffer_detail
+
+/**
+ * @brief Reads a version from a header with the given rules.
+ *
+ * @param header The header file.
+ * @param rules The rules, tried in order.
+ * @return std::string The version, or empty if no rule matched.
+ */
+inline std::string sniff_header_version(const fs::path &header,
+                                        const std::vector<VersionMacroRule> &rules) {
+  std::string text;
+  std::map<std::string_view, std::string_view> defines;
+  if (!version_sniffer_detail::collect_defines(header, text, defines))
+    return {};
+  for (const auto &rule : rules)
+    if (std::string v = version_sniffer_detail::apply_rule(rule, defines);
+        !v.empty())
+      return v;
+  return {};
+}
+
+/**
+ * @brief Looks up the table entry for a target or directory name.
+ *
+ * @return const KnownVersionLibrary* The entry, or nullptr.
+ */
+inline const KnownVersionLibrary *find_known_version_library(std::string_view name) {
+  std::string key = normalize_dependency_name(name);
+  for (const auto &lib : known_version_libraries())
+    if (std::find(lib.names.begin(), lib.names.end(), key) != lib.names.end())
+      return &lib;
+  return nullptr;
+}
+
+/**
+ * @brief Finds the FetchContent source directory (`_deps/<name>-src`) of a
+ * target.
+ *
+ * A directory matches if its name and the target normalize to the same key
+ * or both belong to the same table entry (`json-src` for `nlohmann_json`).
+ *
+ * @param deps_dir The `_deps` directory of a CMake build tree.
+ * @param target_name The CMake target or package name.
+ * @return fs::path The source directory, or empty if none matches.
+ */
+inline fs::path find_fetchcontent_source(const fs::path &deps_dir,
+                                         const std::string &target_name) {
+  std::error_code ec;
+  const std::string key = normalize_dependency_name(target_name);
+  const KnownVersionLibrary *known = find_known_version_library(target_name);
+  for (const auto &entry : fs::directory_iterator(deps_dir, ec)) {
+    std::string dir = entry.path().filename().string();
+    if (!dir.ends_with("-src") || !entry.is_directory(ec))
+      continue;
+    std::string stem = dir.substr(0, dir.size() - 4);
+    if (normalize_dependency_name(stem) == key ||
+        (known && find_known_version_library(stem) == known))
+      return entry.path();
+  }
+  return {};
+}
+
+/**
+ * @brief Reads version and license of a library from its source tree.
+ *
+ * Known libraries are probed through their table entry. For any other
+ * library, headers with "version" in their name below `include/` (two
+ * levels deep) are searched for `<PREFIX>_VERSION_MAJOR/MINOR/PATCH`.
+ *
+ * @param root The source (or install) root of the library.
+ * @param target_name The target or package name.
+ * @return std::pair<std::string, std::string> {version, license}; empty
+ * strings if unknown (the license is only known for table entries).
+ */
+inline std::pair<std::string, std::string>
+sniff_source_tree_version(const fs::path &root, const std::string &target_name) {
+  std::error_code ec;
+  if (const auto *known = find_known_version_library(target_name)) {
+    // The source directory name may match while the target does not
+    for (auto header : known->headers)
+      if (fs::is_regular_file(root / header, ec))
+        if (std::string v = sniff_header_version(root / header, known->rules);
+            !v.empty())
+          return {v, std::string(known->license)};
+    return {};
+  }
+
+  fs::path include_dir = root / "include";
+  if (!fs::is_directory(include_dir, ec))
+    return {};
+  constexpr int MAX_DEPTH = 2;
+  constexpr int MAX_CANDIDATES = 16;
+  int candidates = 0;
+  for (auto it = fs::recursive_directory_iterator(include_dir, ec);
+       !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+    if (it.depth() >= MAX_DEPTH)
+      it.disable_recursion_pending();
+    if (!it->is_regular_file(ec))
+      continue;
+    std::string file = registry_detail::ascii_lower(it->path().filename().string());
+    auto ext = it->path().extension();
+    if (file.find("version") == std::string::npos ||
+        (ext != ".h" && ext != ".hpp" && ext != ".hxx"))
+      continue;
+    std::string text;
+    std::map<std::string_view, std::string_view> defines;
+    if (version_sniffer_detail::collect_defines(it->path(), text, defines))
+      if (std::string v = version_sniffer_detail::generic_components(defines);
+          !v.empty())
+        return {v, {}};
+    if (++candidates >= MAX_CANDIDATES)
+      break;
+  }
+  return {};
+}
+
+} // namespace depdiscover